@@ -467,15 +467,20 @@ class CutoffFunction : public LocalizableFunctionInterface<typename DiffusionFac
     struct ComputeDiffusionFactor<DF, 1, 1>
     {
       /**
-       * We try to find the minimum of a polynomial of given order by evaluating it at the points of a quadrature that
-       * would integrate this polynomial exactly.
-       * \todo These are just some heuristics and should be replaced by something proper.
+       * If the diffusion factor provides guaranteed bounds (see LocalfunctionInterface::bounds) which prove it to be
+       * positive, we use its lower bound. Otherwise we try to find the minimum of a polynomial of given order by
+       * evaluating it at the points of a quadrature that would integrate this polynomial exactly.
+       * \todo The latter are just some heuristics and should be replaced by something proper.
        */
       static RangeFieldType min_of(const DF& diffusion_factor, const EntityType& ent)
       {
+        const auto local_diffusion_factor = diffusion_factor.local_function(ent);
+        typename DF::RangeType lower(0);
+        typename DF::RangeType upper(0);
+        if (local_diffusion_factor->bounds(lower, upper) && lower[0] > 0)
+          return lower[0];
         typename DF::RangeType tmp_value(0);
         RangeFieldType minimum = std::numeric_limits<RangeFieldType>::max();
-        const auto local_diffusion_factor = diffusion_factor.local_function(ent);
         const size_t ord = local_diffusion_factor->order();
         const auto& quadrature =
             QuadratureRules<DomainFieldType, dimDomain>::rule(ent.type(), boost::numeric_cast<int>(ord));
@@ -16,6 +16,7 @@
 #if HAVE_DUNE_XT_LA
 
 #include <memory>
+#include <vector>
 
 #include <dune/xt/common/configuration.hh>
 #include <dune/xt/common/fmatrix.hh>
@@ -162,6 +163,20 @@ protected:
       evaluate(A, b, b_zero, x, ret);
     }
 
+    // the product of A with the matrix of all points, A is densified once for all of them
+    static void evaluate(const std::vector<MatrixType>& A,
+                         const RangeType& b,
+                         const bool b_zero,
+                         const std::vector<DomainType>& xx,
+                         std::vector<RangeType>& ret)
+    {
+      const auto A_dense = A[0].operator std::unique_ptr<FieldMatrixType>();
+      for (size_t pp = 0; pp < xx.size(); ++pp) {
+        ret[pp] = b_zero ? RangeType(0) : b;
+        A_dense->umv(xx[pp], ret[pp]);
+      }
+    }
+
     static void jacobian(const std::vector<MatrixType>& A, JacobianRangeType& ret)
     {
       ret = *(A[0].operator std::unique_ptr<FieldMatrixType>());
@@ -203,6 +218,22 @@ protected:
           ret += b[rr][col];
     }
 
+    static void evaluate(const std::vector<MatrixType>& A,
+                         const RangeType& b,
+                         const bool b_zero,
+                         const std::vector<DomainType>& xx,
+                         std::vector<RangeType>& ret)
+    {
+      for (size_t pp = 0; pp < xx.size(); ++pp)
+        ret[pp] = b_zero ? RangeType(0) : b;
+      for (size_t cc = 0; cc < rangeDimCols; ++cc) {
+        const auto A_dense = A[cc].operator std::unique_ptr<FieldMatrixType>();
+        for (size_t pp = 0; pp < xx.size(); ++pp)
+          for (size_t rr = 0; rr < rangeDim; ++rr)
+            ret[pp][rr][cc] += (*A_dense)[rr] * xx[pp];
+      }
+    }
+
     static void jacobian(const std::vector<MatrixType>& A, JacobianRangeType& ret)
     {
       for (size_t cc = 0; cc < rangeDimCols; ++cc)
@@ -250,11 +281,13 @@ public:
   typedef typename InterfaceType::RangeFieldType RangeFieldType;
   typedef typename InterfaceType::RangeType RangeType;
   typedef typename InterfaceType::JacobianRangeType JacobianRangeType;
+  typedef typename InterfaceType::HessianRangeType HessianRangeType;
   using InterfaceType::dimDomain;
   using InterfaceType::dimRange;
   using InterfaceType::dimRangeCols;
   using typename BaseType::MatrixType;
   using typename BaseType::FieldMatrixType;
+  typedef StaticGlobalLocalfunction<ThisType> StaticLocalfunctionType;
 
   using BaseType::default_config;
 
@@ -320,18 +353,64 @@ public:
 
   using InterfaceType::evaluate;
 
-  virtual void evaluate(const DomainType& x, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  virtual void evaluate(const DomainType& x, RangeType& ret, const Common::Parameter& mu = {}) const override final
   {
-    BaseType::template helper<>::evaluate(A_, b_, b_zero_, x, ret);
+    evaluate_static(x, ret, mu);
+  }
+
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    ret.resize(xx.size());
+    BaseType::template helper<>::evaluate(A_, b_, b_zero_, xx, ret);
   }
 
   using InterfaceType::jacobian;
 
   virtual void
-  jacobian(const DomainType& /*x*/, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  jacobian(const DomainType& x, JacobianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    jacobian_static(x, ret, mu);
+  }
+
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    JacobianRangeType jacobian_value;
+    BaseType::template helper<>::jacobian(A_, jacobian_value);
+    ret.assign(xx.size(), jacobian_value);
+  }
+
+  using InterfaceType::hessian;
+
+  virtual void
+  hessian(const DomainType& /*x*/, HessianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    HessianRangeTypeSelector<dimDomain, RangeFieldType, dimRange, dimRangeCols>::set_zero(ret);
+  }
+
+  /**
+   * \name ´´Statically dispatched (and inlinable) counterparts of local_function(), evaluate() and jacobian().''
+   * \sa   StaticLocalfunctionInterface
+   * \{
+   **/
+  StaticLocalfunctionType static_local_function(const EntityImp& entity) const
+  {
+    return StaticLocalfunctionType(*this, entity);
+  }
+
+  void evaluate_static(const DomainType& x, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const
+  {
+    BaseType::template helper<>::evaluate(A_, b_, b_zero_, x, ret);
+  }
+
+  void jacobian_static(const DomainType& /*x*/, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const
   {
     BaseType::template helper<>::jacobian(A_, ret);
   }
+  /* \} */
 
 private:
   using BaseType::A_;
@@ -0,0 +1,251 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <config.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "arena.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+namespace {
+
+
+struct Chunk;
+
+
+// precedes every block to tell deallocate() where it came from (nullptr for the heap), its size keeps the blocks
+// aligned
+struct alignas(std::max_align_t) BlockHeader
+{
+  Chunk* chunk;
+  // the size of the block including this header, the lowest bit is set while the block is alive
+  std::atomic<std::size_t> size_and_alive;
+};
+
+
+// Memory of one buffer, which is freed by whoever drops the last reference to it: the buffer (when its thread ends) or
+// a block taken from it (when it is deallocated, possibly later or on another thread).
+struct Chunk
+{
+  // one per block taken from this chunk which has not been deallocated yet, plus one while the buffer holds it
+  std::atomic<std::size_t> refs;
+  std::size_t size;
+  // only used by the thread of the buffer
+  std::size_t used;
+
+  static std::size_t header_size()
+  {
+    return (sizeof(Chunk) + sizeof(BlockHeader) - 1) / sizeof(BlockHeader) * sizeof(BlockHeader);
+  }
+
+  static Chunk* create(const std::size_t size)
+  {
+    Chunk* chunk = new (::operator new(header_size() + size)) Chunk();
+    chunk->refs = 1;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+  }
+
+  char* data()
+  {
+    return reinterpret_cast<char*>(this) + header_size();
+  }
+
+  // the end of the last block taken after begin which is still alive, begin if there is none
+  std::size_t end_of_alive(const std::size_t begin)
+  {
+    std::size_t ret = begin;
+    for (std::size_t pos = begin; pos < used;) {
+      const std::size_t size_and_alive = reinterpret_cast<BlockHeader*>(data() + pos)->size_and_alive;
+      pos += size_and_alive & ~std::size_t(1);
+      if (size_and_alive & 1)
+        ret = pos;
+    }
+    return ret;
+  } // ... end_of_alive(...)
+
+  void release() noexcept
+  {
+    if (--refs == 0) {
+      this->~Chunk();
+      ::operator delete(this);
+    }
+  }
+}; // struct Chunk
+
+
+// the buffer of one thread, a list of chunks which are filled one after the other
+struct Buffer
+{
+  static const std::size_t chunk_size = 64 * 1024;
+
+  Buffer()
+    : current(0)
+    , depth(0)
+  {
+  }
+
+  ~Buffer()
+  {
+    // chunks with blocks which are still alive (e.g., handed to another thread) are freed by the last of them
+    for (auto& chunk : chunks)
+      chunk->release();
+    for (auto& chunk : retired)
+      chunk->release();
+  }
+
+  // bytes has to be a multiple of sizeof(BlockHeader)
+  BlockHeader* take(const std::size_t bytes)
+  {
+    while (current < chunks.size() && chunks[current]->used + bytes > chunks[current]->size)
+      if (++current < chunks.size())
+        chunks[current]->used = 0;
+    if (current == chunks.size())
+      chunks.push_back(Chunk::create(std::max(std::size_t(chunk_size), bytes)));
+    Chunk* chunk = chunks[current];
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(chunk->data() + chunk->used);
+    chunk->used += bytes;
+    ++chunk->refs;
+    header->chunk = chunk;
+    header->size_and_alive = bytes | 1;
+    return header;
+  } // ... take(...)
+
+  /**
+   * Returns to the given position, apart from the blocks taken since which are still alive: the given chunk is only
+   * rewound to the end of the last of them, the following chunks holding any of them are retired until all of their
+   * blocks are deallocated, and reused afterwards. The chunks of enclosing scopes come first, so they are not moved.
+   */
+  void rewind(const std::size_t chunk, const std::size_t offset)
+  {
+    if (chunk >= chunks.size())
+      return;
+    const std::size_t used = chunks[chunk]->end_of_alive(offset);
+    std::size_t num_kept = chunk + 1;
+    for (std::size_t ii = chunk + 1; ii < chunks.size(); ++ii) {
+      if (ii <= current && chunks[ii]->end_of_alive(0) > 0)
+        retired.push_back(chunks[ii]);
+      else
+        chunks[num_kept++] = chunks[ii];
+    }
+    chunks.resize(num_kept);
+    current = chunk;
+    chunks[chunk]->used = used;
+    // only the buffer refers to these any more
+    for (std::size_t ii = 0; ii < retired.size();) {
+      if (retired[ii]->refs == 1) {
+        chunks.push_back(retired[ii]);
+        retired[ii] = retired.back();
+        retired.pop_back();
+      } else
+        ++ii;
+    }
+  } // ... rewind(...)
+
+  std::size_t num_alive() const
+  {
+    std::size_t ret = 0;
+    for (const auto& chunk : chunks)
+      ret += chunk->refs - 1;
+    for (const auto& chunk : retired)
+      ret += chunk->refs - 1;
+    return ret;
+  }
+
+  std::vector<Chunk*> chunks;
+  // chunks holding blocks which outlived their scope
+  std::vector<Chunk*> retired;
+  std::size_t current;
+  std::size_t depth;
+}; // struct Buffer
+
+
+Buffer& buffer()
+{
+  static thread_local Buffer instance;
+  return instance;
+}
+
+
+} // namespace
+
+
+LocalfunctionArena::Scope::Scope()
+{
+  auto& buf = buffer();
+  // the outermost scope may reuse all of the buffer, apart from the blocks which outlived earlier scopes
+  if (buf.depth++ == 0 || buf.current == buf.chunks.size()) {
+    chunk_ = 0;
+    offset_ = 0;
+  } else {
+    chunk_ = buf.current;
+    offset_ = buf.chunks[buf.current]->used;
+  }
+}
+
+LocalfunctionArena::Scope::~Scope()
+{
+  auto& buf = buffer();
+  assert(buf.depth > 0);
+  --buf.depth;
+  buf.rewind(chunk_, offset_);
+}
+
+void* LocalfunctionArena::allocate(const std::size_t bytes)
+{
+  auto& buf = buffer();
+  BlockHeader* header = nullptr;
+  if (buf.depth > 0) {
+    const std::size_t alignment = sizeof(BlockHeader);
+    header = buf.take(alignment + (bytes + alignment - 1) / alignment * alignment);
+  } else {
+    header = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + bytes));
+    header->chunk = nullptr;
+  }
+  return header + 1;
+} // ... allocate(...)
+
+void LocalfunctionArena::deallocate(void* ptr) noexcept
+{
+  if (ptr == nullptr)
+    return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  if (header->chunk != nullptr) {
+    header->size_and_alive &= ~std::size_t(1);
+    header->chunk->release();
+  } else
+    ::operator delete(header);
+}
+
+std::size_t LocalfunctionArena::num_alive()
+{
+  return buffer().num_alive();
+}
+
+std::size_t LocalfunctionArena::capacity()
+{
+  std::size_t ret = 0;
+  for (const auto& chunk : buffer().chunks)
+    ret += chunk->size;
+  for (const auto& chunk : buffer().retired)
+    ret += chunk->size;
+  return ret;
+}
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,130 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_ARENA_HH
+#define DUNE_XT_FUNCTIONS_ARENA_HH
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+
+
+/**
+ * \brief Per-thread bump allocator for the local functions created during grid walks.
+ *
+ * Local functions created by make_unique() (as those of GlobalFunctionInterface, Combined, CheckerboardFunction and
+ * RandomEllipsoidsFunction are) obtain their memory from allocate() and return it by deallocate(), the
+ * std::unique_ptr returned by local_function() releases it here as well. While a Scope exists on the calling thread,
+ * allocate() takes the memory from a buffer of this thread by advancing a pointer and deallocate() only marks the
+ * memory as free. When a scope ends, the buffer returns to where it was when the scope began, so the next scope reuses
+ * the same memory. It is freed when the thread ends, except for the chunks of memory holding blocks which are still
+ * alive, which are freed along with the last of them. Without a scope, the global heap is used. Thus
+\code
+for (auto&& entity : elements(grid_view)) {
+  LocalfunctionArena::Scope arena_scope;
+  const auto local_function = function.local_function(entity);
+  ...
+}
+\endcode
+ * does not touch the global heap after the first entity, unless local_function() allocates anything else or uses
+ * new instead of make_unique().
+ * \note Local functions which outlive their scope (e.g., one which is created once and then bound to each entity) stay
+ *       valid. The buffer only returns to the end of the last of them, or puts the chunk of memory holding them aside
+ *       until they are destroyed, so the memory used stays bounded as long as their number does.
+ */
+class LocalfunctionArena
+{
+public:
+  //! Makes allocate() use the buffer of this thread during its lifetime, may be nested.
+  class Scope
+  {
+  public:
+    Scope();
+
+    Scope(const Scope& other) = delete;
+
+    Scope& operator=(const Scope& other) = delete;
+
+    ~Scope();
+
+  private:
+    // where the buffer returns to at the end of this scope
+    std::size_t chunk_;
+    std::size_t offset_;
+  }; // class Scope
+
+  /**
+   * \brief T, allocated by allocate() and released by deallocate().
+   *
+   * Since the destructor of T is virtual, deleting this by a pointer to T or any other base (as std::default_delete
+   * does) calls the operator delete of this class.
+   */
+  template <class T>
+  class Allocated : public T
+  {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "The arena only aligns its blocks to std::max_align_t!");
+    static_assert(std::has_virtual_destructor<T>::value, "T has to be deleted by a pointer to Allocated<T>!");
+
+  public:
+    using T::T;
+
+    static void* operator new(std::size_t bytes)
+    {
+      return allocate(bytes);
+    }
+
+    static void operator delete(void* ptr) noexcept
+    {
+      deallocate(ptr);
+    }
+  }; // class Allocated
+
+  //! Creates a T as Allocated<T>, or by new if T is over-aligned or has no virtual destructor.
+  template <class T, class... Args>
+  static std::unique_ptr<T> make_unique(Args&&... args)
+  {
+    return make_unique_selected<T>(
+        std::integral_constant<bool,
+                               alignof(T) <= alignof(std::max_align_t) && std::has_virtual_destructor<T>::value>(),
+        std::forward<Args>(args)...);
+  }
+
+  static void* allocate(const std::size_t bytes);
+
+  static void deallocate(void* ptr) noexcept;
+
+  //! The number of blocks taken from the buffer of this thread, which have not been deallocated yet.
+  static std::size_t num_alive();
+
+  //! The size of the buffer of this thread in bytes, which only grows.
+  static std::size_t capacity();
+
+private:
+  template <class T, class... Args>
+  static std::unique_ptr<T> make_unique_selected(std::true_type /*use_arena*/, Args&&... args)
+  {
+    return std::unique_ptr<T>(new Allocated<T>(std::forward<Args>(args)...));
+  }
+
+  template <class T, class... Args>
+  static std::unique_ptr<T> make_unique_selected(std::false_type /*use_arena*/, Args&&... args)
+  {
+    return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+  }
+}; // class LocalfunctionArena
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_ARENA_HH
@@ -23,6 +23,7 @@
 #include <dune/xt/common/fvector.hh>
 
 #include <dune/xt/functions/affine.hh>
+#include <dune/xt/functions/arena.hh>
 #include <dune/xt/functions/constant.hh>
 #include <dune/xt/functions/expression.hh>
 
@@ -157,6 +158,122 @@ public:
 }; // class CheckerboardFunctionFactory< ... >
 
 
+/**
+ * \brief The local function of a CheckerboardFunction, which forwards to the local function of the value on the
+ *        subdomain of its entity.
+ *
+ * When bound to another entity, the local function of the value is rebound if the subdomain stays the same and
+ * replaced by one of the new value otherwise.
+ */
+template <class CheckerboardFunctionType>
+class CheckerboardLocalfunction : public CheckerboardFunctionType::LocalfunctionType
+{
+  typedef typename CheckerboardFunctionType::LocalfunctionType BaseType;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+  using typename BaseType::HessianRangeType;
+  using typename BaseType::QuadratureRuleType;
+
+  CheckerboardLocalfunction(const CheckerboardFunctionType& checkerboard, const EntityType& ent)
+    : BaseType(ent)
+    , checkerboard_(checkerboard)
+    , subdomain_(checkerboard_.subdomain(ent))
+    , local_function_(checkerboard_.values()[subdomain_]->local_function(ent))
+  {
+  }
+
+  virtual void bind(const EntityType& ent) override final
+  {
+    this->bind_entity(ent);
+    const size_t subdomain = checkerboard_.subdomain(ent);
+    if (subdomain == subdomain_) {
+      local_function_->bind(ent);
+    } else {
+      local_function_ = checkerboard_.values()[subdomain]->local_function(ent);
+      subdomain_ = subdomain;
+    }
+  } // ... bind(...)
+
+  virtual size_t order(const Common::Parameter& mu = {}) const override final
+  {
+    return local_function_->order(mu);
+  }
+
+  using BaseType::evaluate;
+
+  virtual void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->evaluate(xx, ret, mu);
+  }
+
+  virtual void evaluate(const QuadratureRuleType& quadrature,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->evaluate(quadrature, ret, mu);
+  }
+
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->evaluate(xx, ret, mu);
+  }
+
+  using BaseType::jacobian;
+
+  virtual void
+  jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->jacobian(xx, ret, mu);
+  }
+
+  virtual void jacobian(const QuadratureRuleType& quadrature,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->jacobian(quadrature, ret, mu);
+  }
+
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->jacobian(xx, ret, mu);
+  }
+
+  virtual void evaluate_with_jacobian(const DomainType& xx,
+                                      RangeType& value,
+                                      JacobianRangeType& derivative,
+                                      const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->evaluate_with_jacobian(xx, value, derivative, mu);
+  }
+
+  using BaseType::hessian;
+
+  virtual void
+  hessian(const DomainType& xx, HessianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    local_function_->hessian(xx, ret, mu);
+  }
+
+  virtual bool bounds(RangeType& lower, RangeType& upper, const Common::Parameter& mu = {}) const override final
+  {
+    return local_function_->bounds(lower, upper, mu);
+  }
+
+private:
+  const CheckerboardFunctionType& checkerboard_;
+  size_t subdomain_;
+  std::unique_ptr<BaseType> local_function_;
+}; // class CheckerboardLocalfunction
+
+
 } // namespace internal
 
 
@@ -288,8 +405,7 @@ public:
 
   virtual std::unique_ptr<LocalfunctionType> local_function(const EntityType& entity) const override
   {
-    const size_t subdomain = find_subdomain(entity);
-    return values_[subdomain]->local_function(entity);
+    return create_local_function(entity);
   }
 
   size_t subdomain(const EntityType& entity) const
@@ -308,6 +424,23 @@ public:
   }
 
 private:
+  // the local functions of non-flux values are wrapped, so that they can be rebound across subdomains (see
+  // internal::CheckerboardLocalfunction)
+  template <class L = LocalizableFunctionType>
+  typename std::enable_if<is_localizable_function<L>::value, std::unique_ptr<LocalfunctionType>>::type
+  create_local_function(const EntityType& entity) const
+  {
+    return LocalfunctionArena::make_unique<internal::CheckerboardLocalfunction<ThisType>>(*this, entity);
+  }
+
+  template <class L = LocalizableFunctionType>
+  typename std::enable_if<!is_localizable_function<L>::value, std::unique_ptr<LocalfunctionType>>::type
+  create_local_function(const EntityType& entity) const
+  {
+    const size_t subdomain = find_subdomain(entity);
+    return values_[subdomain]->local_function(entity);
+  }
+
   template <class L>
   std::vector<L> make_constant_functions(const std::vector<RangeType>& values)
   {
@@ -19,6 +19,7 @@
 
 #include <dune/xt/common/memory.hh>
 
+#include <dune/xt/functions/arena.hh>
 #include <dune/xt/functions/interfaces.hh>
 
 namespace Dune {
@@ -105,6 +106,7 @@ public:
   typedef typename LocalfunctionInterface<E, D, d, R, r, rC>::DomainType DomainType;
   typedef typename LocalfunctionInterface<E, D, d, R, r, rC>::RangeType RangeType;
   typedef typename LocalfunctionInterface<E, D, d, R, r, rC>::JacobianRangeType JacobianRangeType;
+  typedef typename LocalfunctionInterface<E, D, d, R, r, rC>::HessianRangeType HessianRangeType;
 
 private:
   template <Combination cc, bool anything = true>
@@ -127,8 +129,9 @@ private:
       return std::max(left_order, right_order);
     }
 
-    static void evaluate(const LeftLocalfunctionType& left_local,
-                         const RightLocalfunctionType& right_local,
+    template <class LeftLocalType, class RightLocalType>
+    static void evaluate(const LeftLocalType& left_local,
+                         const RightLocalType& right_local,
                          const DomainType& xx,
                          RangeType& ret,
                          const Common::Parameter& mu,
@@ -139,8 +142,9 @@ private:
       ret -= tmp_ret;
     } // ... evaluate(...)
 
-    static void jacobian(const LeftLocalfunctionType& left_local,
-                         const RightLocalfunctionType& right_local,
+    template <class LeftLocalType, class RightLocalType>
+    static void jacobian(const LeftLocalType& left_local,
+                         const RightLocalType& right_local,
                          const DomainType& xx,
                          JacobianRangeType& ret,
                          const Common::Parameter& mu,
@@ -150,6 +154,18 @@ private:
       right_local.jacobian(xx, tmp_ret, mu);
       ret -= tmp_ret;
     } // ... jacobian(...)
+
+    static void hessian(const LeftLocalfunctionType& left_local,
+                        const RightLocalfunctionType& right_local,
+                        const DomainType& xx,
+                        HessianRangeType& ret,
+                        const Common::Parameter& mu,
+                        HessianRangeType& tmp_ret)
+    {
+      left_local.hessian(xx, ret, mu);
+      right_local.hessian(xx, tmp_ret, mu);
+      ret -= tmp_ret;
+    } // ... hessian(...)
   }; // class Call< ..., difference >
 
   template <bool anything>
@@ -166,8 +182,9 @@ private:
       return std::max(left_order, right_order);
     }
 
-    static void evaluate(const LeftLocalfunctionType& left_local,
-                         const RightLocalfunctionType& right_local,
+    template <class LeftLocalType, class RightLocalType>
+    static void evaluate(const LeftLocalType& left_local,
+                         const RightLocalType& right_local,
                          const DomainType& xx,
                          RangeType& ret,
                          const Common::Parameter& mu,
@@ -178,8 +195,9 @@ private:
       ret += tmp_ret;
     } // ... evaluate(...)
 
-    static void jacobian(const LeftLocalfunctionType& left_local,
-                         const RightLocalfunctionType& right_local,
+    template <class LeftLocalType, class RightLocalType>
+    static void jacobian(const LeftLocalType& left_local,
+                         const RightLocalType& right_local,
                          const DomainType& xx,
                          JacobianRangeType& ret,
                          const Common::Parameter& mu,
@@ -189,6 +207,18 @@ private:
       right_local.jacobian(xx, tmp_ret, mu);
       ret += tmp_ret;
     } // ... jacobian(...)
+
+    static void hessian(const LeftLocalfunctionType& left_local,
+                        const RightLocalfunctionType& right_local,
+                        const DomainType& xx,
+                        HessianRangeType& ret,
+                        const Common::Parameter& mu,
+                        HessianRangeType& tmp_ret)
+    {
+      left_local.hessian(xx, ret, mu);
+      right_local.hessian(xx, tmp_ret, mu);
+      ret += tmp_ret;
+    } // ... hessian(...)
   }; // class Call< ..., sum >
 
   // left only scalar atm
@@ -206,8 +236,9 @@ private:
       return left_order + right_order;
     }
 
-    static void evaluate(const LeftLocalfunctionType& left_local,
-                         const RightLocalfunctionType& right_local,
+    template <class LeftLocalType, class RightLocalType>
+    static void evaluate(const LeftLocalType& left_local,
+                         const RightLocalType& right_local,
                          const DomainType& xx,
                          RangeType& ret,
                          const Common::Parameter& mu,
@@ -218,8 +249,9 @@ private:
       ret *= left_value;
     } // ... evaluate(...)
 
-    static void jacobian(const LeftLocalfunctionType& /*left_local*/,
-                         const RightLocalfunctionType& /*right_local*/,
+    template <class LeftLocalType, class RightLocalType>
+    static void jacobian(const LeftLocalType& /*left_local*/,
+                         const RightLocalType& /*right_local*/,
                          const DomainType& /*xx*/,
                          JacobianRangeType& /*ret*/,
                          const Common::Parameter& /*mu*/,
@@ -227,6 +259,16 @@ private:
     {
       DUNE_THROW(NotImplemented, "If you need this, implement it!");
     }
+
+    static void hessian(const LeftLocalfunctionType& /*left_local*/,
+                        const RightLocalfunctionType& /*right_local*/,
+                        const DomainType& /*xx*/,
+                        HessianRangeType& /*ret*/,
+                        const Common::Parameter& /*mu*/,
+                        HessianRangeType& /*tmp_ret*/)
+    {
+      DUNE_THROW(NotImplemented, "If you need this, implement it!");
+    }
   }; // class Call< ..., product >
 
 public:
@@ -240,8 +282,9 @@ public:
     return Call<comb>::order(left_order, right_order);
   }
 
-  static void evaluate(const LeftLocalfunctionType& left_local,
-                       const RightLocalfunctionType& right_local,
+  template <class LeftLocalType, class RightLocalType>
+  static void evaluate(const LeftLocalType& left_local,
+                       const RightLocalType& right_local,
                        const DomainType& xx,
                        RangeType& ret,
                        const Common::Parameter& mu,
@@ -250,8 +293,9 @@ public:
     Call<comb>::evaluate(left_local, right_local, xx, ret, mu, tmp_ret);
   }
 
-  static void jacobian(const LeftLocalfunctionType& left_local,
-                       const RightLocalfunctionType& right_local,
+  template <class LeftLocalType, class RightLocalType>
+  static void jacobian(const LeftLocalType& left_local,
+                       const RightLocalType& right_local,
                        const DomainType& xx,
                        JacobianRangeType& ret,
                        const Common::Parameter& mu,
@@ -259,6 +303,16 @@ public:
   {
     Call<comb>::jacobian(left_local, right_local, xx, ret, mu, tmp_ret);
   }
+
+  static void hessian(const LeftLocalfunctionType& left_local,
+                      const RightLocalfunctionType& right_local,
+                      const DomainType& xx,
+                      HessianRangeType& ret,
+                      const Common::Parameter& mu,
+                      HessianRangeType& tmp_ret)
+  {
+    Call<comb>::hessian(left_local, right_local, xx, ret, mu, tmp_ret);
+  }
 }; // class SelectCombined
 
 /**
@@ -289,6 +343,7 @@ public:
   typedef typename BaseType::DomainType DomainType;
   typedef typename BaseType::RangeType RangeType;
   typedef typename BaseType::JacobianRangeType JacobianRangeType;
+  typedef typename BaseType::HessianRangeType HessianRangeType;
 
   CombinedLocalFunction(const LeftType& left, const RightType& right, const EntityType& ent)
     : BaseType(ent)
@@ -299,6 +354,13 @@ public:
   {
   }
 
+  virtual void bind(const EntityType& ent) override final
+  {
+    this->bind_entity(ent);
+    left_local_->bind(ent);
+    right_local_->bind(ent);
+  }
+
   virtual size_t order(const XT::Common::Parameter& mu = {}) const override final
   {
     return Select::order(left_local_->order(mu), right_local_->order(mu));
@@ -315,13 +377,94 @@ public:
     Select::jacobian(*left_local_, *right_local_, xx, ret, mu, tmp_jacobian_);
   }
 
+  virtual void
+  hessian(const DomainType& xx, HessianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    Select::hessian(*left_local_, *right_local_, xx, ret, mu, tmp_hessian_);
+  }
+
 private:
-  const std::unique_ptr<const typename LeftType::LocalfunctionType> left_local_;
-  const std::unique_ptr<const typename RightType::LocalfunctionType> right_local_;
+  const std::unique_ptr<typename LeftType::LocalfunctionType> left_local_;
+  const std::unique_ptr<typename RightType::LocalfunctionType> right_local_;
   mutable RangeType tmp_range_;
   mutable JacobianRangeType tmp_jacobian_;
+  mutable HessianRangeType tmp_hessian_;
 }; // class CombinedLocalFunction
 
+/**
+ * \brief Statically dispatched counterpart of CombinedLocalFunction, which holds the statically dispatched local
+ *        functions of both operands by value (see StaticLocalfunction).
+ *
+ * \note Most likely you do not want to use this class directly, but Combined::static_local_function().
+ */
+template <class LeftType, class RightType, Combination type>
+class StaticCombinedLocalFunction
+    : public StaticLocalfunctionInterface<StaticCombinedLocalFunction<LeftType, RightType, type>,
+                                          typename SelectCombined<LeftType, RightType, type>::E,
+                                          typename SelectCombined<LeftType, RightType, type>::D,
+                                          SelectCombined<LeftType, RightType, type>::d,
+                                          typename SelectCombined<LeftType, RightType, type>::R,
+                                          SelectCombined<LeftType, RightType, type>::r,
+                                          SelectCombined<LeftType, RightType, type>::rC>
+{
+  typedef StaticLocalfunctionInterface<StaticCombinedLocalFunction<LeftType, RightType, type>,
+                                       typename SelectCombined<LeftType, RightType, type>::E,
+                                       typename SelectCombined<LeftType, RightType, type>::D,
+                                       SelectCombined<LeftType, RightType, type>::d,
+                                       typename SelectCombined<LeftType, RightType, type>::R,
+                                       SelectCombined<LeftType, RightType, type>::r,
+                                       SelectCombined<LeftType, RightType, type>::rC>
+      BaseType;
+
+  typedef SelectCombined<LeftType, RightType, type> Select;
+  typedef StaticLocalfunction<LeftType> LeftLocal;
+  typedef StaticLocalfunction<RightType> RightLocal;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+
+  StaticCombinedLocalFunction(const LeftType& left, const RightType& right, const EntityType& ent)
+    : BaseType(ent)
+    , left_local_(LeftLocal::create(left, ent))
+    , right_local_(RightLocal::create(right, ent))
+  {
+  }
+
+  void bind(const EntityType& ent)
+  {
+    this->bind_entity(ent);
+    left_local_.bind(ent);
+    right_local_.bind(ent);
+  }
+
+  size_t order(const XT::Common::Parameter& mu = {}) const
+  {
+    return Select::order(left_local_.order(mu), right_local_.order(mu));
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    RangeType tmp_range;
+    Select::evaluate(left_local_, right_local_, xx, ret, mu, tmp_range);
+  }
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    JacobianRangeType tmp_jacobian;
+    Select::jacobian(left_local_, right_local_, xx, ret, mu, tmp_jacobian);
+  }
+
+private:
+  typename LeftLocal::type left_local_;
+  typename RightLocal::type right_local_;
+}; // class StaticCombinedLocalFunction
+
 /**
  * \brief Generic combined function.
  *
@@ -388,6 +531,7 @@ class Combined : public LocalizableFunctionInterface<typename SelectCombined<Lef
 public:
   typedef typename BaseType::EntityType EntityType;
   typedef typename BaseType::LocalfunctionType LocalfunctionType;
+  typedef StaticCombinedLocalFunction<LeftType, RightType, comb> StaticLocalfunctionType;
 
   Combined(const LeftType& left, const RightType& right, const std::string nm = "")
     : left_(Common::make_unique<LeftStorageType>(left))
@@ -425,9 +569,17 @@ public:
     typedef CombinedLocalFunction<LeftType, RightType, comb> RealLocalFunctionType;
     assert(left_);
     assert(right_);
-    return Common::make_unique<RealLocalFunctionType>(left_->access(), right_->access(), entity);
+    return LocalfunctionArena::make_unique<RealLocalFunctionType>(left_->access(), right_->access(), entity);
   } // ... local_function(...)
 
+  //! Statically dispatched counterpart of local_function(), \sa StaticLocalfunctionInterface
+  StaticLocalfunctionType static_local_function(const EntityType& entity) const
+  {
+    assert(left_);
+    assert(right_);
+    return StaticLocalfunctionType(left_->access(), right_->access(), entity);
+  }
+
   virtual ThisType* copy() const
   {
     DUNE_THROW(NotImplemented, "Are you kidding me?");
@@ -13,7 +13,9 @@
 #ifndef DUNE_XT_FUNCTIONS_CONSTANT_HH
 #define DUNE_XT_FUNCTIONS_CONSTANT_HH
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <dune/xt/common/configuration.hh>
 
@@ -162,8 +164,11 @@ public:
   typedef typename BaseType::DomainType DomainType;
   typedef typename BaseType::RangeType RangeType;
   typedef typename BaseType::JacobianRangeType JacobianRangeType;
+  typedef typename BaseType::HessianRangeType HessianRangeType;
+  typedef typename BaseType::StridedValuesViewType StridedValuesViewType;
 
   using typename BaseType::LocalfunctionType;
+  typedef StaticGlobalLocalfunction<ThisType> StaticLocalfunctionType;
 
   static_assert(std::is_same<typename LocalfunctionType::RangeType, RangeType>::value, "RangeType mismatch");
   static_assert(std::is_same<typename LocalfunctionType::DomainType, DomainType>::value, "DomainType mismatch");
@@ -226,17 +231,68 @@ public:
     return 0;
   }
 
+  using BaseType::evaluate;
+
+  virtual void evaluate(const DomainType& x, RangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    evaluate_static(x, ret, mu);
+  }
+
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    ret.assign(xx.size(), constant_);
+  }
+
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    assert(ret.num_components() == FlatComponents<RangeType>::size && ret.num_points() >= xx.size());
+    for (size_t cc = 0; cc < FlatComponents<RangeType>::size; ++cc)
+      std::fill_n(ret.row(cc, 0), xx.size(), FlatComponents<RangeType>::at(constant_, cc));
+  }
+
+  using BaseType::jacobian;
+
   virtual void
-  evaluate(const DomainType& /*x*/, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  jacobian(const DomainType& x, JacobianRangeType& ret, const Common::Parameter& mu = {}) const override final
   {
-    ret = constant_;
+    jacobian_static(x, ret, mu);
+  }
+
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    ret.assign(xx.size(), JacobianRangeType(0));
+  }
+
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    assert(ret.num_components() == FlatComponents<JacobianRangeType>::size && ret.num_points() >= xx.size());
+    for (size_t cc = 0; cc < FlatComponents<JacobianRangeType>::size; ++cc)
+      std::fill_n(ret.row(cc, 0), xx.size(), 0.);
   }
 
   virtual void
-  jacobian(const DomainType& /*x*/, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  hessian(const DomainType& /*x*/, HessianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
   {
-    //! TODO: why not ```ret *=0```?
-    clear_jacobian<rangeDim, rangeDimCols>()(ret);
+    HessianRangeTypeSelector<domainDim, RangeFieldImp, rangeDim, rangeDimCols>::set_zero(ret);
+  }
+
+  virtual bool bounds(const DomainType& /*lower_corner*/,
+                      const DomainType& /*upper_corner*/,
+                      RangeType& lower,
+                      RangeType& upper,
+                      const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    lower = constant_;
+    upper = constant_;
+    return true;
   }
 
   virtual std::string name() const override final
@@ -244,6 +300,28 @@ public:
     return name_;
   }
 
+  /**
+   * \name ´´Statically dispatched (and inlinable) counterparts of local_function(), evaluate() and jacobian().''
+   * \sa   StaticLocalfunctionInterface
+   * \{
+   **/
+  StaticLocalfunctionType static_local_function(const EntityImp& entity) const
+  {
+    return StaticLocalfunctionType(*this, entity);
+  }
+
+  void evaluate_static(const DomainType& /*x*/, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const
+  {
+    ret = constant_;
+  }
+
+  void jacobian_static(const DomainType& /*x*/, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const
+  {
+    //! TODO: why not ```ret *=0```?
+    clear_jacobian<rangeDim, rangeDimCols>()(ret);
+  }
+  /* \} */
+
 private:
   template <size_t _r, size_t _rC, class Anything = void>
   struct clear_jacobian
@@ -100,19 +100,21 @@ private:
       return boost::numeric_cast<size_t>(std::max(boost::numeric_cast<ssize_t>(ord) - 1, ssize_t(0)));
     }
 
-    static void evaluate(const FunctionLocalfunctionType& func_local,
+    template <class FunctionLocalType>
+    static void evaluate(const FunctionLocalType& func_local,
                          const DomainType& xx,
                          RangeType& ret,
                          const Common::Parameter& mu)
     {
-      typename FunctionLocalfunctionType::JacobianRangeType tmp_jac(0.0);
+      typename FunctionLocalType::JacobianRangeType tmp_jac(0.0);
       func_local.jacobian(xx, tmp_jac, mu);
       ret *= 0.0;
       for (size_t dd = 0; dd < d; ++dd)
         ret[0] += tmp_jac[dd][dd];
     } // ... evaluate(...)
 
-    static void jacobian(const FunctionLocalfunctionType& /*func_local*/,
+    template <class FunctionLocalType>
+    static void jacobian(const FunctionLocalType& /*func_local*/,
                          const DomainType& /*xx*/,
                          JacobianRangeType& /*ret*/,
                          const Common::Parameter& /*mu*/)
@@ -132,7 +134,8 @@ public:
     return Call<derivative>::order(ord);
   }
 
-  static void evaluate(const FunctionLocalfunctionType& func_local,
+  template <class FunctionLocalType>
+  static void evaluate(const FunctionLocalType& func_local,
                        const DomainType& xx,
                        RangeType& ret,
                        const Common::Parameter& mu)
@@ -140,7 +143,8 @@ public:
     Call<derivative>::evaluate(func_local, xx, ret, mu);
   }
 
-  static void jacobian(const FunctionLocalfunctionType& func_local,
+  template <class FunctionLocalType>
+  static void jacobian(const FunctionLocalType& func_local,
                        const DomainType& xx,
                        JacobianRangeType& ret,
                        const Common::Parameter& mu)
@@ -180,6 +184,12 @@ public:
   {
   }
 
+  virtual void bind(const EntityType& ent) override final
+  {
+    this->bind_entity(ent);
+    func_local_->bind(ent);
+  }
+
   virtual size_t order(const XT::Common::Parameter& mu = {}) const override final
   {
     return Select::order(func_local_->order(mu));
@@ -197,10 +207,74 @@ public:
   }
 
 private:
-  const std::unique_ptr<const typename FunctionType::LocalfunctionType> func_local_;
+  const std::unique_ptr<typename FunctionType::LocalfunctionType> func_local_;
 }; // class DerivedLocalFunction
 
 
+//! Statically dispatched counterpart of DerivedLocalFunction, \sa StaticLocalfunctionInterface
+template <class FunctionType, Derivative derivative>
+class StaticDerivedLocalFunction
+    : public StaticLocalfunctionInterface<StaticDerivedLocalFunction<FunctionType, derivative>,
+                                          typename SelectDerived<FunctionType, derivative>::E,
+                                          typename SelectDerived<FunctionType, derivative>::D,
+                                          SelectDerived<FunctionType, derivative>::d,
+                                          typename SelectDerived<FunctionType, derivative>::R,
+                                          SelectDerived<FunctionType, derivative>::r,
+                                          SelectDerived<FunctionType, derivative>::rC>
+{
+  typedef StaticLocalfunctionInterface<StaticDerivedLocalFunction<FunctionType, derivative>,
+                                       typename SelectDerived<FunctionType, derivative>::E,
+                                       typename SelectDerived<FunctionType, derivative>::D,
+                                       SelectDerived<FunctionType, derivative>::d,
+                                       typename SelectDerived<FunctionType, derivative>::R,
+                                       SelectDerived<FunctionType, derivative>::r,
+                                       SelectDerived<FunctionType, derivative>::rC>
+      BaseType;
+
+  typedef SelectDerived<FunctionType, derivative> Select;
+  typedef StaticLocalfunction<FunctionType> FunctionLocal;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+
+  StaticDerivedLocalFunction(const FunctionType& func, const EntityType& ent)
+    : BaseType(ent)
+    , func_local_(FunctionLocal::create(func, ent))
+  {
+  }
+
+  void bind(const EntityType& ent)
+  {
+    this->bind_entity(ent);
+    func_local_.bind(ent);
+  }
+
+  size_t order(const XT::Common::Parameter& mu = {}) const
+  {
+    return Select::order(func_local_.order(mu));
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    Select::evaluate(func_local_, xx, ret, mu);
+  }
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    Select::jacobian(func_local_, xx, ret, mu);
+  }
+
+private:
+  typename FunctionLocal::type func_local_;
+}; // class StaticDerivedLocalFunction
+
+
 template <class FunctionType, Derivative derivative>
 class Derived : public LocalizableFunctionInterface<typename SelectDerived<FunctionType, derivative>::E,
                                                     typename SelectDerived<FunctionType, derivative>::D,
@@ -222,6 +296,7 @@ class Derived : public LocalizableFunctionInterface<typename SelectDerived<Funct
 public:
   typedef typename BaseType::EntityType EntityType;
   typedef typename BaseType::LocalfunctionType LocalfunctionType;
+  typedef StaticDerivedLocalFunction<FunctionType, derivative> StaticLocalfunctionType;
 
   Derived(const FunctionType& func, const std::string nm = "")
     : func_(Common::make_unique<FunctionStorageType>(func))
@@ -248,6 +323,13 @@ public:
     return Common::make_unique<RealLocalFunctionType>(func_->access(), entity);
   } // ... local_function(...)
 
+  //! Statically dispatched counterpart of local_function(), \sa StaticLocalfunctionInterface
+  StaticLocalfunctionType static_local_function(const EntityType& entity) const
+  {
+    assert(func_);
+    return StaticLocalfunctionType(func_->access(), entity);
+  }
+
   virtual ThisType* copy() const
   {
     DUNE_THROW(NotImplemented, "Are you kidding me?");
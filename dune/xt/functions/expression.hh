@@ -15,6 +15,7 @@
 
 #include "expression/default.hh"
 #include "expression/parametric.hh"
+#include "expression/static.hh"
 #include "expression.lib.hh"
 
 #endif // DUNE_XT_FUNCTIONS_EXPRESSION_HH
@@ -13,28 +13,107 @@
 #ifndef DUNE_XT_FUNCTIONS_EXPRESSION_BASE_HH
 #define DUNE_XT_FUNCTIONS_EXPRESSION_BASE_HH
 
-#include <mutex>
+#include <algorithm>
+#include <memory>
 #include <sstream>
 #include <vector>
 
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <dune/common/dynmatrix.hh>
 #include <dune/common/dynvector.hh>
 #include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 
 #include <dune/xt/common/color.hh>
 #include <dune/xt/common/exceptions.hh>
+#include <dune/xt/common/memory.hh>
 #include <dune/xt/common/string.hh>
 
+#include "cache.hh"
+#include "jit.hh"
 #include "mathexpr.hh"
 
-#ifndef DUNE_XT_FUNCTIONS_EXPRESSION_BASE_MAX_DYNAMIC_SIZE
-#define DUNE_XT_FUNCTIONS_EXPRESSION_BASE_MAX_DYNAMIC_SIZE 64
-#endif
 
 
 namespace Dune {
 namespace XT {
 namespace Functions {
+namespace internal {
+
+
+/**
+ * \brief Parses expressions (see ROperation) and compiles them into an RProgram, which is all the expression bases
+ *        evaluate (see CompiledMathExpressions).
+ *
+ * An instance is only needed until its programs have been created, which do not depend on it any more. The
+ * variables and the argument slots they are created with are stored in one block each, sized to the number of
+ * variables.
+ */
+class MathExpressionParser
+{
+public:
+  MathExpressionParser(const std::vector<std::string>& variables, const std::vector<std::string>& expressions)
+    : args_(variables.size(), 0.)
+  {
+    // the ROperations keep pointers to the variables, so vars_ must not reallocate
+    vars_.reserve(variables.size());
+    std::vector<RVar*> vararray(variables.size(), nullptr);
+    for (size_t ii = 0; ii < variables.size(); ++ii) {
+      vars_.emplace_back(variables[ii].c_str(), &args_[ii]);
+      vararray[ii] = &vars_[ii];
+    }
+    for (const auto& expression : expressions)
+      ops_.emplace_back(new ROperation(expression.c_str(), static_cast<int>(vararray.size()), vararray.data()));
+  }
+
+  MathExpressionParser(const MathExpressionParser& other) = delete;
+
+  MathExpressionParser& operator=(const MathExpressionParser& other) = delete;
+
+  //! Compiles all expressions into one program.
+  RProgram program() const
+  {
+    std::vector<const ROperation*> ops(ops_.size(), nullptr);
+    std::vector<const RVar*> vars(vars_.size(), nullptr);
+    for (size_t ii = 0; ii < ops_.size(); ++ii)
+      ops[ii] = ops_[ii].get();
+    for (size_t ii = 0; ii < vars_.size(); ++ii)
+      vars[ii] = &vars_[ii];
+    return RProgram(static_cast<int>(ops.size()), ops.data(), static_cast<int>(vars.size()), vars.data());
+  }
+
+  /**
+   * \brief Compiles the derivatives of all expressions w.r.t. all variables (see ROperation::Diff) into one program.
+   *
+   * The derivative of the ii-th expression w.r.t. the jj-th variable is the (ii * num_variables + jj)-th output.
+   */
+  RProgram derivative_program() const
+  {
+    std::vector<ROperation> derivatives;
+    derivatives.reserve(ops_.size() * vars_.size());
+    for (const auto& op : ops_)
+      for (const auto& var : vars_)
+        derivatives.emplace_back(op->Diff(var));
+    std::vector<const ROperation*> ops(derivatives.size(), nullptr);
+    std::vector<const RVar*> vars(vars_.size(), nullptr);
+    for (size_t ii = 0; ii < derivatives.size(); ++ii)
+      ops[ii] = &derivatives[ii];
+    for (size_t ii = 0; ii < vars_.size(); ++ii)
+      vars[ii] = &vars_[ii];
+    return RProgram(static_cast<int>(ops.size()), ops.data(), static_cast<int>(vars.size()), vars.data());
+  }
+
+private:
+  // only referenced by the RVars, the programs read their arguments from the memory they are given
+  std::vector<double> args_;
+  std::vector<RVar> vars_;
+  std::vector<std::unique_ptr<ROperation>> ops_;
+}; // class MathExpressionParser
+
+
+} // namespace internal
 
 
 /**
@@ -72,18 +151,12 @@ public:
   ThisType& operator=(const ThisType& _other)
   {
     if (this != &_other) {
-      cleanup();
       variable_ = "";
       variables_ = std::vector<std::string>();
       expressions_ = std::vector<std::string>();
       setup(_other.variable(), _other.expression());
     }
-    return this;
-  }
-
-  ~MathExpressionBase()
-  {
-    cleanup();
+    return *this;
   }
 
   std::string variable() const
@@ -99,13 +172,7 @@ public:
   void evaluate(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
                 Dune::FieldVector<RangeFieldType, dimRange>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
-    // copy arg
-    for (typename Dune::FieldVector<DomainFieldType, dimDomain>::size_type ii = 0; ii < dimDomain; ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::FieldVector<RangeFieldType, dimRange>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluate_point(arg, dimDomain, ret);
   }
 
   /**
@@ -113,32 +180,20 @@ public:
    */
   void evaluate(const Dune::DynamicVector<DomainFieldType>& arg, Dune::DynamicVector<RangeFieldType>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     // check for sizes
     assert(arg.size() > 0);
     if (ret.size() != dimRange)
       ret = Dune::DynamicVector<RangeFieldType>(dimRange);
-    // copy arg
-    for (size_t ii = 0; ii < std::min(domainDim, arg.size()); ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::DynamicVector<RangeFieldType>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluate_point(arg, std::min(domainDim, arg.size()), ret);
   }
 
   void evaluate(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
                 Dune::DynamicVector<RangeFieldType>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     // check for sizes
     if (ret.size() != dimRange)
       ret = Dune::DynamicVector<RangeFieldType>(dimRange);
-    // copy arg
-    for (typename Dune::FieldVector<DomainFieldType, dimDomain>::size_type ii = 0; ii < dimDomain; ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
-    for (typename Dune::DynamicVector<RangeFieldType>::size_type ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+    evaluate_point(arg, dimDomain, ret);
   }
 
   /**
@@ -146,16 +201,187 @@ public:
    */
   void evaluate(const Dune::DynamicVector<DomainFieldType>& arg, Dune::FieldVector<RangeFieldType, dimRange>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     assert(arg.size() > 0);
-    // copy arg
-    for (size_t ii = 0; ii < std::min(dimDomain, arg.size()); ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
+    evaluate_point(arg, std::min(dimDomain, arg.size()), ret);
+  }
+
+  /**
+   * \brief Evaluates all expressions at once, ret[rr][cc] being the value of the (rr * cols + cc)-th expression.
+   *
+   * All expressions are compiled into one program, which computes subexpressions shared by several entries only once
+   * and writes its results directly into ret.
+   */
+  template <int rows, int cols>
+  void evaluate(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
+                Dune::FieldMatrix<RangeFieldType, rows, cols>& ret) const
+  {
+    static_assert(rows * cols == dimRange, "ret has to hold exactly dimRange entries!");
+    evaluate_point(arg, dimDomain, ret);
+  }
+
+  /**
+   * \brief Evaluates all expressions at one point.
+   * \param args   the values of x[0], ..., x[dimDomain - 1]
+   * \param values receives the dimRange values of the expressions
+   */
+  void evaluate(const double* args, double* values) const
+  {
+    if (compiled_->jit)
+      compiled_->jit->evaluate(args, values);
+    else
+      compiled_->program.Val(args, values);
+  }
+
+  /**
+   * \brief Evaluates the derivatives of all expressions w.r.t. all variables, ret[ii][jj] being the one of the ii-th
+   *        expression w.r.t. x[jj].
+   *
+   * The derivatives are computed along with the values in one pass through the compiled expressions (see
+   * RProgram::ValDerivatives), or by the native code of their symbolic derivatives (see ROperation::Diff) if
+   * JitMathExpression is enabled.
+   */
+  void jacobian(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
+                Dune::FieldMatrix<RangeFieldType, dimRange, dimDomain>& ret) const
+  {
+    double args[dimDomain];
+    double values[dimRange];
+    double derivatives[dimRange * dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[ii] = arg[ii];
+    if (compiled_->derivative_jit())
+      compiled_->derivative_jit()->evaluate(args, derivatives);
+    else
+      compiled_->program.ValDerivatives(args, values, derivatives);
     for (size_t ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+      for (size_t jj = 0; jj < dimDomain; ++jj)
+        ret[ii][jj] = derivatives[ii * dimDomain + jj];
+  } // ... jacobian(...)
+
+  /**
+   * \brief Evaluates all expressions and their derivatives w.r.t. all variables at once (see jacobian()).
+   */
+  void evaluate_with_jacobian(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
+                              Dune::FieldVector<RangeFieldType, dimRange>& value,
+                              Dune::FieldMatrix<RangeFieldType, dimRange, dimDomain>& ret) const
+  {
+    double args[dimDomain];
+    double values[dimRange];
+    double derivatives[dimRange * dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[ii] = arg[ii];
+    if (compiled_->derivative_jit()) {
+      evaluate(args, values);
+      compiled_->derivative_jit()->evaluate(args, derivatives);
+    } else
+      compiled_->program.ValDerivatives(args, values, derivatives);
+    for (size_t ii = 0; ii < dimRange; ++ii) {
+      value[ii] = values[ii];
+      for (size_t jj = 0; jj < dimDomain; ++jj)
+        ret[ii][jj] = derivatives[ii * dimDomain + jj];
+    }
+  } // ... evaluate_with_jacobian(...)
+
+  /**
+   * \brief Evaluates the second derivatives of all expressions w.r.t. all variables, ret[ii][jj][kk] being the one of
+   *        the ii-th expression w.r.t. x[jj] and x[kk].
+   *
+   * These are the derivatives of the symbolic first derivatives (see derivative_program()), computed along with them
+   * in one pass (see RProgram::ValDerivatives). Both orders of differentiation are averaged, so ret[ii] is symmetric.
+   */
+  void hessian(const Dune::FieldVector<DomainFieldType, dimDomain>& arg,
+               Dune::FieldVector<Dune::FieldMatrix<RangeFieldType, dimDomain, dimDomain>, dimRange>& ret) const
+  {
+    double args[dimDomain];
+    double derivatives[dimRange * dimDomain];
+    double second_derivatives[dimRange * dimDomain * dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[ii] = arg[ii];
+    compiled_->derivatives().program.ValDerivatives(args, derivatives, second_derivatives);
+    for (size_t ii = 0; ii < dimRange; ++ii) {
+      const double* second = second_derivatives + ii * dimDomain * dimDomain;
+      for (size_t jj = 0; jj < dimDomain; ++jj) {
+        ret[ii][jj][jj] = second[jj * dimDomain + jj];
+        for (size_t kk = 0; kk < jj; ++kk)
+          ret[ii][jj][kk] = ret[ii][kk][jj] = 0.5 * (second[jj * dimDomain + kk] + second[kk * dimDomain + jj]);
+      }
+    }
+  } // ... hessian(...)
+
+  /**
+   * \brief Evaluates at num_points points at once, which runs the compiled expressions once per block of points
+   *        instead of once per point.
+   * \param args   dimDomain pointers to the num_points values of x[0], x[1], ..., respectively
+   * \param values dimRange * num_points values, the ones of the ii-th expression are written to values[ii * num_points]
+   *               to values[(ii + 1) * num_points - 1]
+   */
+  void evaluate(const double* const* args, double* values, const size_t num_points) const
+  {
+    if (compiled_->jit)
+      compiled_->jit->evaluate(args, values, num_points);
+    else
+      compiled_->program.Val(args, values, num_points);
+  }
+
+  /**
+   * \brief Evaluates the derivatives (see jacobian()) at num_points points at once.
+   * \param args        see evaluate(const double* const*, double*, const size_t)
+   * \param derivatives dimRange * dimDomain * num_points values, the ones of the derivative of the ii-th expression
+   *                    w.r.t. x[jj] are written to derivatives[(ii * dimDomain + jj) * num_points] and following
+   */
+  void jacobian(const double* const* args, double* derivatives, const size_t num_points) const
+  {
+    if (compiled_->derivative_jit())
+      compiled_->derivative_jit()->evaluate(args, derivatives, num_points);
+    else
+      compiled_->derivatives().program.Val(args, derivatives, num_points);
   }
 
+  /**
+   * \brief Computes bounds of all expressions on the box lower[jj] <= x[jj] <= upper[jj] in interval arithmetic (see
+   *        RProgram::Bounds), lower_values[ii] <= ii-th expression <= upper_values[ii].
+   */
+  void bounds(const double* lower, const double* upper, double* lower_values, double* upper_values) const
+  {
+    compiled_->program.Bounds(lower, upper, lower_values, upper_values);
+  }
+
+  /**
+   * \brief Returns the maximal total polynomial degree of all expressions in x, or an estimate where every other
+   *        function of an argument of degree d counts as a polynomial of degree transcendental_degree * d (see
+   *        RProgram::Degrees).
+   */
+  size_t degree(const size_t transcendental_degree) const
+  {
+    std::vector<int> degrees(dimRange);
+    compiled_->program.Degrees(boost::numeric_cast<int>(transcendental_degree), degrees.data());
+    return size_t(*std::max_element(degrees.begin(), degrees.end()));
+  }
+
+  /**
+   * \attention results will be resized!
+   */
+  void evaluate(const std::vector<Dune::FieldVector<DomainFieldType, dimDomain>>& points,
+                std::vector<Dune::FieldVector<RangeFieldType, dimRange>>& results) const
+  {
+    const size_t num_points = points.size();
+    results.resize(num_points);
+    if (num_points == 0)
+      return;
+    // transpose to structure-of-arrays layout
+    std::vector<double> args(dimDomain * num_points);
+    std::vector<double> values(dimRange * num_points);
+    const double* arg_ptrs[dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii) {
+      arg_ptrs[ii] = args.data() + ii * num_points;
+      for (size_t pp = 0; pp < num_points; ++pp)
+        args[ii * num_points + pp] = points[pp][ii];
+    }
+    evaluate(arg_ptrs, values.data(), num_points);
+    for (size_t pp = 0; pp < num_points; ++pp)
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        results[pp][ii] = values[ii * num_points + pp];
+  } // ... evaluate(...)
+
   void report(const std::string _name = "function.mathexpressionbase",
               std::ostream& stream = std::cout,
               const std::string& _prefix = "") const
@@ -173,7 +399,79 @@ public:
     }
   } // void report(const std::string, std::ostream&, const std::string&) const
 
+  //! Reports the size of the compiled programs of all expressions and of their derivatives, before and after
+  //! RProgram::Optimize().
+  void report_instructions(std::ostream& stream = std::cout, const std::string& _prefix = "") const
+  {
+    const RProgram& program = compiled_->program;
+    const internal::CompiledMathDerivatives& derivatives = compiled_->derivatives();
+    stream << _prefix << "expressions: " << compiled_->num_unoptimized_instructions << " instructions, "
+           << program.NInstructions() << " after optimization (" << program.NTemporaries() << " temporaries)"
+           << std::endl;
+    stream << _prefix << "derivatives: " << derivatives.num_unoptimized_instructions << " instructions, "
+           << derivatives.program.NInstructions() << " after optimization (" << derivatives.program.NTemporaries()
+           << " temporaries)" << std::endl;
+  } // ... report_instructions(...)
+
+  const RProgram& program() const
+  {
+    return compiled_->program;
+  }
+
+  const RProgram& derivative_program() const
+  {
+    return compiled_->derivatives().program;
+  }
+
 private:
+  // The storage of the results, if the program can write to it directly, nullptr otherwise.
+  static double* raw_values(Dune::FieldVector<double, dimRange>& ret)
+  {
+    return &ret[0];
+  }
+
+  template <int rows, int cols>
+  static double* raw_values(Dune::FieldMatrix<double, rows, cols>& ret)
+  {
+    static_assert(sizeof(ret) == rows * cols * sizeof(double), "The entries of ret are not contiguous!");
+    return &ret[0][0];
+  }
+
+  template <class RetType>
+  static double* raw_values(RetType& /*ret*/)
+  {
+    return nullptr;
+  }
+
+  template <class VectorType>
+  static auto entry(VectorType& ret, const size_t ii) -> decltype(ret[ii])
+  {
+    return ret[ii];
+  }
+
+  template <class K, int rows, int cols>
+  static K& entry(Dune::FieldMatrix<K, rows, cols>& ret, const size_t ii)
+  {
+    return ret[ii / cols][ii % cols];
+  }
+
+  template <class ArgType, class RetType>
+  void evaluate_point(const ArgType& arg, const size_t num_args, RetType& ret) const
+  {
+    double args[dimDomain] = {};
+    for (size_t ii = 0; ii < num_args; ++ii)
+      args[ii] = arg[ii];
+    double* values = raw_values(ret);
+    if (values)
+      evaluate(args, values);
+    else {
+      double tmp[dimRange];
+      evaluate(args, tmp);
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        entry(ret, ii) = tmp[ii];
+    }
+  } // ... evaluate_point(...)
+
   void setup(const std::string& _variable, const std::vector<std::string>& _expression)
   {
     static_assert((dimDomain > 0), "Really?");
@@ -195,37 +493,15 @@ private:
       variableStream << variable_ << "[" << ii << "]";
       variables_.push_back(variableStream.str());
     }
-    // create expressions
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      arg_[ii] = new DomainFieldType(0.0);
-      var_arg_[ii] = new RVar(variables_[ii].c_str(), arg_[ii]);
-      vararray_[ii] = var_arg_[ii];
-    }
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      op_[ii] = new ROperation(expressions_[ii].c_str(), dimDomain, vararray_);
-    }
+    // all expressions (and their derivatives) are compiled into one program, which may be shared by all threads and
+    // all functions with the same expressions
+    compiled_ = MathExpressionCache::get(variables_, expressions_);
   } // void setup(const std::string& _variable, const std::vector< std::string >& expressions)
 
-  void cleanup()
-  {
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      delete op_[ii];
-    }
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      delete var_arg_[ii];
-      delete arg_[ii];
-    }
-  } // void cleanup()
-
   std::string variable_;
   std::vector<std::string> variables_;
   std::vector<std::string> expressions_;
-  size_t actualDimRange_;
-  mutable DomainFieldType* arg_[dimDomain];
-  RVar* var_arg_[dimDomain];
-  RVar* vararray_[dimDomain];
-  ROperation* op_[dimRange];
-  mutable std::mutex mutex_;
+  std::shared_ptr<const internal::CompiledMathExpressions> compiled_;
 }; // class MathExpressionBase
 
 
@@ -233,14 +509,13 @@ private:
  *  \brief      Base class that makes a function out of the stuff from mathexpr.hh
  *  \attention  Most surely you do not want to use this class directly, but Functions::ParametricExpressionFunction!
  */
-template <class D, class R, size_t r, size_t max_d = DUNE_XT_FUNCTIONS_EXPRESSION_BASE_MAX_DYNAMIC_SIZE>
+template <class D, class R, size_t r>
 class DynamicMathExpressionBase
 {
 public:
-  typedef DynamicMathExpressionBase<D, R, r, max_d> ThisType;
+  typedef DynamicMathExpressionBase<D, R, r> ThisType;
 
   typedef D DomainFieldType;
-  static const size_t maxDimDomain = max_d;
 
   typedef R RangeFieldType;
   static const size_t dimRange = r;
@@ -258,18 +533,11 @@ public:
   ThisType& operator=(const ThisType& other)
   {
     if (this != &other) {
-      cleanup();
       original_variables_ = other.original_variables_;
-      variables_ = std::vector<std::string>();
       expressions_ = std::vector<std::string>();
       setup(other.original_variables_, other.expressions_);
     }
-    return this;
-  }
-
-  ~DynamicMathExpressionBase()
-  {
-    cleanup();
+    return *this;
   }
 
   const std::vector<std::string>& variables() const
@@ -284,25 +552,108 @@ public:
 
   void evaluate(const DynamicVector<DomainFieldType>& arg, FieldVector<RangeFieldType, dimRange>& ret) const
   {
-    std::lock_guard<std::mutex> guard(mutex_);
     // check for sizes
     if (arg.size() != original_variables_.size())
       DUNE_THROW(Common::Exceptions::shapes_do_not_match,
                  "arg.size(): " << arg.size() << "\n   "
                                 << "variables.size(): "
                                 << original_variables_.size());
-    // copy arg
-    for (size_t ii = 0; ii < original_variables_.size(); ++ii)
-      *(arg_[ii]) = arg[ii];
-    // copy ret
+    std::vector<double> buffer;
+    double values[dimRange];
+    if (compiled_->jit)
+      compiled_->jit->evaluate(raw_args(arg, buffer), values);
+    else
+      compiled_->program.Val(raw_args(arg, buffer), values);
     for (size_t ii = 0; ii < dimRange; ++ii)
-      ret[ii] = op_[ii]->Val();
+      ret[ii] = values[ii];
+  }
+
+  /**
+   * \brief Evaluates the derivatives of all expressions w.r.t. all variables, ret[ii][jj] being the one of the ii-th
+   *        expression w.r.t. the jj-th variable (ret will be resized).
+   */
+  void jacobian(const DynamicVector<DomainFieldType>& arg, DynamicMatrix<RangeFieldType>& ret) const
+  {
+    jacobian(arg, 0, original_variables_.size(), ret);
+  }
+
+  /**
+   * \brief Evaluates the derivatives of all expressions w.r.t. the variables first, ..., first + num - 1, ret[ii][jj]
+   *        being the one of the ii-th expression w.r.t. the (first + jj)-th variable (ret will be resized).
+   *
+   * The derivatives are computed along with the values in one pass through the compiled expressions (see
+   * RProgram::ValDerivatives), or by the native code of their symbolic derivatives (see ROperation::Diff) if
+   * JitMathExpression is enabled.
+   */
+  void jacobian(const DynamicVector<DomainFieldType>& arg,
+                const size_t first,
+                const size_t num,
+                DynamicMatrix<RangeFieldType>& ret) const
+  {
+    const size_t num_variables = original_variables_.size();
+    if (arg.size() != num_variables)
+      DUNE_THROW(Common::Exceptions::shapes_do_not_match,
+                 "arg.size(): " << arg.size() << "\n   "
+                                << "variables.size(): "
+                                << num_variables);
+    if (first + num > num_variables)
+      DUNE_THROW(Common::Exceptions::index_out_of_range,
+                 "first + num: " << first + num << "\n   "
+                                 << "variables.size(): "
+                                 << num_variables);
+    if (ret.rows() != dimRange || ret.cols() != num)
+      ret = DynamicMatrix<RangeFieldType>(dimRange, num);
+    std::vector<double> buffer;
+    double values[dimRange];
+    if (compiled_->derivative_jit()) {
+      std::vector<double> derivatives(dimRange * num_variables);
+      compiled_->derivative_jit()->evaluate(raw_args(arg, buffer), derivatives.data());
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        for (size_t jj = 0; jj < num; ++jj)
+          ret[ii][jj] = derivatives[ii * num_variables + first + jj];
+    } else {
+      std::vector<double> derivatives(dimRange * num);
+      compiled_->program.ValDerivatives(raw_args(arg, buffer),
+                                        values,
+                                        derivatives.data(),
+                                        boost::numeric_cast<int>(first),
+                                        boost::numeric_cast<int>(num));
+      for (size_t ii = 0; ii < dimRange; ++ii)
+        for (size_t jj = 0; jj < num; ++jj)
+          ret[ii][jj] = derivatives[ii * num + jj];
+    }
+  } // ... jacobian(...)
+
+  //! All expressions compiled into one program, the variables of which are variables().
+  const RProgram& program() const
+  {
+    return compiled_->program;
+  }
+
+  //! The derivatives of all expressions, see jacobian().
+  const RProgram& derivative_program() const
+  {
+    return compiled_->derivatives().program;
   }
 
 private:
+  // The values of the variables as one array, buffer is only used if DomainFieldType is not double.
+  static const double* raw_args(const DynamicVector<double>& arg, std::vector<double>& /*buffer*/)
+  {
+    return arg.size() > 0 ? &arg[0] : nullptr;
+  }
+
+  template <class ArgType>
+  static const double* raw_args(const ArgType& arg, std::vector<double>& buffer)
+  {
+    buffer.resize(arg.size());
+    for (size_t ii = 0; ii < arg.size(); ++ii)
+      buffer[ii] = arg[ii];
+    return buffer.data();
+  }
+
   void setup(const std::vector<std::string>& vars, const std::vector<std::string>& exprs)
   {
-    static_assert((maxDimDomain > 0), "");
     static_assert((dimRange > 0), "");
     // set expressions
     if (exprs.size() != dimRange)
@@ -314,54 +665,18 @@ private:
     for (const auto& ex : expressions_)
       if (ex.empty())
         DUNE_THROW(Common::Exceptions::wrong_input_given, "Given expressions must not be empty!");
-    if (vars.size() > maxDimDomain)
-      DUNE_THROW(
-          Common::Exceptions::shapes_do_not_match,
-          "This expression function of dynamic size was compiled to work for up to "
-              << DUNE_XT_FUNCTIONS_EXPRESSION_BASE_MAX_DYNAMIC_SIZE
-              << " variables, but you provided "
-              << vars.size()
-              << "!\n\n"
-              << "Configure dune-xt-functions with a larger DUNE_XT_FUNCTIONS_EXPRESSION_BASE_MAX_DYNAMIC_SIZE!");
     original_variables_ = vars;
     for (const auto& var : original_variables_)
       if (var.empty())
         DUNE_THROW(Common::Exceptions::wrong_input_given, "Given variables must not be empty!");
-    variables_ = original_variables_;
-    for (size_t ii = variables_.size(); ii < maxDimDomain; ++ii)
-      variables_.push_back("this_is_a_long_dummy_name_to_make_sure_it_is_not_used_" + Common::to_string(ii));
-    assert(variables_.size() == maxDimDomain);
-    // create expressions
-    for (size_t ii = 0; ii < maxDimDomain; ++ii) {
-      arg_[ii] = new DomainFieldType(0.0);
-      var_arg_[ii] = new RVar(variables_[ii].c_str(), arg_[ii]);
-      vararray_[ii] = var_arg_[ii];
-    }
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      op_[ii] = new ROperation(expressions_[ii].c_str(), maxDimDomain, vararray_);
-    }
+    // all expressions (and their derivatives) are compiled into one program, which may be shared by all threads and
+    // all functions with the same expressions
+    compiled_ = MathExpressionCache::get(original_variables_, expressions_);
   } // void setup(const std::string& _variable, const std::vector< std::string >& expressions)
 
-  void cleanup()
-  {
-    for (size_t ii = 0; ii < dimRange; ++ii) {
-      delete op_[ii];
-    }
-    for (size_t ii = 0; ii < maxDimDomain; ++ii) {
-      delete var_arg_[ii];
-      delete arg_[ii];
-    }
-  } // void cleanup()
-
   std::vector<std::string> original_variables_;
-  std::vector<std::string> variables_;
   std::vector<std::string> expressions_;
-  size_t actualDimRange_;
-  mutable DomainFieldType* arg_[maxDimDomain];
-  RVar* var_arg_[maxDimDomain];
-  RVar* vararray_[maxDimDomain];
-  ROperation* op_[dimRange];
-  mutable std::mutex mutex_;
+  std::shared_ptr<const internal::CompiledMathExpressions> compiled_;
 }; // class DynamicMathExpressionBase
 
 
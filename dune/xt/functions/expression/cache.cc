@@ -0,0 +1,442 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <config.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/xt/common/exceptions.hh>
+
+#include "base.hh"
+#include "cache.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+namespace internal {
+
+
+// The entries are only held by the functions using them and, if they are among the cache_capacity ones used most
+// recently, by recent_entries (most recent first). Expired entries are removed by insert().
+typedef std::list<std::pair<std::string, std::shared_ptr<const CompiledMathExpressions>>> RecentEntries;
+
+struct CacheEntry
+{
+  std::weak_ptr<const CompiledMathExpressions> compiled;
+  RecentEntries::iterator recent; // recent_entries.end() if not among them
+};
+
+static std::mutex cache_mutex;
+static std::unordered_map<std::string, CacheEntry> cache_entries;
+static RecentEntries recent_entries;
+static size_t cache_capacity = 1000;
+static size_t next_prune = 64;
+static size_t cache_hits = 0;
+static size_t cache_misses = 0;
+static std::set<std::string> loaded_files;
+
+// first bytes of every blob written by MathExpressionCache::save(), followed by a version, which changes with the
+// instructions of RProgram, and the value 1 as int to detect a different byte order
+static const char blob_magic[8] = {'D', 'X', 'T', 'F', 'E', 'X', 'P', 'R'};
+static const int blob_version = 3;
+
+
+// all strings, each prefixed by its length, so different lists give different keys
+static std::string cache_key(const std::vector<std::string>& variables, const std::vector<std::string>& expressions)
+{
+  std::string key = std::to_string(variables.size()) + ":";
+  for (const auto& variable : variables)
+    key += std::to_string(variable.size()) + ":" + variable;
+  for (const auto& expression : expressions)
+    key += std::to_string(expression.size()) + ":" + expression;
+  return key;
+}
+
+
+static std::shared_ptr<const CompiledMathExpressions> compile(const std::vector<std::string>& variables,
+                                                              const std::vector<std::string>& expressions)
+{
+  auto compiled = std::make_shared<CompiledMathExpressions>(variables, expressions);
+  const RProgram program = MathExpressionParser(variables, expressions).program();
+  compiled->num_unoptimized_instructions = program.NInstructions();
+  compiled->program = program.Optimize();
+  if (JitMathExpression::enabled())
+    compiled->jit = JitMathExpression::create(compiled->program);
+  return compiled;
+} // ... compile(...)
+
+
+// the counterpart of cache_key()
+static bool
+split_key(const std::string& key, std::vector<std::string>& variables, std::vector<std::string>& expressions)
+{
+  size_t pos = 0;
+  const auto next_size = [&](size_t& size) {
+    const size_t colon = key.find(':', pos);
+    if (colon == std::string::npos || colon == pos || colon - pos > 9
+        || key.find_first_not_of("0123456789", pos) != colon)
+      return false;
+    size = std::stoul(key.substr(pos, colon - pos));
+    pos = colon + 1;
+    return true;
+  };
+  const auto next_string = [&](std::string& value) {
+    size_t size;
+    if (!next_size(size) || key.size() - pos < size)
+      return false;
+    value = key.substr(pos, size);
+    pos += size;
+    return true;
+  };
+  size_t num_variables;
+  if (!next_size(num_variables) || num_variables > key.size())
+    return false;
+  variables.resize(num_variables);
+  for (auto& variable : variables)
+    if (!next_string(variable))
+      return false;
+  expressions.clear();
+  while (pos < key.size()) {
+    expressions.emplace_back();
+    if (!next_string(expressions.back()))
+      return false;
+  }
+  return true;
+} // ... split_key(...)
+
+
+static void save_int(std::string& blob, const int value)
+{
+  blob.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+static bool load_int(const char*& data, const char* end, int& value)
+{
+  if (end - data < static_cast<std::ptrdiff_t>(sizeof(value)))
+    return false;
+  std::memcpy(&value, data, sizeof(value));
+  data += sizeof(value);
+  return true;
+}
+
+
+// the length of the key, the key, the number of unoptimized instructions, the program and, if they were compiled, the
+// derivatives
+static bool save_entry(const std::string& key, const CompiledMathExpressions& compiled, std::string& blob)
+{
+  std::string entry;
+  save_int(entry, static_cast<int>(key.size()));
+  entry += key;
+  save_int(entry, compiled.num_unoptimized_instructions);
+  if (!compiled.program.Save(entry))
+    return false;
+  const CompiledMathDerivatives* derivatives = compiled.derivatives_if_compiled();
+  save_int(entry, derivatives != nullptr);
+  if (derivatives != nullptr) {
+    save_int(entry, derivatives->num_unoptimized_instructions);
+    if (!derivatives->program.Save(entry))
+      return false;
+  }
+  blob += entry;
+  return true;
+} // ... save_entry(...)
+
+
+static std::shared_ptr<CompiledMathExpressions> load_entry(const char*& data, const char* end, std::string& key)
+{
+  int key_size;
+  if (!load_int(data, end, key_size) || key_size < 0 || end - data < key_size)
+    return nullptr;
+  key.assign(data, key_size);
+  data += key_size;
+  std::vector<std::string> variables, expressions;
+  if (!split_key(key, variables, expressions))
+    return nullptr;
+  // the programs are evaluated into buffers sized by the key, so they have to be the ones of its expressions
+  const auto nvars = static_cast<int>(variables.size());
+  const auto nexpr = static_cast<int>(expressions.size());
+  auto compiled = std::make_shared<CompiledMathExpressions>(variables, expressions);
+  int has_derivatives;
+  if (!load_int(data, end, compiled->num_unoptimized_instructions) || !compiled->program.Load(data, end)
+      || compiled->program.NVars() != nvars || compiled->program.NOutputs() != nexpr
+      || !load_int(data, end, has_derivatives))
+    return nullptr;
+  if (has_derivatives) {
+    std::unique_ptr<CompiledMathDerivatives> derivatives(new CompiledMathDerivatives());
+    if (!load_int(data, end, derivatives->num_unoptimized_instructions) || !derivatives->program.Load(data, end)
+        || derivatives->program.NVars() != nvars || derivatives->program.NOutputs() != nexpr * nvars)
+      return nullptr;
+    compiled->set_derivatives(std::move(derivatives));
+  }
+  if (JitMathExpression::enabled())
+    compiled->jit = JitMathExpression::create(compiled->program);
+  return compiled;
+} // ... load_entry(...)
+
+
+// The following functions expect cache_mutex to be locked.
+
+static void release_least_recent()
+{
+  while (recent_entries.size() > cache_capacity) {
+    const std::string key = std::move(recent_entries.back().first);
+    recent_entries.pop_back();
+    const auto entry = cache_entries.find(key);
+    entry->second.recent = recent_entries.end();
+    if (entry->second.compiled.expired())
+      cache_entries.erase(entry);
+  }
+} // ... release_least_recent(...)
+
+
+static void touch(const std::string& key, CacheEntry& entry, std::shared_ptr<const CompiledMathExpressions> compiled)
+{
+  if (entry.recent != recent_entries.end())
+    recent_entries.splice(recent_entries.begin(), recent_entries, entry.recent);
+  else {
+    recent_entries.emplace_front(key, std::move(compiled));
+    entry.recent = recent_entries.begin();
+  }
+  release_least_recent();
+}
+
+
+// returns the live entry of the given key, which is compiled unless there is one already
+static std::shared_ptr<const CompiledMathExpressions>
+insert(const std::string& key, const std::shared_ptr<const CompiledMathExpressions>& compiled)
+{
+  const auto inserted = cache_entries.emplace(key, CacheEntry{compiled, recent_entries.end()});
+  CacheEntry& entry = inserted.first->second;
+  auto result = entry.compiled.lock();
+  if (!result)
+    entry.compiled = result = compiled;
+  touch(key, entry, result);
+  // remove the expired entries whenever their number doubled, which keeps this amortized O(1)
+  if (cache_entries.size() >= next_prune) {
+    for (auto it = cache_entries.begin(); it != cache_entries.end();)
+      it = it->second.compiled.expired() ? cache_entries.erase(it) : std::next(it);
+    next_prune = std::max(size_t(64), 2 * cache_entries.size());
+  }
+  return result;
+} // ... insert(...)
+
+
+CompiledMathExpressions::CompiledMathExpressions(const std::vector<std::string>& variables,
+                                                 const std::vector<std::string>& expressions)
+  : num_unoptimized_instructions(0)
+  , variables_(variables)
+  , expressions_(expressions)
+  , jit_enabled_(JitMathExpression::enabled())
+  , compiled_derivatives_(nullptr)
+{
+}
+
+
+const CompiledMathDerivatives& CompiledMathExpressions::derivatives() const
+{
+  std::call_once(derivatives_flag_, [this]() {
+    if (!derivatives_) {
+      std::unique_ptr<CompiledMathDerivatives> compiled(new CompiledMathDerivatives());
+      const RProgram program = MathExpressionParser(variables_, expressions_).derivative_program();
+      compiled->num_unoptimized_instructions = program.NInstructions();
+      compiled->program = program.Optimize();
+      derivatives_ = std::move(compiled);
+    }
+    if (jit_enabled_ && !derivatives_->jit)
+      derivatives_->jit = JitMathExpression::create(derivatives_->program);
+    compiled_derivatives_.store(derivatives_.get());
+  });
+  return *derivatives_;
+} // ... derivatives(...)
+
+
+void CompiledMathExpressions::set_derivatives(std::unique_ptr<CompiledMathDerivatives>&& compiled_derivatives)
+{
+  derivatives_ = std::move(compiled_derivatives);
+  compiled_derivatives_.store(derivatives_.get());
+}
+
+
+} // namespace internal
+
+
+std::shared_ptr<const internal::CompiledMathExpressions>
+MathExpressionCache::get(const std::vector<std::string>& variables, const std::vector<std::string>& expressions)
+{
+  const std::string key = internal::cache_key(variables, expressions);
+  {
+    std::lock_guard<std::mutex> guard(internal::cache_mutex);
+    const auto entry = internal::cache_entries.find(key);
+    if (entry != internal::cache_entries.end()) {
+      if (auto compiled = entry->second.compiled.lock()) {
+        ++internal::cache_hits;
+        internal::touch(key, entry->second, compiled);
+        return compiled;
+      }
+    }
+    ++internal::cache_misses;
+  }
+  // compile without holding the lock, if another thread was faster its result is used
+  const auto compiled = internal::compile(variables, expressions);
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  return internal::insert(key, compiled);
+} // ... get(...)
+
+
+MathExpressionCache::Statistics MathExpressionCache::statistics()
+{
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  Statistics stats;
+  stats.hits = internal::cache_hits;
+  stats.misses = internal::cache_misses;
+  stats.size = 0;
+  for (const auto& entry : internal::cache_entries)
+    stats.size += !entry.second.compiled.expired();
+  return stats;
+}
+
+
+size_t MathExpressionCache::capacity()
+{
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  return internal::cache_capacity;
+}
+
+
+void MathExpressionCache::set_capacity(const size_t capacity)
+{
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  internal::cache_capacity = capacity;
+  internal::release_least_recent();
+}
+
+
+std::string MathExpressionCache::save()
+{
+  std::string blob(internal::blob_magic, sizeof(internal::blob_magic));
+  internal::save_int(blob, internal::blob_version);
+  internal::save_int(blob, 1);
+  std::string entries;
+  int num_entries = 0;
+  {
+    std::lock_guard<std::mutex> guard(internal::cache_mutex);
+    for (const auto& entry : internal::cache_entries) {
+      const auto compiled = entry.second.compiled.lock();
+      if (compiled && internal::save_entry(entry.first, *compiled, entries))
+        ++num_entries;
+    }
+  }
+  internal::save_int(blob, num_entries);
+  return blob + entries;
+} // ... save(...)
+
+
+void MathExpressionCache::save(const std::string& filename)
+{
+  const std::string blob = save();
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.write(blob.data(), blob.size()))
+    DUNE_THROW(Dune::IOError, "Could not write the compiled expressions to '" << filename << "'!");
+}
+
+
+size_t MathExpressionCache::load(const char* data, const size_t size)
+{
+  const char* const end = data + size;
+  int version, one, num_entries;
+  if (size < sizeof(internal::blob_magic)
+      || std::memcmp(data, internal::blob_magic, sizeof(internal::blob_magic)) != 0)
+    DUNE_THROW(Dune::IOError, "This is no blob of compiled expressions!");
+  data += sizeof(internal::blob_magic);
+  if (!internal::load_int(data, end, version) || !internal::load_int(data, end, one)
+      || !internal::load_int(data, end, num_entries))
+    DUNE_THROW(Dune::IOError, "The blob of compiled expressions is truncated!");
+  if (version != internal::blob_version || one != 1)
+    DUNE_THROW(Dune::IOError,
+               "The blob of compiled expressions was written by another version or on a machine with another byte "
+               "order!");
+  // read everything before adding anything, so a broken blob does not leave half of its entries in the cache
+  std::vector<std::pair<std::string, std::shared_ptr<internal::CompiledMathExpressions>>> entries;
+  for (int ii = 0; ii < num_entries; ++ii) {
+    std::string key;
+    auto compiled = internal::load_entry(data, end, key);
+    if (!compiled)
+      DUNE_THROW(Dune::IOError, "Entry " << ii << " of the blob of compiled expressions is broken!");
+    entries.emplace_back(key, compiled);
+  }
+  size_t num_added = 0;
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  for (const auto& entry : entries)
+    num_added += internal::insert(entry.first, entry.second) == entry.second;
+  return num_added;
+} // ... load(...)
+
+
+size_t MathExpressionCache::load(const std::string& filename)
+{
+  {
+    std::lock_guard<std::mutex> guard(internal::cache_mutex);
+    if (internal::loaded_files.count(filename))
+      return 0;
+  }
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    DUNE_THROW(Dune::IOError, "Could not open '" << filename << "'!");
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(fd);
+    DUNE_THROW(Dune::IOError, "Could not read '" << filename << "'!");
+  }
+  const size_t size = static_cast<size_t>(file_stat.st_size);
+  void* const mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+    DUNE_THROW(Dune::IOError, "Could not map '" << filename << "' into memory!");
+  size_t num_added = 0;
+  try {
+    num_added = load(static_cast<const char*>(mapped), size);
+  } catch (...) {
+    munmap(mapped, size);
+    throw;
+  }
+  munmap(mapped, size);
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  internal::loaded_files.insert(filename);
+  return num_added;
+} // ... load(...)
+
+
+void MathExpressionCache::clear()
+{
+  std::lock_guard<std::mutex> guard(internal::cache_mutex);
+  internal::cache_entries.clear();
+  internal::recent_entries.clear();
+  internal::next_prune = 64;
+  internal::loaded_files.clear();
+  internal::cache_hits = 0;
+  internal::cache_misses = 0;
+}
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
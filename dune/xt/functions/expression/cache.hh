@@ -0,0 +1,160 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_EXPRESSION_CACHE_HH
+#define DUNE_XT_FUNCTIONS_EXPRESSION_CACHE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "jit.hh"
+#include "mathexpr.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+namespace internal {
+
+
+//! The derivatives of some expressions w.r.t. all variables, compiled for the expression bases.
+struct CompiledMathDerivatives
+{
+  //! Computes the derivative of the ii-th expression w.r.t. the jj-th variable as its (ii * num_variables + jj)-th
+  //! output, optimized.
+  RProgram program;
+  int num_unoptimized_instructions;
+  //! Native code for program, nullptr unless enabled (see JitMathExpression).
+  std::shared_ptr<const JitMathExpression> jit;
+}; // struct CompiledMathDerivatives
+
+
+/**
+ * \brief Some expressions, compiled for the expression bases (see MathExpressionCache).
+ *
+ * Their symbolic derivatives are only compiled by the first call of derivatives(): differentiating every expression
+ * w.r.t. every variable is expensive, and many functions never need them (e.g., if gradients are given).
+ */
+class CompiledMathExpressions
+{
+public:
+  CompiledMathExpressions(const std::vector<std::string>& variables, const std::vector<std::string>& expressions);
+
+  CompiledMathExpressions(const CompiledMathExpressions& other) = delete;
+
+  CompiledMathExpressions& operator=(const CompiledMathExpressions& other) = delete;
+
+  //! Computes the expressions, optimized (see RProgram::Optimize()).
+  RProgram program;
+  int num_unoptimized_instructions;
+  //! Native code for program, nullptr unless enabled (see JitMathExpression).
+  std::shared_ptr<const JitMathExpression> jit;
+
+  //! Compiles the derivatives on the first call, thread safe.
+  const CompiledMathDerivatives& derivatives() const;
+
+  //! Native code for derivatives(), nullptr unless enabled, compiles the derivatives on the first call.
+  const JitMathExpression* derivative_jit() const
+  {
+    return jit_enabled_ ? derivatives().jit.get() : nullptr;
+  }
+
+  //! The derivatives, if they were compiled or given already, nullptr otherwise.
+  const CompiledMathDerivatives* derivatives_if_compiled() const
+  {
+    return compiled_derivatives_.load();
+  }
+
+  //! Uses the given derivatives instead of compiling them, only allowed before this is shared.
+  void set_derivatives(std::unique_ptr<CompiledMathDerivatives>&& compiled_derivatives);
+
+private:
+  const std::vector<std::string> variables_;
+  const std::vector<std::string> expressions_;
+  const bool jit_enabled_;
+  mutable std::once_flag derivatives_flag_;
+  mutable std::unique_ptr<CompiledMathDerivatives> derivatives_;
+  mutable std::atomic<const CompiledMathDerivatives*> compiled_derivatives_;
+}; // class CompiledMathExpressions
+
+
+} // namespace internal
+
+
+/**
+ * \brief Process wide cache of compiled expressions.
+ *
+ * Parsing and compiling expressions is expensive compared to evaluating them, and many functions with the same
+ * variables and expressions are usually created (e.g. one per subdomain or parameter). All expression bases thus
+ * obtain their compiled expressions from here, so identical expressions are only compiled once and share one
+ * (immutable) program. The cache is thread safe.
+ *
+ * An entry lives as long as a function uses it or it is one of the capacity() entries used most recently, whichever
+ * is longer. The latter keeps the expressions of functions which are created and destroyed over and over again (e.g.,
+ * once per time step) without letting the cache grow without bound.
+ *
+ * To save the parsing on restarts, save() the cache once all functions are created and load() it before creating
+ * them the next time. ExpressionFunction::create() does the latter if its config holds the key "precompiled".
+ */
+class MathExpressionCache
+{
+public:
+  struct Statistics
+  {
+    size_t hits;
+    size_t misses;
+    size_t size;
+  };
+
+  static std::shared_ptr<const internal::CompiledMathExpressions> get(const std::vector<std::string>& variables,
+                                                                      const std::vector<std::string>& expressions);
+
+  //! hits and misses of get() since the last clear(), size is the number of live entries
+  static Statistics statistics();
+
+  //! Number of entries kept alive while no function uses them, 1000 by default.
+  static size_t capacity();
+
+  //! Sets capacity(), the entries used least recently are released if there are more.
+  static void set_capacity(const size_t capacity);
+
+  /**
+   * \brief Writes all entries into a binary blob, which load() reads back without parsing any expression.
+   *
+   * The blob holds the variables and expressions of every entry along with their compiled programs and, if they were
+   * compiled already, those of their derivatives. It may only be read on machines with the same byte order. Entries
+   * with user defined functions are left out.
+   */
+  static std::string save();
+
+  //! Writes save() into the given file.
+  static void save(const std::string& filename);
+
+  /**
+   * \brief Adds the entries of a blob written by save(), existing entries are kept.
+   *
+   * The added entries count as used most recently, so at most capacity() of them stay alive until they are used.
+   * \return the number of entries added
+   */
+  static size_t load(const char* data, const size_t size);
+
+  //! Maps the given file into memory and loads it, a file already loaded since the last clear() is not read again.
+  static size_t load(const std::string& filename);
+
+  //! Removes all entries (the ones in use stay valid) and resets the statistics.
+  static void clear();
+}; // class MathExpressionCache
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_EXPRESSION_CACHE_HH
@@ -13,9 +13,11 @@
 #ifndef DUNE_XT_FUNCTIONS_EXPRESSION_DEFAULT_HH
 #define DUNE_XT_FUNCTIONS_EXPRESSION_DEFAULT_HH
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
+#include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 
 #include <dune/xt/common/configuration.hh>
@@ -55,9 +57,14 @@ public:
   using BaseType::dimRangeCols;
   using typename BaseType::RangeType;
   using typename BaseType::JacobianRangeType;
+  using typename BaseType::HessianRangeType;
+  using typename BaseType::StridedValuesViewType;
   typedef typename std::vector<std::vector<std::string>> ExpressionStringVectorType;
   typedef typename std::vector<std::vector<std::vector<std::string>>> GradientStringVectorType;
 
+  //! Passed as order, lets the function determine its order from the expressions, see the constructors.
+  static const size_t automatic_order = std::numeric_limits<size_t>::max();
+
   static std::string static_id()
   {
     return BaseType::static_id() + ".expression";
@@ -68,7 +75,8 @@ public:
     Common::Configuration config;
     config["variable"] = "x";
     config["expression"] = "[x[0] sin(x[0]) exp(x[0]); x[0] sin(x[0]) exp(x[0]); x[0] sin(x[0]) exp(x[0])]";
-    config["order"] = "3";
+    config["order"] = "auto";
+    config["transcendental_order"] = "3";
     config["name"] = static_id();
     if (sub_name.empty())
       return config;
@@ -79,12 +87,20 @@ public:
     }
   } // ... default_config(...)
 
+  /**
+   * \brief Creates the function from the keys of default_config() (gradient, gradient.0, ... are optional).
+   *
+   * If config holds the key "precompiled", the file it names is loaded into the MathExpressionCache first (once per
+   * process), so the expressions, gradients and derivatives compiled by the run which saved it are not parsed again.
+   */
   static std::unique_ptr<ThisType> create(const Common::Configuration config = default_config(),
                                           const std::string sub_name = static_id())
   {
     // get correct config
     const Common::Configuration cfg = config.has_sub(sub_name) ? config.sub(sub_name) : config;
     const Common::Configuration default_cfg = default_config();
+    if (cfg.has_key("precompiled"))
+      MathExpressionCache::load(cfg.get<std::string>("precompiled"));
     // get expression
     ExpressionStringVectorType expression_as_vectors;
     // try to get expression as FieldVector (if dimRangeCols == 1) or as FieldMatrix (else)
@@ -106,12 +122,17 @@ public:
     } else if (cfg.has_key("gradient.0")) {
       get_gradient(cfg, gradient_as_vectors, "gradient.0");
     }
+    // get order
+    const auto order_str = cfg.get("order", default_cfg.get<std::string>("order"));
+    const size_t ord = (order_str == "auto") ? automatic_order : Common::from_string<size_t>(order_str);
     // create
-    return Common::make_unique<ThisType>(cfg.get("variable", default_cfg.get<std::string>("variable")),
-                                         expression_as_vectors,
-                                         cfg.get("order", default_cfg.get<size_t>("order")),
-                                         cfg.get("name", default_cfg.get<std::string>("name")),
-                                         gradient_as_vectors);
+    return Common::make_unique<ThisType>(
+        cfg.get("variable", default_cfg.get<std::string>("variable")),
+        expression_as_vectors,
+        ord,
+        cfg.get("name", default_cfg.get<std::string>("name")),
+        gradient_as_vectors,
+        cfg.get("transcendental_order", default_cfg.get<size_t>("transcendental_order")));
   } // ... create(...)
 
   /**
@@ -123,9 +144,10 @@ public:
    */
   ExpressionFunction(const std::string variable,
                      const std::string expression,
-                     const size_t ord = 0,
+                     const size_t ord = automatic_order,
                      const std::string nm = static_id(),
-                     const std::vector<std::string> gradient = std::vector<std::string>())
+                     const std::vector<std::string> gradient = std::vector<std::string>(),
+                     const size_t transcendental_ord = 3)
     : order_(ord)
     , name_(nm)
   {
@@ -143,6 +165,7 @@ public:
     // build function and gradient
     build_function(variable, expressions);
     build_gradients(variable, gradient_expressions);
+    detect_order(transcendental_ord);
   }
 
   /**
@@ -156,9 +179,10 @@ public:
   ExpressionFunction(
       const std_str variable,
       const std::vector<std::string> expressions,
-      const size_t ord = default_config().template get<size_t>("order"),
+      const size_t ord = automatic_order,
       const std::string nm = static_id(),
-      const std::vector<std::vector<std::string>> gradient_expressions = std::vector<std::vector<std::string>>())
+      const std::vector<std::vector<std::string>> gradient_expressions = std::vector<std::vector<std::string>>(),
+      const size_t transcendental_ord = 3)
     : function_(new MathExpressionFunctionType(variable, expressions))
     , order_(ord)
     , name_(nm)
@@ -169,6 +193,7 @@ public:
       gradient_expressions_vec.emplace_back(gradient_expressions);
     }
     build_gradients(variable, gradient_expressions_vec);
+    detect_order(transcendental_ord);
   }
 
   /**
@@ -177,23 +202,30 @@ public:
    * \param variable variable of the Expression function, e.g. "x"
    * \param expressions vector< vector< string > >, where the inner vectors are the rows of the Expression functions
    *  range, e.g. [[1 sin(x[0])] [2*x[0] x[1]]] gives the range [1 sin(x[0]); 2 x[1]]
-   * \param ord order of the Expression function
+   * \param ord order of the Expression function, automatic_order determines it from the expressions: the exact
+   *  polynomial degree if all expressions are polynomials in x, otherwise an estimate where every other function of
+   *  an argument of degree d counts as a polynomial of degree transcendental_ord * d (e.g. 3 for sin(x[0]), 5 for
+   *  x[0]^2*exp(x[1]) and 2 + 3 * 1 for x[0]^2/x[1])
    * \param nm name of the Expression function
    * \param gradient_expressions vector< vector< vector< string > > >, vector of the jacobian matrices (written as
    *  vector< vector< string > >, where the inner vectors are the rows) of the columns of the Expression function, e.g.
    *  [[[0 0] [2 0]] [[cos(x[0]) 0] [0 1]]] would be the gradient_expression corresponding to the expression above (if
-   *  dimDomain = dimRange = dimRangeCols = 2)
+   *  dimDomain = dimRange = dimRangeCols = 2). If no gradient_expressions are given, the jacobian is computed from
+   *  symbolic derivatives of the expressions.
+   * \param transcendental_ord see ord
    */
   ExpressionFunction(const std::string variable,
                      const ExpressionStringVectorType expressions,
-                     const size_t ord = 0,
+                     const size_t ord = automatic_order,
                      const std::string nm = static_id(),
-                     const GradientStringVectorType gradient_expressions = GradientStringVectorType())
+                     const GradientStringVectorType gradient_expressions = GradientStringVectorType(),
+                     const size_t transcendental_ord = 3)
     : order_(ord)
     , name_(nm)
   {
     build_function(variable, expressions);
     build_gradients(variable, gradient_expressions);
+    detect_order(transcendental_ord);
   }
 
   ExpressionFunction(const ThisType& other)
@@ -232,13 +264,34 @@ private:
   template <bool is_not_tensor = (rangeDimCols == 1), bool anything = true>
   struct eval_helper
   {
+    static void set_value(const std::vector<double>& values, const size_t num_points, const size_t pp, RangeType& ret)
+    {
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        ret[rr] = values[rr * num_points + pp];
+    }
+
+    static void set_jacobian(const std::vector<double>& derivatives,
+                             const size_t num_points,
+                             const size_t pp,
+                             JacobianRangeType& ret)
+    {
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t jj = 0; jj < dimDomain; ++jj)
+          ret[rr][jj] = derivatives[(rr * dimDomain + jj) * num_points + pp];
+    }
+
     static void
-    evaluate(const std::shared_ptr<const MathExpressionFunctionType>& func,
-             typename Common::PerThreadValue<FieldVector<RangeFieldType, dimRange * dimRangeCols>>& /*tmp_vector*/,
-             const DomainType& xx,
-             RangeType& ret)
+    symbolic_jacobian(const MathExpressionFunctionType& func, const DomainType& xx, JacobianRangeType& ret)
     {
-      func->evaluate(xx, ret);
+      func.jacobian(xx, ret);
+    }
+
+    static void evaluate_with_jacobian(const MathExpressionFunctionType& func,
+                                       const DomainType& xx,
+                                       RangeType& value,
+                                       JacobianRangeType& derivative)
+    {
+      func.evaluate_with_jacobian(xx, value, derivative);
     }
 
     static void jacobian(const std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>>& gradients,
@@ -250,24 +303,68 @@ private:
         gradients[0][rr]->evaluate(xx, ret[rr]);
       }
     }
+
+    static void symbolic_hessian(const MathExpressionFunctionType& func, const DomainType& xx, HessianRangeType& ret)
+    {
+      func.hessian(xx, ret);
+    }
+
+    static void hessian(const std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>>& gradients,
+                        const DomainType& xx,
+                        HessianRangeType& ret)
+    {
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        gradients[0][rr]->jacobian(xx, ret[rr]);
+    }
   }; // struct evap_helper<true, ...>
 
   template <bool anything>
   struct eval_helper<false, anything>
   {
-    static void
-    evaluate(const std::shared_ptr<const MathExpressionFunctionType>& func,
-             typename Common::PerThreadValue<FieldVector<RangeFieldType, dimRange * dimRangeCols>>& tmp_vector,
-             const DomainType& xx,
-             RangeType& ret)
+    static void set_value(const std::vector<double>& values, const size_t num_points, const size_t pp, RangeType& ret)
     {
-      func->evaluate(xx, *tmp_vector);
       for (size_t rr = 0; rr < dimRange; ++rr) {
         auto& retRow = ret[rr];
         for (size_t cc = 0; cc < dimRangeCols; ++cc)
-          retRow[cc] = (*tmp_vector)[rr * dimRangeCols + cc];
+          retRow[cc] = values[(rr * dimRangeCols + cc) * num_points + pp];
       }
-    } // ... evaluate(...)
+    }
+
+    static void set_jacobian(const std::vector<double>& derivatives,
+                             const size_t num_points,
+                             const size_t pp,
+                             JacobianRangeType& ret)
+    {
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t cc = 0; cc < dimRangeCols; ++cc)
+          for (size_t jj = 0; jj < dimDomain; ++jj)
+            ret[cc][rr][jj] = derivatives[((rr * dimRangeCols + cc) * dimDomain + jj) * num_points + pp];
+    }
+
+    static void
+    symbolic_jacobian(const MathExpressionFunctionType& func, const DomainType& xx, JacobianRangeType& ret)
+    {
+      FieldMatrix<RangeFieldType, dimRange * dimRangeCols, dimDomain> tmp;
+      func.jacobian(xx, tmp);
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t cc = 0; cc < dimRangeCols; ++cc)
+          ret[cc][rr] = tmp[rr * dimRangeCols + cc];
+    } // ... symbolic_jacobian(...)
+
+    static void evaluate_with_jacobian(const MathExpressionFunctionType& func,
+                                       const DomainType& xx,
+                                       RangeType& value,
+                                       JacobianRangeType& derivative)
+    {
+      FieldVector<RangeFieldType, dimRange * dimRangeCols> tmp_value;
+      FieldMatrix<RangeFieldType, dimRange * dimRangeCols, dimDomain> tmp_derivative;
+      func.evaluate_with_jacobian(xx, tmp_value, tmp_derivative);
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t cc = 0; cc < dimRangeCols; ++cc) {
+          value[rr][cc] = tmp_value[rr * dimRangeCols + cc];
+          derivative[cc][rr] = tmp_derivative[rr * dimRangeCols + cc];
+        }
+    } // ... evaluate_with_jacobian(...)
 
     static void jacobian(const std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>>& gradients,
                          const DomainType& xx,
@@ -280,6 +377,24 @@ private:
         }
       }
     } // ... jacobian(...)
+
+    static void symbolic_hessian(const MathExpressionFunctionType& func, const DomainType& xx, HessianRangeType& ret)
+    {
+      FieldVector<FieldMatrix<RangeFieldType, dimDomain, dimDomain>, dimRange * dimRangeCols> tmp;
+      func.hessian(xx, tmp);
+      for (size_t rr = 0; rr < dimRange; ++rr)
+        for (size_t cc = 0; cc < dimRangeCols; ++cc)
+          ret[cc][rr] = tmp[rr * dimRangeCols + cc];
+    } // ... symbolic_hessian(...)
+
+    static void hessian(const std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>>& gradients,
+                        const DomainType& xx,
+                        HessianRangeType& ret)
+    {
+      for (size_t cc = 0; cc < dimRangeCols; ++cc)
+        for (size_t rr = 0; rr < dimRange; ++rr)
+          gradients[cc][rr]->jacobian(xx, ret[cc][rr]);
+    } // ... hessian(...)
   }; // struct eval_helper<false, ...>
 
 public:
@@ -287,9 +402,204 @@ public:
 
   void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
   {
-    eval_helper<>::evaluate(function_, tmp_vector_, xx, ret);
+    // all entries are computed by one program, which writes them directly into ret
+    function_->evaluate(xx, ret);
+    check_value(xx, ret);
+  }
+
+  /**
+   * \brief Evaluates at all points at once, which runs the compiled expressions once per block of points instead of
+   *        once per point (see MathExpressionBase).
+   * \attention ret will be resized!
+   */
+  void evaluate(const std::vector<DomainType>& xx,
+                std::vector<RangeType>& ret,
+                const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    const size_t num_points = xx.size();
+    ret.resize(num_points);
+    if (num_points == 0)
+      return;
+    std::vector<double> args;
+    const double* arg_ptrs[dimDomain];
+    transpose(xx, args, arg_ptrs);
+    std::vector<double> values(dimRange * dimRangeCols * num_points);
+    function_->evaluate(arg_ptrs, values.data(), num_points);
+    for (size_t pp = 0; pp < num_points; ++pp) {
+      eval_helper<>::set_value(values, num_points, pp, ret[pp]);
+      check_value(xx[pp], ret[pp]);
+    }
+  } // ... evaluate(...)
+
+  /**
+   * \brief Evaluates at all points at once into ret(cc, 0, pp), which only copies the rows computed by the compiled
+   *        expressions, since these already are component-major.
+   */
+  void evaluate(const std::vector<DomainType>& xx,
+                const StridedValuesViewType& ret,
+                const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    const size_t num_points = xx.size();
+    assert(ret.num_components() == dimRange * dimRangeCols && ret.num_points() >= num_points);
+    if (num_points == 0)
+      return;
+    std::vector<double> args;
+    const double* arg_ptrs[dimDomain];
+    transpose(xx, args, arg_ptrs);
+    std::vector<double> values(dimRange * dimRangeCols * num_points);
+    function_->evaluate(arg_ptrs, values.data(), num_points);
+    for (size_t cc = 0; cc < dimRange * dimRangeCols; ++cc)
+      std::copy_n(values.begin() + cc * num_points, num_points, ret.row(cc, 0));
+#ifndef NDEBUG
+    RangeType value;
+    for (size_t pp = 0; pp < num_points; ++pp) {
+      ret.get(0, pp, value);
+      check_value(xx[pp], value);
+    }
+#endif
+  } // ... evaluate(...)
+
+  /**
+   * \brief Computes guaranteed bounds of all entries on the given box by evaluating the expressions in interval
+   *        arithmetic (see MathExpressionBase::bounds).
+   */
+  bool bounds(const DomainType& lower_corner,
+              const DomainType& upper_corner,
+              RangeType& lower,
+              RangeType& upper,
+              const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    double lower_args[dimDomain];
+    double upper_args[dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii) {
+      lower_args[ii] = lower_corner[ii];
+      upper_args[ii] = upper_corner[ii];
+    }
+    std::vector<double> lower_values(dimRange * dimRangeCols);
+    std::vector<double> upper_values(dimRange * dimRangeCols);
+    function_->bounds(lower_args, upper_args, lower_values.data(), upper_values.data());
+    eval_helper<>::set_value(lower_values, 1, 0, lower);
+    eval_helper<>::set_value(upper_values, 1, 0, upper);
+    return true;
+  }
+
+  using BaseType::jacobian;
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    if (gradients_.size() == 0) {
+      // no gradients were given, differentiate the expressions (see MathExpressionBase::jacobian)
+      eval_helper<>::symbolic_jacobian(*function_, xx, ret);
+    } else {
+      assert(gradients_.size() == dimRangeCols);
+      eval_helper<>::jacobian(gradients_, xx, ret);
+    }
+  } // ... jacobian(...)
+
+  /**
+   * \brief Evaluates the jacobians at all points at once by the compiled symbolic derivatives (see
+   *        MathExpressionBase), unless gradients were given.
+   * \attention ret will be resized!
+   */
+  void jacobian(const std::vector<DomainType>& xx,
+                std::vector<JacobianRangeType>& ret,
+                const Common::Parameter& mu = {}) const override final
+  {
+    if (gradients_.size() > 0) {
+      BaseType::jacobian(xx, ret, mu);
+      return;
+    }
+    const size_t num_points = xx.size();
+    ret.resize(num_points);
+    if (num_points == 0)
+      return;
+    std::vector<double> args;
+    const double* arg_ptrs[dimDomain];
+    transpose(xx, args, arg_ptrs);
+    std::vector<double> derivatives(dimRange * dimRangeCols * dimDomain * num_points);
+    function_->jacobian(arg_ptrs, derivatives.data(), num_points);
+    for (size_t pp = 0; pp < num_points; ++pp)
+      eval_helper<>::set_jacobian(derivatives, num_points, pp, ret[pp]);
+  } // ... jacobian(...)
+
+  //! \sa evaluate(const std::vector<DomainType>&, const StridedValuesViewType&, ...)
+  void jacobian(const std::vector<DomainType>& xx,
+                const StridedValuesViewType& ret,
+                const Common::Parameter& mu = {}) const override final
+  {
+    if (gradients_.size() > 0) {
+      BaseType::jacobian(xx, ret, mu);
+      return;
+    }
+    const size_t num_points = xx.size();
+    assert(ret.num_components() == dimRange * dimRangeCols * dimDomain && ret.num_points() >= num_points);
+    if (num_points == 0)
+      return;
+    std::vector<double> args;
+    const double* arg_ptrs[dimDomain];
+    transpose(xx, args, arg_ptrs);
+    std::vector<double> derivatives(dimRange * dimRangeCols * dimDomain * num_points);
+    function_->jacobian(arg_ptrs, derivatives.data(), num_points);
+    // the rows of derivatives are ordered by range row, range column and direction, the components of a
+    // JacobianRangeType by range column, range row and direction
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      for (size_t cc = 0; cc < dimRangeCols; ++cc)
+        for (size_t jj = 0; jj < dimDomain; ++jj)
+          std::copy_n(derivatives.begin() + ((rr * dimRangeCols + cc) * dimDomain + jj) * num_points,
+                      num_points,
+                      ret.row((cc * dimRange + rr) * dimDomain + jj, 0));
+  } // ... jacobian(...)
+
+  /**
+   * \brief Computes value and jacobian in one pass through the compiled expressions, unless gradients were given.
+   */
+  void evaluate_with_jacobian(const DomainType& xx,
+                              RangeType& value,
+                              JacobianRangeType& derivative,
+                              const Common::Parameter& mu = {}) const override final
+  {
+    if (gradients_.size() == 0) {
+      eval_helper<>::evaluate_with_jacobian(*function_, xx, value, derivative);
+      check_value(xx, value);
+    } else {
+      evaluate(xx, value, mu);
+      jacobian(xx, derivative, mu);
+    }
+  } // ... evaluate_with_jacobian(...)
+
+  using BaseType::hessian;
+
+  /**
+   * \brief Computes the second derivatives from the symbolic derivatives of the expressions (see
+   *        MathExpressionBase::hessian), or as the jacobians of the gradients, if these were given.
+   */
+  void hessian(const DomainType& xx, HessianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    if (gradients_.size() == 0) {
+      eval_helper<>::symbolic_hessian(*function_, xx, ret);
+    } else {
+      assert(gradients_.size() == dimRangeCols);
+      eval_helper<>::hessian(gradients_, xx, ret);
+    }
+  } // ... hessian(...)
+
+private:
+  // to the structure-of-arrays layout of the compiled expressions, arg_ptrs[ii] points to the values of x[ii]
+  static void transpose(const std::vector<DomainType>& xx, std::vector<double>& args, const double** arg_ptrs)
+  {
+    const size_t num_points = xx.size();
+    args.resize(dimDomain * num_points);
+    for (size_t ii = 0; ii < dimDomain; ++ii) {
+      arg_ptrs[ii] = args.data() + ii * num_points;
+      for (size_t pp = 0; pp < num_points; ++pp)
+        args[ii * num_points + pp] = xx[pp][ii];
+    }
+  }
+
 #ifndef NDEBUG
 #ifndef DUNE_XT_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
+  void check_value(const DomainType& xx, const RangeType& ret) const
+  {
     bool failure = false;
     std::string error_type;
     for (size_t rr = 0; rr < dimRange; ++rr) {
@@ -325,23 +635,24 @@ public:
                          << "You can disable this check by defining DUNE_XT_FUNCTIONS_EXPRESSION_DISABLE_CHECKS\n");
       }
     }
+  } // ... check_value(...)
+#else // DUNE_XT_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
+  void check_value(const DomainType& /*xx*/, const RangeType& /*ret*/) const
+  {
+  }
 #endif // DUNE_XT_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
+#else // NDEBUG
+  void check_value(const DomainType& /*xx*/, const RangeType& /*ret*/) const
+  {
+  }
 #endif // NDEBUG
-  } // ... evaluate(...)
 
-  using BaseType::jacobian;
-
-  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  void detect_order(const size_t transcendental_ord)
   {
-    if (gradients_.size() == 0) {
-      DUNE_THROW(NotImplemented, "This function does not provide any gradients!");
-    } else {
-      assert(gradients_.size() == dimRangeCols);
-      eval_helper<>::jacobian(gradients_, xx, ret);
-    }
-  } // ... jacobian(...)
+    if (order_ == automatic_order)
+      order_ = function_->degree(transcendental_ord);
+  }
 
-private:
   // fill the rows of the dimRange x dimRangeCols matrix (aka vector< vector< string > > expression) in a vector of
   // length dimRange*dimRangeCols, e.g. [3 4; 1 2] becomes [3 4 1 2], in order to create function_
   void build_function(const std::string variable, const ExpressionStringVectorType& expressions)
@@ -433,7 +744,6 @@ private:
   std::shared_ptr<const MathExpressionFunctionType> function_;
   size_t order_;
   std::string name_;
-  mutable typename Common::PerThreadValue<FieldVector<RangeFieldType, dimRange * dimRangeCols>> tmp_vector_;
   mutable typename Common::PerThreadValue<FieldVector<RangeFieldType, dimRangeCols>> tmp_row_;
   std::vector<std::vector<std::shared_ptr<const MathExpressionGradientType>>> gradients_;
 }; // class ExpressionFunction
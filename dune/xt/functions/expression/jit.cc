@@ -0,0 +1,578 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <config.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+#include "jit.hh"
+#include "vectormath.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+namespace internal {
+
+
+// mirrors the ...Val() functions of mathexpr.cc, keep in sync! The test expression_jit compares every opcode with the
+// interpreter bit for bit.
+static const char* jit_prelude = R"jit(#include <float.h>
+#include <math.h>
+#include <stddef.h>
+
+static const double ErrVal = DBL_MAX;
+static const double sqrtmaxfloat = sqrt(DBL_MAX);
+static const double sqrtminfloat = sqrt(DBL_MIN);
+static const double inveps = .1 / DBL_EPSILON;
+
+// the kernels of vectormath.hh, set by dxtf_jit_kernels() when the library is loaded
+typedef double (*dxtf_kernel_type)(double);
+static dxtf_kernel_type dxtf_sin, dxtf_cos, dxtf_exp, dxtf_log;
+
+extern "C" void dxtf_jit_kernels(dxtf_kernel_type sin_kernel,
+                                 dxtf_kernel_type cos_kernel,
+                                 dxtf_kernel_type exp_kernel,
+                                 dxtf_kernel_type log_kernel)
+{
+  dxtf_sin = sin_kernel;
+  dxtf_cos = cos_kernel;
+  dxtf_exp = exp_kernel;
+  dxtf_log = log_kernel;
+}
+
+static inline double AdditionVal(double v1, double v2)
+{
+  if (v2 == ErrVal || fabs(v2) > sqrtmaxfloat || v1 == ErrVal || fabs(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 + v2;
+}
+static inline double SoustractionVal(double v1, double v2)
+{
+  if (v2 == ErrVal || fabs(v2) > sqrtmaxfloat || v1 == ErrVal || fabs(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 - v2;
+}
+static inline double MultiplicationVal(double v1, double v2)
+{
+  if (fabs(v2) < sqrtminfloat)
+    return 0;
+  if (v2 == ErrVal || fabs(v2) > sqrtmaxfloat)
+    return ErrVal;
+  if (fabs(v1) < sqrtminfloat)
+    return 0;
+  if (v1 == ErrVal || fabs(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 * v2;
+}
+static inline double DivisionVal(double v1, double v2)
+{
+  if (fabs(v2) < sqrtminfloat || v2 == ErrVal || fabs(v2) > sqrtmaxfloat)
+    return ErrVal;
+  if (fabs(v1) < sqrtminfloat)
+    v1 = 0;
+  else if (v1 == ErrVal || fabs(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 / v2;
+}
+static inline double PuissanceVal(double v1, double v2)
+{
+  if (!v1)
+    return 0;
+  if (v2 == ErrVal || v1 == ErrVal || fabs(v2 * log(fabs(v1))) > DBL_MAX_EXP)
+    return ErrVal;
+  return ((v1 > 0 || !fmod(v2, 1)) ? pow(v1, v2) : ErrVal);
+}
+static inline double RacineNVal(double v1, double v2)
+{
+  if (v1 == ErrVal || v2 == ErrVal || !v1 || v2 * log(fabs(v1)) < DBL_MIN_EXP)
+    return ErrVal;
+  if (v2 >= 0)
+    return pow(v2, 1 / v1);
+  return ((fabs(fmod(v1, 2)) == 1) ? -pow(-v2, 1 / v1) : ErrVal);
+}
+static inline double Puiss10Val(double v1, double v2)
+{
+  if (fabs(v2) < sqrtminfloat)
+    return 0;
+  if (v2 == ErrVal || fabs(v2) > DBL_MAX_10_EXP)
+    return ErrVal;
+  if (fabs(v1) < sqrtminfloat)
+    v1 = 0;
+  else if (v1 == ErrVal || fabs(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 * pow(10, v2);
+}
+static inline double ArcTangente2Val(double v1, double v2)
+{
+  if (v2 == ErrVal || fabs(v2) > inveps || v1 == ErrVal || fabs(v1) > inveps)
+    return ErrVal;
+  return (v1 || v2 ? atan2(v1, v2) : ErrVal);
+}
+static inline double MinimumVal(double v1, double v2)
+{
+  return ((v1 == ErrVal || v2 == ErrVal) ? ErrVal : (v2 < v1 ? v2 : v1));
+}
+static inline double MaximumVal(double v1, double v2)
+{
+  return ((v1 == ErrVal || v2 == ErrVal) ? ErrVal : (v2 > v1 ? v2 : v1));
+}
+static inline double PartieEntiereVal(double v)
+{
+  return ((v == ErrVal) ? ErrVal : floor(v));
+}
+static inline double HeavisideVal(double v)
+{
+  return ((v == ErrVal) ? ErrVal : (v > 0 ? 1. : 0.));
+}
+static inline double ConditionVal(double c, double a, double b)
+{
+  return ((c == ErrVal) ? ErrVal : (c > 0 ? a : b));
+}
+static inline double AbsoluVal(double v)
+{
+  return ((v == ErrVal) ? ErrVal : fabs(v));
+}
+static inline double OpposeVal(double v)
+{
+  return ((v == ErrVal) ? ErrVal : -v);
+}
+static inline double ArcSinusVal(double v)
+{
+  return ((v == ErrVal || fabs(v) > 1) ? ErrVal : asin(v));
+}
+static inline double ArcCosinusVal(double v)
+{
+  return ((v == ErrVal || fabs(v) > 1) ? ErrVal : acos(v));
+}
+static inline double ArcTangenteVal(double v)
+{
+  return ((v == ErrVal) ? ErrVal : atan(v));
+}
+static inline double LogarithmeVal(double v)
+{
+  return ((v == ErrVal || v <= 0) ? ErrVal : dxtf_log(v));
+}
+static inline double ExponentielleVal(double v)
+{
+  return ((v == ErrVal || v > DBL_MAX_EXP) ? ErrVal : dxtf_exp(v));
+}
+static inline double SinusVal(double v)
+{
+  return ((v == ErrVal || fabs(v) > inveps) ? ErrVal : dxtf_sin(v));
+}
+static inline double TangenteVal(double v)
+{
+  return ((v == ErrVal || fabs(v) > inveps) ? ErrVal : tan(v));
+}
+static inline double CosinusVal(double v)
+{
+  return ((v == ErrVal || fabs(v) > inveps) ? ErrVal : dxtf_cos(v));
+}
+static inline double RacineVal(double v)
+{
+  return ((v == ErrVal || v > sqrtmaxfloat || v < 0) ? ErrVal : sqrt(v));
+}
+
+)jit";
+
+
+static const char* jit_kernel_name(const RCode code)
+{
+  switch (code) {
+    case BCAdd:
+      return "AdditionVal";
+    case BCSub:
+      return "SoustractionVal";
+    case BCMult:
+      return "MultiplicationVal";
+    case BCDiv:
+      return "DivisionVal";
+    case BCPow:
+      return "PuissanceVal";
+    case BCNthRoot:
+      return "RacineNVal";
+    case BCE10:
+      return "Puiss10Val";
+    case BCAtan2:
+      return "ArcTangente2Val";
+    case BCMin:
+      return "MinimumVal";
+    case BCMax:
+      return "MaximumVal";
+    case BCOpp:
+      return "OpposeVal";
+    case BCAbs:
+      return "AbsoluVal";
+    case BCSqrt:
+      return "RacineVal";
+    case BCSin:
+      return "SinusVal";
+    case BCCos:
+      return "CosinusVal";
+    case BCTg:
+      return "TangenteVal";
+    case BCLn:
+      return "LogarithmeVal";
+    case BCExp:
+      return "ExponentielleVal";
+    case BCAcos:
+      return "ArcCosinusVal";
+    case BCAsin:
+      return "ArcSinusVal";
+    case BCAtan:
+      return "ArcTangenteVal";
+    case BCFloor:
+      return "PartieEntiereVal";
+    case BCHeaviside:
+      return "HeavisideVal";
+    case BCIf:
+      return "ConditionVal";
+    default:
+      return nullptr;
+  }
+} // ... jit_kernel_name(...)
+
+
+static std::string jit_double(const double value)
+{
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "%a", value);
+  return buffer;
+}
+
+
+/**
+ * Writes the statements evaluating the program at one point, where arg(ii) and value(kk) give the code accessing the
+ * ii-th variable and the kk-th output. The ii-th entry of the interpreter's stack becomes the local variable s<ii>, the
+ * ii-th temporary the local variable t<ii>.
+ */
+template <class ArgType, class ValueType>
+static void jit_body(const RProgram& program, std::ostream& out, const ArgType& arg, const ValueType& value)
+{
+  out << "    double s0";
+  for (int ii = 1; ii < program.StackSize(); ++ii)
+    out << ", s" << ii;
+  for (int ii = 0; ii < program.NTemporaries(); ++ii)
+    out << ", t" << ii;
+  out << ";\n";
+  int depth = -1;
+  for (const auto& instr : program.Code()) {
+    switch (instr.code) {
+      case BCNum:
+        ++depth;
+        out << "    s" << depth << " = " << jit_double(program.Constants()[instr.arg]) << ";\n";
+        break;
+      case BCVar:
+        ++depth;
+        out << "    s" << depth << " = " << arg(instr.arg) << ";\n";
+        break;
+      case BCAdd:
+      case BCSub:
+      case BCMult:
+      case BCDiv:
+      case BCPow:
+      case BCNthRoot:
+      case BCE10:
+      case BCAtan2:
+      case BCMin:
+      case BCMax:
+        --depth;
+        out << "    s" << depth << " = " << jit_kernel_name(instr.code) << "(s" << depth << ", s" << depth + 1
+            << ");\n";
+        break;
+      case BCIf:
+        depth -= 2;
+        out << "    s" << depth << " = " << jit_kernel_name(instr.code) << "(s" << depth << ", s" << depth + 1 << ", s"
+            << depth + 2 << ");\n";
+        break;
+      case BCError:
+        out << "    s" << depth << " = ErrVal;\n";
+        break;
+      case BCStore:
+        out << "    " << value(instr.arg) << " = s" << depth << ";\n";
+        depth = -1;
+        break;
+      case BCKeep:
+        out << "    t" << instr.arg << " = s" << depth << ";\n";
+        break;
+      case BCLoad:
+        ++depth;
+        out << "    s" << depth << " = t" << instr.arg << ";\n";
+        break;
+      default:
+        out << "    s" << depth << " = " << jit_kernel_name(instr.code) << "(s" << depth << ");\n";
+    }
+  }
+} // ... jit_body(...)
+
+
+// 64 bit FNV-1a
+static std::string jit_hash(const std::string& str)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (const char& ch : str) {
+    hash ^= static_cast<unsigned char>(ch);
+    hash *= 1099511628211ULL;
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%016llx", hash);
+  return buffer;
+}
+
+
+static bool jit_read(const std::string& filename, std::string& content)
+{
+  std::ifstream file(filename);
+  if (!file)
+    return false;
+  std::stringstream ss;
+  ss << file.rdbuf();
+  content = ss.str();
+  return true;
+}
+
+
+// Creates the missing directories (only accessible by the current user) and checks that the last one is a directory
+// owned by the current user which nobody else may write to, so nobody else can put libraries there.
+static bool jit_create_directories(const std::string& dir)
+{
+  for (size_t pos = dir.find('/', 1); pos != std::string::npos; pos = dir.find('/', pos + 1))
+    ::mkdir(dir.substr(0, pos).c_str(), 0700);
+  ::mkdir(dir.c_str(), 0700);
+  struct stat info;
+  return ::lstat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode) && info.st_uid == ::geteuid()
+         && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+
+// checks that the given file is a regular file owned by the current user which nobody else may write to
+static bool jit_trusted_file(const std::string& filename)
+{
+  struct stat info;
+  return ::lstat(filename.c_str(), &info) == 0 && S_ISREG(info.st_mode) && info.st_uid == ::geteuid()
+         && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+
+// Runs $CXX (defaults to c++, split at whitespace, so it may hold options or a launcher like ccache) without a shell,
+// its output is discarded.
+static bool jit_run_compiler(const std::string& source, const std::string& library)
+{
+  const char* env = std::getenv("CXX");
+  std::istringstream compiler((env != nullptr) ? env : "");
+  std::vector<std::string> args{std::istream_iterator<std::string>(compiler), std::istream_iterator<std::string>()};
+  if (args.empty())
+    args.emplace_back("c++");
+  for (const char* arg : {"-O2", "-ffp-contract=off", "-shared", "-fPIC", "-o"})
+    args.emplace_back(arg);
+  args.push_back(library);
+  args.push_back(source);
+  std::vector<char*> argv;
+  for (auto& arg : args)
+    argv.push_back(&arg[0]);
+  argv.push_back(nullptr);
+  posix_spawn_file_actions_t actions;
+  if (::posix_spawn_file_actions_init(&actions) != 0)
+    return false;
+  ::posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  ::posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+  pid_t pid;
+  const int error = ::posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  ::posix_spawn_file_actions_destroy(&actions);
+  if (error != 0)
+    return false;
+  int status;
+  while (::waitpid(pid, &status, 0) < 0)
+    if (errno != EINTR)
+      return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+} // ... jit_run_compiler(...)
+
+
+// Compiles src into base.so (and stores it as base.cc), returns false if the compiler is not available or fails.
+static bool jit_compile(const std::string& src, const std::string& base)
+{
+  // compile in a directory unique to this call and move the results in place afterwards, other processes may do the
+  // same, "./" keeps relative paths from being taken for options of the compiler
+  std::string tmp_dir = (base[0] == '/' ? "" : "./") + base + ".XXXXXX";
+  if (::mkdtemp(&tmp_dir[0]) == nullptr)
+    return false;
+  const std::string tmp = tmp_dir + "/expression";
+  bool ok;
+  {
+    std::ofstream file(tmp + ".cc");
+    file << src;
+    ok = bool(file);
+  }
+  ok = ok && jit_run_compiler(tmp + ".cc", tmp + ".so");
+  // independent of the umask, as nothing is loaded from files others may write to (see jit_trusted_file())
+  ok = ok && ::chmod((tmp + ".so").c_str(), 0700) == 0 && ::chmod((tmp + ".cc").c_str(), 0600) == 0
+       && std::rename((tmp + ".so").c_str(), (base + ".so").c_str()) == 0
+       && std::rename((tmp + ".cc").c_str(), (base + ".cc").c_str()) == 0;
+  std::remove((tmp + ".cc").c_str());
+  std::remove((tmp + ".so").c_str());
+  ::rmdir(tmp_dir.c_str());
+  return ok;
+} // ... jit_compile(...)
+
+
+// Reuses the cached library, unless its source differs (hash collision) or it is missing, and compiles it otherwise.
+// Never uses anything from a directory somebody else could have written to.
+static bool jit_provide(const std::string& src, const std::string& base, const std::string& cache_dir)
+{
+  if (!jit_create_directories(cache_dir))
+    return false;
+  std::string cached_src;
+  if (jit_trusted_file(base + ".cc") && jit_read(base + ".cc", cached_src) && cached_src == src
+      && jit_trusted_file(base + ".so"))
+    return true;
+  return jit_compile(src, base);
+}
+
+
+// The state of one library in this process: it is provided (or found to be unavailable) once, and dlopened as long as
+// it is in use.
+struct JitLibrary
+{
+  std::once_flag provided_flag;
+  bool available = false;
+  std::weak_ptr<const JitMathExpression> loaded;
+};
+
+// only guards jit_libraries and JitLibrary::loaded, compiling and loading happen without holding it
+static std::mutex jit_mutex;
+static std::map<std::string, std::shared_ptr<JitLibrary>> jit_libraries;
+
+
+} // namespace internal
+
+
+JitMathExpression::JitMathExpression(const std::string& library,
+                                     void* handle,
+                                     PointFunctionType point,
+                                     BatchFunctionType batch)
+  : library_(library)
+  , handle_(handle)
+  , point_function_(point)
+  , batch_function_(batch)
+{
+}
+
+JitMathExpression::~JitMathExpression()
+{
+  ::dlclose(handle_);
+}
+
+bool JitMathExpression::enabled()
+{
+  const char* env = std::getenv("DXT_FUNCTIONS_EXPRESSION_JIT");
+  return env != nullptr && std::string(env) != "" && std::string(env) != "0";
+}
+
+std::string JitMathExpression::default_cache_dir()
+{
+  const char* env = std::getenv("DXT_FUNCTIONS_EXPRESSION_JIT_CACHE");
+  if (env != nullptr && std::string(env) != "")
+    return env;
+  env = std::getenv("XDG_CACHE_HOME");
+  if (env != nullptr && std::string(env) != "")
+    return std::string(env) + "/dune-xt-functions";
+  env = std::getenv("HOME");
+  if (env != nullptr && std::string(env) != "")
+    return std::string(env) + "/.cache/dune-xt-functions";
+  const struct passwd* user = ::getpwuid(::geteuid());
+  if (user != nullptr && user->pw_dir != nullptr && std::string(user->pw_dir) != "")
+    return std::string(user->pw_dir) + "/.cache/dune-xt-functions";
+  return "";
+}
+
+std::string JitMathExpression::source(const RProgram& program)
+{
+  std::stringstream out;
+  out << internal::jit_prelude;
+  out << "extern \"C\" void dxtf_jit_point(const double* x, double* out)\n{\n";
+  internal::jit_body(program,
+                     out,
+                     [](int ii) { return "x[" + std::to_string(ii) + "]"; },
+                     [](int kk) { return "out[" + std::to_string(kk) + "]"; });
+  out << "}\n\n";
+  out << "extern \"C\" void dxtf_jit_batch(const double* const* x, double* out, size_t npoints)\n{\n";
+  out << "  for (size_t p = 0; p < npoints; ++p) {\n";
+  internal::jit_body(program,
+                     out,
+                     [](int ii) { return "x[" + std::to_string(ii) + "][p]"; },
+                     [](int kk) { return "out[" + std::to_string(kk) + " * npoints + p]"; });
+  out << "  }\n}\n";
+  return out.str();
+} // ... source(...)
+
+std::shared_ptr<const JitMathExpression> JitMathExpression::create(const RProgram& program,
+                                                                   const std::string& cache_dir)
+{
+  if (program.NFunctions() > 0 || program.NOutputs() == 0 || cache_dir.empty())
+    return nullptr;
+  const std::string src = source(program);
+  const std::string base = cache_dir + "/expression_" + internal::jit_hash(src);
+  std::shared_ptr<internal::JitLibrary> library;
+  {
+    std::lock_guard<std::mutex> guard(internal::jit_mutex);
+    auto& entry = internal::jit_libraries[base];
+    if (!entry)
+      entry = std::make_shared<internal::JitLibrary>();
+    library = entry;
+    if (auto existing = library->loaded.lock())
+      return existing;
+  }
+  // other threads requesting the same library wait here, a failure only disables this library
+  std::call_once(library->provided_flag,
+                 [&]() { library->available = internal::jit_provide(src, base, cache_dir); });
+  if (!library->available)
+    return nullptr;
+  void* handle = ::dlopen((base + ".so").c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr)
+    return nullptr;
+  auto point = reinterpret_cast<PointFunctionType>(::dlsym(handle, "dxtf_jit_point"));
+  auto batch = reinterpret_cast<BatchFunctionType>(::dlsym(handle, "dxtf_jit_batch"));
+  typedef void (*KernelsFunctionType)(double (*)(double), double (*)(double), double (*)(double), double (*)(double));
+  auto kernels = reinterpret_cast<KernelsFunctionType>(::dlsym(handle, "dxtf_jit_kernels"));
+  if (point == nullptr || batch == nullptr || kernels == nullptr) {
+    ::dlclose(handle);
+    return nullptr;
+  }
+  kernels(&KernelSin, &KernelCos, &KernelExp, &KernelLog);
+  std::shared_ptr<const JitMathExpression> ret(new JitMathExpression(base + ".so", handle, point, batch));
+  // if another thread was faster, its library is used (dlopen handed out the same one to both)
+  std::lock_guard<std::mutex> guard(internal::jit_mutex);
+  if (auto existing = library->loaded.lock())
+    return existing;
+  library->loaded = ret;
+  return ret;
+} // ... create(...)
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
@@ -0,0 +1,88 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_EXPRESSION_JIT_HH
+#define DUNE_XT_FUNCTIONS_EXPRESSION_JIT_HH
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "mathexpr.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+
+
+/**
+ * \brief Native code for a compiled expression, obtained by generating C++ and compiling it to a shared object.
+ *
+ * This is opt-in: the expression bases only use it if the environment variable DXT_FUNCTIONS_EXPRESSION_JIT is set
+ * (to anything but 0). The shared objects are cached in DXT_FUNCTIONS_EXPRESSION_JIT_CACHE (defaults to
+ * $XDG_CACHE_HOME/dune-xt-functions or ~/.cache/dune-xt-functions), keyed by a hash of the generated source, which
+ * contains all expressions, and compiled with $CXX (defaults to c++). Nothing is loaded from a cache directory which is
+ * not owned by the current user or which others may write to. If the compiler is not available or fails, or the cache
+ * directory is not trusted, create() returns nullptr and the callers keep using the interpreter. The generated code
+ * mirrors the interpreter of mathexpr.cc, so both give identical results.
+ */
+class JitMathExpression
+{
+  typedef void (*PointFunctionType)(const double*, double*);
+  typedef void (*BatchFunctionType)(const double* const*, double*, size_t);
+
+public:
+  static bool enabled();
+
+  //! Empty if there is no home directory, which disables the native code unless a cache directory is given.
+  static std::string default_cache_dir();
+
+  //! Returns nullptr if the program cannot be compiled (no compiler, untrusted cache_dir, or programs calling
+  //! RFunctions).
+  static std::shared_ptr<const JitMathExpression> create(const RProgram& program,
+                                                         const std::string& cache_dir = default_cache_dir());
+
+  static std::string source(const RProgram& program);
+
+  JitMathExpression(const JitMathExpression& other) = delete;
+
+  JitMathExpression& operator=(const JitMathExpression& other) = delete;
+
+  ~JitMathExpression();
+
+  const std::string& library() const
+  {
+    return library_;
+  }
+
+  //! \sa RProgram::Val(const double*, double*)
+  void evaluate(const double* args, double* values) const
+  {
+    point_function_(args, values);
+  }
+
+  //! \sa RProgram::Val(const double* const*, double*, size_t)
+  void evaluate(const double* const* args, double* values, const size_t num_points) const
+  {
+    batch_function_(args, values, num_points);
+  }
+
+private:
+  JitMathExpression(const std::string& library, void* handle, PointFunctionType point, BatchFunctionType batch);
+
+  const std::string library_;
+  void* handle_;
+  const PointFunctionType point_function_;
+  const BatchFunctionType batch_function_;
+}; // class JitMathExpression
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_EXPRESSION_JIT_HH
@@ -19,7 +19,38 @@ This software comes with absolutely no warranty.
 
 */
 
+/*
+
+Changes made for dune-xt-functions:
+
+- The stack functions used by ROperation::Val() compute their values with the
+  inline functions ...Val() below, which are also used by the new RProgram
+  (see mathexpr.hh) to evaluate at a whole block of points at once.
+- Added RProgram::Optimize(), RProgram::Bind(), RProgram::SelectOutputs(),
+  RProgram::Bounds(), RProgram::Degrees() and RProgram::ValDerivatives() (see
+  mathexpr.hh).
+- Added RParser, which ROperation(const char*, ...) uses before falling back
+  to the original parser, now ROperation::ParseStr().
+- ln, exp, sin and cos are computed by the functions of vectormath.hh instead
+  of libm, which RProgram evaluates at several points at once with SIMD
+  instructions where the CPU supports them. This includes ROperation::Val(),
+  so its results may differ from libm's in the last bit.
+- Added RProgram::Save() and RProgram::Load() (see mathexpr.hh).
+- ROperation::BuildCode() translates the stack functions into RStep opcodes
+  (see ROperation::BuildSteps()), which ROperation::Val() dispatches in a
+  switch. The former ROperation::Val() is now ROperation::ValThreaded().
+- Added the operators Min, Max, Floor, Heaviside, If and Clamp, which both
+  parsers, Diff(), Expr() and RProgram know (see mathexpr.hh).
+
+*/
+
 #include "mathexpr.hh"
+#include "vectormath.hh"
+
+#include <climits>
+#include <cstring>
+#include <map>
+#include <tuple>
 
 
 char* MidStr(const char* s, int i1, int i2)
@@ -283,6 +314,7 @@ ROperation::ROperation()
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
   BuildCode();
 }
 
@@ -303,6 +335,7 @@ ROperation::ROperation(const ROperation& ROp)
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
   if (ROp.mmb1 != NULL)
     mmb1 = new ROperation(*(ROp.mmb1));
   else
@@ -340,6 +373,7 @@ ROperation::ROperation(double x)
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
   BuildCode();
 }
 
@@ -357,6 +391,7 @@ ROperation::ROperation(const RVar& varp)
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
   BuildCode();
 }
 
@@ -375,6 +410,7 @@ ROperation& ROperation::operator=(const ROperation& ROp)
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
   if (ROp.mmb1 != NULL)
     mmb1 = new ROperation(*(ROp.mmb1));
   else
@@ -629,6 +665,86 @@ ROperation atan(const ROperation& op)
   rop.mmb2 = new ROperation(op);
   return rop;
 }
+ROperation min(const ROperation& op1, const ROperation& op2)
+{
+  ROperation rop;
+  rop.op = Min;
+  rop.mmb2 = new ROperation((op1, op2));
+  rop.BuildCode();
+  return rop;
+}
+ROperation max(const ROperation& op1, const ROperation& op2)
+{
+  ROperation rop;
+  rop.op = Max;
+  rop.mmb2 = new ROperation((op1, op2));
+  rop.BuildCode();
+  return rop;
+}
+ROperation floor(const ROperation& op)
+{
+  ROperation rop;
+  rop.op = Floor;
+  rop.mmb2 = new ROperation(op);
+  rop.BuildCode();
+  return rop;
+}
+ROperation heaviside(const ROperation& op)
+{
+  ROperation rop;
+  rop.op = Heaviside;
+  rop.mmb2 = new ROperation(op);
+  rop.BuildCode();
+  return rop;
+}
+ROperation condition(const ROperation& op1, const ROperation& op2, const ROperation& op3)
+{
+  ROperation rop;
+  rop.op = If;
+  rop.mmb2 = new ROperation(((op1, op2), op3));
+  rop.BuildCode();
+  return rop;
+}
+
+// Number of arguments the functions taking a fixed number of them expect, 0 for the others
+static int Arity(ROperator op)
+{
+  switch (op) {
+    case Floor:
+    case Heaviside:
+      return 1;
+    case Min:
+    case Max:
+      return 2;
+    case If:
+    case Clamp:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+// Number of arguments juxtaposed in op, the parsers nest a,b,c as (a,b),c and the operator , as a,(b,c)
+static int NArguments(const ROperation* op)
+{
+  if (op == NULL)
+    return 0;
+  return (op->op == Juxt ? NArguments(op->mmb1) + NArguments(op->mmb2) : 1);
+}
+
+// Stores the first n arguments juxtaposed in op in ppop, returns NArguments(op)
+static int Arguments(const ROperation* op, const ROperation** ppop, int n)
+{
+  if (op == NULL)
+    return 0;
+  if (op->op != Juxt) {
+    if (n > 0)
+      *ppop = op;
+    return 1;
+  }
+  const int n1 = Arguments(op->mmb1, ppop, n);
+  return n1 + (n1 < n ? Arguments(op->mmb2, ppop + n1, n - n1) : NArguments(op->mmb2));
+}
 
 ROperation ApplyOperator(int n, ROperation** pops, ROperation (*func)(const ROperation&, const ROperation&))
 {
@@ -837,16 +953,20 @@ int IsFunction(const char* s, int n)
   if (CompStr(s, n, "sin") || CompStr(s, n, "cos") || CompStr(s, n, "exp") || CompStr(s, n, "tan")
       || CompStr(s, n, "log")
       || CompStr(s, n, "atg")
-      || CompStr(s, n, "abs"))
+      || CompStr(s, n, "abs")
+      || CompStr(s, n, "min")
+      || CompStr(s, n, "max"))
     return 3;
-  if (CompStr(s, n, "tg") || CompStr(s, n, "ln"))
+  if (CompStr(s, n, "tg") || CompStr(s, n, "ln") || CompStr(s, n, "if"))
     return 2;
   if (CompStr(s, n, "sqrt") || CompStr(s, n, "asin") || CompStr(s, n, "atan") || CompStr(s, n, "acos"))
     return 4;
   if (CompStr(s, n, "arcsin") || CompStr(s, n, "arccos") || CompStr(s, n, "arctan"))
     return 6;
-  if (CompStr(s, n, "arctg"))
+  if (CompStr(s, n, "arctg") || CompStr(s, n, "floor") || CompStr(s, n, "clamp"))
     return 5;
+  if (CompStr(s, n, "heaviside"))
+    return 9;
   return 0;
 }
 
@@ -937,6 +1057,348 @@ void IsolateNumbers(char*& s, int nvar, RVar** ppvar, int nfunc, RFunction** ppf
   InsStr(s, i, ')');
 }
 
+// Single pass recursive descent parser building the same trees as the string rewriting parser
+// ROperation::ParseStr() below, without copying the string. The grammar reproduces the precedences of
+// ParseStr(), which splits at the last ',', then at the last '+', at the last binary '-', at a leading '-', at
+// the last '*' (juxtaposed operands being multiplied), at the last '/' and at the last '^':
+//   expr    := sum (',' sum)*
+//   sum     := diff ('+' diff)*
+//   diff    := sterm ('-' sterm)*
+//   sterm   := '-' sterm | product
+//   product := quot ('*' mterm | quot)*
+//   mterm   := '-' mterm | quot
+//   quot    := power ('/' dterm)*
+//   dterm   := '-' dterm | power
+//   power   := prim ('^' pterm)*
+//   pterm   := '-' pterm | prim
+//   prim    := number | pi | variable | function '(' expr ')' | '(' expr ')'
+// All binary operators are left associative. Parse() returns NULL for anything else (the '#' and 'E' operators,
+// functions without brackets, syntax errors, ...) or if the names of the variables and functions could make
+// ParseStr() split differently, in which case ParseStr() has to be used.
+class RParser
+{
+  const char *pos, *end;
+  int nvar;
+  PRVar* ppvar;
+  int nfunc;
+  PRFunction* ppfunc;
+
+  static PROperation Node(ROperator op, PROperation mmb1, PROperation mmb2)
+  {
+    return new ROperation(op, mmb1, mmb2, ErrVal, NULL, NULL);
+  }
+
+  static PROperation Fail(PROperation op)
+  {
+    delete op;
+    return NULL;
+  }
+
+  void SkipSpaces()
+  {
+    while (pos < end && *pos == ' ')
+      pos++;
+  }
+
+  // Consumes c if it comes next
+  signed char Accept(char c)
+  {
+    const char* const p = pos;
+    SkipSpaces();
+    if (pos < end && *pos == c) {
+      pos++;
+      return 1;
+    }
+    pos = p;
+    return 0;
+  }
+
+  int Matches(const char* s, const char* name) const
+  {
+    int l = 0;
+    for (; name[l]; l++)
+      if (s + l >= end || s[l] != name[l])
+        return 0;
+    return l;
+  }
+
+  // Same as IsFunction(s, n, nfunc, ppfunc), op and pfunc receive the function
+  int FunctionAt(const char* s, ROperator& op, PRFunction& pf) const
+  {
+    static const struct
+    {
+      const char* name;
+      ROperator op;
+    } standard[] = {{"sin", Sin},     {"cos", Cos},       {"exp", Exp},       {"tan", Tg},      {"log", Ln},
+                    {"atg", Atan},    {"abs", Abs},       {"tg", Tg},         {"ln", Ln},       {"sqrt", Sqrt},
+                    {"asin", Asin},   {"atan", Atan},     {"acos", Acos},     {"arcsin", Asin}, {"arccos", Acos},
+                    {"arctan", Atan}, {"arctg", Atan},  {"min", Min},       {"max", Max},     {"floor", Floor},
+                    {"clamp", Clamp}, {"if", If},       {"heaviside", Heaviside}};
+    int i, l;
+    for (i = 0; i < (int)(sizeof(standard) / sizeof(standard[0])); i++)
+      if ((l = Matches(s, standard[i].name))) {
+        op = standard[i].op;
+        pf = NULL;
+        return l;
+      }
+    int lmax = 0;
+    for (i = 0; i < nfunc; i++)
+      if ((l = Matches(s, ppfunc[i]->name)) > lmax) {
+        lmax = l;
+        op = Fun;
+        pf = ppfunc[i];
+      }
+    return lmax;
+  }
+
+  // Same as IsVar(s, n, nvar, ppvar), pv receives the first variable with that name
+  int VarAt(const char* s, const RVar*& pv) const
+  {
+    int i, l, lmax = 0;
+    for (i = 0; i < nvar; i++)
+      if ((l = Matches(s, ppvar[i]->name)) > lmax) {
+        lmax = l;
+        pv = ppvar[i];
+      }
+    return lmax;
+  }
+
+  static signed char IsPi(const char* s, const char* e)
+  {
+    return (e - s >= 2 && ((s[0] == 'p' && s[1] == 'i') || (s[0] == 'P' && (s[1] == 'I' || s[1] == 'i'))));
+  }
+
+  // ParseStr() marks function names occurring inside of a name it has not isolated yet
+  signed char ContainsFunction(const char* s, int l) const
+  {
+    ROperator op;
+    PRFunction pf;
+    int i;
+    for (i = 1; i < l; i++)
+      if (FunctionAt(s + i, op, pf))
+        return 1;
+    return 0;
+  }
+
+  signed char StartsOperand() const
+  {
+    return (pos < end && !strchr(" )+-*/^,", *pos));
+  }
+
+  PROperation Prim()
+  {
+    SkipSpaces();
+    if (pos == end)
+      return NULL;
+    if (*pos == '(') {
+      pos++;
+      PROperation op = Expr();
+      if (op == NULL || !Accept(')'))
+        return Fail(op);
+      return op;
+    }
+    if (IsNumeric(*pos)) {
+      char buf[64];
+      int l = 0;
+      for (; pos < end && IsNumeric(*pos); pos++)
+        if (l < 63)
+          buf[l++] = *pos;
+        else
+          return NULL;
+      buf[l] = 0;
+      return new ROperation(Num, NULL, NULL, atof(buf), NULL, NULL);
+    }
+    const RVar* pv = NULL;
+    ROperator fop = ErrOp;
+    PRFunction pf = NULL;
+    const int lv = VarAt(pos, pv);
+    const int lf = FunctionAt(pos, fop, pf);
+    if (lv > lf) {
+      if (ContainsFunction(pos, lv))
+        return NULL;
+      pos += lv;
+      return new ROperation(Var, NULL, NULL, ErrVal, pv, NULL);
+    }
+    if (lf) {
+      if (IsPi(pos, end))
+        return NULL;
+      pos += lf;
+      if (!Accept('('))
+        return NULL;
+      PROperation arg = Expr();
+      if (arg == NULL || !Accept(')'))
+        return Fail(arg);
+      if (fop != Fun) {
+        if (Arity(fop) && NArguments(arg) != Arity(fop)) {
+          delete arg;
+          return new ROperation(ErrOp, NULL, NULL, ErrVal, NULL, NULL);
+        }
+        return Node(fop, NULL, arg);
+      }
+      if (arg->NMembers() == pf->nvars)
+        return new ROperation(Fun, NULL, arg, ErrVal, NULL, pf);
+      delete arg;
+      return new ROperation(ErrOp, NULL, NULL, ErrVal, NULL, pf);
+    }
+    if (IsPi(pos, end) && !ContainsFunction(pos, 2)) {
+      pos += 2;
+      return new ROperation(Num, NULL, NULL, 3.141592653589793238462643383279L, NULL, NULL);
+    }
+    return NULL;
+  }
+
+  // Parses an optionally negated operand, (this->*next)() parsing the operand itself
+  PROperation Negated(PROperation (RParser::*next)())
+  {
+    if (Accept('-')) {
+      PROperation op = Negated(next);
+      return (op == NULL ? NULL : Node(Opp, NULL, op));
+    }
+    return (this->*next)();
+  }
+
+  PROperation Power()
+  {
+    PROperation op = Prim();
+    while (op != NULL) {
+      if (!Accept('^'))
+        return op;
+      PROperation op2 = Negated(&RParser::Prim);
+      op = (op2 == NULL ? Fail(op) : Node(Pow, op, op2));
+    }
+    return NULL;
+  }
+
+  PROperation Quotient()
+  {
+    PROperation op = Power();
+    while (op != NULL) {
+      if (!Accept('/'))
+        return op;
+      PROperation op2 = Negated(&RParser::Power);
+      op = (op2 == NULL ? Fail(op) : Node(Div, op, op2));
+    }
+    return NULL;
+  }
+
+  PROperation Product()
+  {
+    PROperation op = Quotient();
+    while (op != NULL) {
+      PROperation op2;
+      if (Accept('*'))
+        op2 = Negated(&RParser::Quotient);
+      else if (StartsOperand())
+        op2 = Quotient();
+      else {
+        // ParseStr() removes spaces before splitting nested expressions, so "(2 3)" is 23 and "(x 1)" may be the
+        // variable x1
+        SkipSpaces();
+        return (StartsOperand() ? Fail(op) : op);
+      }
+      op = (op2 == NULL ? Fail(op) : Node(Mult, op, op2));
+    }
+    return NULL;
+  }
+
+  PROperation Difference()
+  {
+    PROperation op = Negated(&RParser::Product);
+    while (op != NULL) {
+      if (!Accept('-'))
+        return op;
+      PROperation op2 = Negated(&RParser::Product);
+      op = (op2 == NULL ? Fail(op) : Node(Sub, op, op2));
+    }
+    return NULL;
+  }
+
+  PROperation Sum()
+  {
+    PROperation op = Difference();
+    while (op != NULL) {
+      if (!Accept('+'))
+        return op;
+      PROperation op2 = Difference();
+      op = (op2 == NULL ? Fail(op) : Node(Add, op, op2));
+    }
+    return NULL;
+  }
+
+  PROperation Expr()
+  {
+    PROperation op = Sum();
+    while (op != NULL) {
+      if (!Accept(','))
+        return op;
+      PROperation op2 = Sum();
+      op = (op2 == NULL ? Fail(op) : Node(Juxt, op, op2));
+    }
+    return NULL;
+  }
+
+  // Names ParseStr() would not treat like single tokens
+  static signed char IsPlainName(const char* name)
+  {
+    if (name == NULL || !name[0] || IsNumeric(name[0]) || EqStr(name, "pi") || EqStr(name, "PI") || EqStr(name, "Pi")
+        || EqStr(name, "Error"))
+      return 0;
+    for (; *name; name++)
+      if (strchr("()+-*/^#,:; \t\n", *name))
+        return 0;
+    return 1;
+  }
+
+public:
+  RParser(const char* s, int nvarp, PRVar* ppvarp, int nfuncp, PRFunction* ppfuncp)
+    : pos(s)
+    , end(s + strlen(s))
+    , nvar(nvarp)
+    , ppvar(ppvarp)
+    , nfunc(nfuncp)
+    , ppfunc(ppfuncp)
+  {
+  }
+
+  PROperation Parse()
+  {
+    // ParseStr() does not isolate pi if there are no variables
+    if (!nvar)
+      return NULL;
+    int i;
+    for (i = 0; i < nvar; i++)
+      if (!IsPlainName(ppvar[i]->name))
+        return NULL;
+    for (i = 0; i < nfunc; i++)
+      if (!IsPlainName(ppfunc[i]->name))
+        return NULL;
+    PROperation op = Expr();
+    SkipSpaces();
+    if (op != NULL && pos != end)
+      return Fail(op);
+    return op;
+  }
+}; // class RParser
+
+ROperation::ROperation(
+    ROperator opp, PROperation mmb1p, PROperation mmb2p, double valc, const RVar* pvarp, RFunction* pfuncp)
+{
+  op = opp;
+  mmb1 = mmb1p;
+  mmb2 = mmb2p;
+  ValC = valc;
+  pvar = pvarp;
+  pvarval = (pvarp != NULL ? pvarp->pval : NULL);
+  pfunc = pfuncp;
+  containfuncflag = 0;
+  pinstr = NULL;
+  pvals = NULL;
+  ppile = NULL;
+  pfuncpile = NULL;
+  pcode = NULL;
+  BuildCode();
+}
+
 ROperation::ROperation(const char* sp, int nvar, PRVar* ppvarp, int nfuncp, PRFunction* ppfuncp)
 {
   ValC = ErrVal;
@@ -951,6 +1413,36 @@ ROperation::ROperation(const char* sp, int nvar, PRVar* ppvarp, int nfuncp, PRFu
   pvals = NULL;
   ppile = NULL;
   pfuncpile = NULL;
+  pcode = NULL;
+  PROperation parsed = RParser(sp, nvar, ppvarp, nfuncp, ppfuncp).Parse();
+  if (parsed == NULL) {
+    ParseStr(sp, nvar, ppvarp, nfuncp, ppfuncp);
+    return;
+  }
+  // take over the parsed tree and its code
+  op = parsed->op;
+  mmb1 = parsed->mmb1;
+  mmb2 = parsed->mmb2;
+  ValC = parsed->ValC;
+  pvar = parsed->pvar;
+  pvarval = parsed->pvarval;
+  pfunc = parsed->pfunc;
+  pinstr = parsed->pinstr;
+  pvals = parsed->pvals;
+  ppile = parsed->ppile;
+  pfuncpile = parsed->pfuncpile;
+  pcode = parsed->pcode;
+  parsed->mmb1 = parsed->mmb2 = NULL;
+  parsed->pinstr = NULL;
+  parsed->pvals = NULL;
+  parsed->ppile = NULL;
+  parsed->pfuncpile = NULL;
+  parsed->pcode = NULL;
+  delete parsed;
+}
+
+void ROperation::ParseStr(const char* sp, int nvar, PRVar* ppvarp, int nfuncp, PRFunction* ppfuncp)
+{
   int i, j, k, l;
   signed char flag = 1;
   char *s = CopyStr(sp), *s1 = NULL, *s2 = NULL;
@@ -1166,6 +1658,24 @@ ROperation::ROperation(const char* sp, int nvar, PRVar* ppvarp, int nfuncp, PRFu
     } else if (CompStr(s, 1, "arctg")) {
       op = Atan;
       s2 = MidStr(s, 6, strlen(s) - 2);
+    } else if (CompStr(s, 1, "min")) {
+      op = Min;
+      s2 = MidStr(s, 4, strlen(s) - 2);
+    } else if (CompStr(s, 1, "max")) {
+      op = Max;
+      s2 = MidStr(s, 4, strlen(s) - 2);
+    } else if (CompStr(s, 1, "floor")) {
+      op = Floor;
+      s2 = MidStr(s, 6, strlen(s) - 2);
+    } else if (CompStr(s, 1, "clamp")) {
+      op = Clamp;
+      s2 = MidStr(s, 6, strlen(s) - 2);
+    } else if (CompStr(s, 1, "if")) {
+      op = If;
+      s2 = MidStr(s, 3, strlen(s) - 2);
+    } else if (CompStr(s, 1, "heaviside")) {
+      op = Heaviside;
+      s2 = MidStr(s, 10, strlen(s) - 2);
     } else {
       for (i = -1, k = 0, j = 0; j < nfuncp; j++)
         if (CompStr(s, 1, ppfuncp[j]->name) && k < (int)strlen(ppfuncp[j]->name)) {
@@ -1187,6 +1697,11 @@ ROperation::ROperation(const char* sp, int nvar, PRVar* ppvarp, int nfuncp, PRFu
         mmb2 = NULL;
         goto fin;
       }
+    if (Arity(op) && NArguments(mmb2) != Arity(op)) {
+      op = ErrOp;
+      delete mmb2;
+      mmb2 = NULL;
+    }
     goto fin;
   };
   i = SearchOperator(s, Mult);
@@ -1283,6 +1798,10 @@ void ROperation::Destroy()
     delete[] pfuncpile;
     pfuncpile = NULL;
   }
+  if (pcode != NULL) {
+    delete[] pcode;
+    pcode = NULL;
+  }
 }
 
 int operator==(const RVar& var1, const RVar& var2)
@@ -1547,6 +2066,25 @@ ROperation ROperation::Diff(const RVar& var) const
       return (-mmb2->Diff(var) / sqrt(1 - ((*mmb2) ^ 2)));
     case Abs:
       return (mmb2->Diff(var) * (*mmb2) / (*this));
+    case Floor:
+    case Heaviside:
+      return 0.;
+    case Min:
+    case Max:
+    case If:
+    case Clamp: {
+      // the derivative of the selected argument, min(a,b) is b for a-b>0 and max(a,b) is b for b-a>0
+      const ROperation* args[3];
+      if (Arguments(mmb2, args, 3) != Arity(op))
+        return ErrVal;
+      if (op == Min)
+        return condition(*args[0] - *args[1], args[1]->Diff(var), args[0]->Diff(var));
+      if (op == Max)
+        return condition(*args[1] - *args[0], args[1]->Diff(var), args[0]->Diff(var));
+      if (op == If)
+        return condition(*args[0], args[1]->Diff(var), args[2]->Diff(var));
+      return min(max(*args[0], *args[1]), *args[2]).Diff(var);
+    }
     case Fun:
       if (pfunc->type == -1 || pfunc->type == 0)
         return ErrVal;
@@ -1601,6 +2139,8 @@ char* ROperation::Expr() const
   if (op == Fun)
     if (strlen(pfunc->name) > 4)
       n += strlen(pfunc->name) - 4;
+  if (op == Heaviside)
+    n += strlen("heaviside") - 4;
   if (mmb1 != NULL) {
     s1 = mmb1->Expr();
     n += strlen(s1);
@@ -1784,6 +2324,24 @@ char* ROperation::Expr() const
     case Fun:
       sprintf(s, "%s(%s)", pfunc->name, s2);
       break;
+    case Min:
+      sprintf(s, "min(%s)", s2);
+      break;
+    case Max:
+      sprintf(s, "max(%s)", s2);
+      break;
+    case Floor:
+      sprintf(s, "floor(%s)", s2);
+      break;
+    case Heaviside:
+      sprintf(s, "heaviside(%s)", s2);
+      break;
+    case If:
+      sprintf(s, "if(%s)", s2);
+      break;
+    case Clamp:
+      sprintf(s, "clamp(%s)", s2);
+      break;
     default:
       return CopyStr("Error");
   };
@@ -1798,207 +2356,506 @@ const double sqrtmaxfloat = sqrt(DBL_MAX);
 const double sqrtminfloat = sqrt(DBL_MIN);
 const double inveps = .1 / DBL_EPSILON;
 
-void Addition(double*& p)
+static inline double AdditionVal(double v1, double v2)
 {
-  if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (*(--p) == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *p = ErrVal;
-    return;
-  };
-  *p += (*(p + 1));
+  if (v2 == ErrVal || fabsl(v2) > sqrtmaxfloat || v1 == ErrVal || fabsl(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 + v2;
 }
-void Soustraction(double*& p)
+static inline double SoustractionVal(double v1, double v2)
 {
-  if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (*(--p) == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *p = ErrVal;
-    return;
-  };
-  *p -= (*(p + 1));
+  if (v2 == ErrVal || fabsl(v2) > sqrtmaxfloat || v1 == ErrVal || fabsl(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 - v2;
 }
-void Multiplication(double*& p)
+static inline double MultiplicationVal(double v1, double v2)
 {
-  if (fabsl(*p) < sqrtminfloat) {
-    *--p = 0;
-    return;
-  };
-  if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (fabsl(*(--p)) < sqrtminfloat) {
-    *p = 0;
-    return;
-  };
-  if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *p = ErrVal;
-    return;
-  };
-  *p *= (*(p + 1));
+  if (fabsl(v2) < sqrtminfloat)
+    return 0;
+  if (v2 == ErrVal || fabsl(v2) > sqrtmaxfloat)
+    return ErrVal;
+  if (fabsl(v1) < sqrtminfloat)
+    return 0;
+  if (v1 == ErrVal || fabsl(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 * v2;
 }
-void Division(double*& p)
+static inline double DivisionVal(double v1, double v2)
 {
-  if (fabsl(*p) < sqrtminfloat || *p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (fabsl(*(--p)) < sqrtminfloat)
-    *p = 0;
-  else if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *p = ErrVal;
-    return;
-  };
-  *p /= (*(p + 1));
+  if (fabsl(v2) < sqrtminfloat || v2 == ErrVal || fabsl(v2) > sqrtmaxfloat)
+    return ErrVal;
+  if (fabsl(v1) < sqrtminfloat)
+    v1 = 0;
+  else if (v1 == ErrVal || fabsl(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 / v2;
 }
-void Puissance(double*& p)
+static inline double PuissanceVal(double v1, double v2)
 {
-  double v2 = *p--, v1 = *p;
-  if (!v1) {
-    *p = 0;
-    return;
-  };
-  if (v2 == ErrVal || v1 == ErrVal || fabsl(v2 * logl(fabsl(v1))) > DBL_MAX_EXP) {
-    *p = ErrVal;
-    return;
-  };
-  *p = ((v1 > 0 || !fmodl(v2, 1)) ? powl(v1, v2) : ErrVal);
+  if (!v1)
+    return 0;
+  if (v2 == ErrVal || v1 == ErrVal || fabsl(v2 * logl(fabsl(v1))) > DBL_MAX_EXP)
+    return ErrVal;
+  return ((v1 > 0 || !fmodl(v2, 1)) ? powl(v1, v2) : ErrVal);
 }
-void RacineN(double*& p)
+static inline double RacineNVal(double v1, double v2)
 {
-  double v2 = *p--, v1 = *p;
-  if (v1 == ErrVal || v2 == ErrVal || !v1 || v2 * logl(fabsl(v1)) < DBL_MIN_EXP) {
-    *p = ErrVal;
-    return;
-  };
-  if (v2 >= 0) {
-    *p = powl(v2, 1 / v1);
-    return;
-  };
-  *p = ((fabsl(fmodl(v1, 2)) == 1) ? -powl(-v2, 1 / v1) : ErrVal);
+  if (v1 == ErrVal || v2 == ErrVal || !v1 || v2 * logl(fabsl(v1)) < DBL_MIN_EXP)
+    return ErrVal;
+  if (v2 >= 0)
+    return powl(v2, 1 / v1);
+  return ((fabsl(fmodl(v1, 2)) == 1) ? -powl(-v2, 1 / v1) : ErrVal);
 }
-void Puiss10(double*& p)
+static inline double Puiss10Val(double v1, double v2)
 {
-  if (fabsl(*p) < sqrtminfloat) {
-    *(--p) = 0;
-    return;
-  };
-  if (*p == ErrVal || fabsl(*p) > DBL_MAX_10_EXP) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (fabsl(*(--p)) < sqrtminfloat)
-    *p = 0;
-  else if (*p == ErrVal || fabsl(*p) > sqrtmaxfloat) {
-    *p = ErrVal;
-    return;
-  };
-  *p *= pow10l(*(p + 1));
+  if (fabsl(v2) < sqrtminfloat)
+    return 0;
+  if (v2 == ErrVal || fabsl(v2) > DBL_MAX_10_EXP)
+    return ErrVal;
+  if (fabsl(v1) < sqrtminfloat)
+    v1 = 0;
+  else if (v1 == ErrVal || fabsl(v1) > sqrtmaxfloat)
+    return ErrVal;
+  return v1 * pow10l(v2);
 }
-void ArcTangente2(double*& p)
+static inline double ArcTangente2Val(double v1, double v2)
 {
-  if (*p == ErrVal || fabsl(*p) > inveps) {
-    *(--p) = ErrVal;
-    return;
-  };
-  if (*(--p) == ErrVal || fabsl(*p) > inveps) {
-    *p = ErrVal;
-    return;
-  };
-  *p = (*p || *(p + 1) ? atan2(*p, *(p + 1)) : ErrVal);
+  if (v2 == ErrVal || fabsl(v2) > inveps || v1 == ErrVal || fabsl(v1) > inveps)
+    return ErrVal;
+  return (v1 || v2 ? atan2(v1, v2) : ErrVal);
 }
-void NextVal(double*&)
+// min, max, floor, heaviside and if only select or round their arguments and are written as selections without
+// branches, so that the loops of the batched RProgram::Val() over them are vectorized
+static inline double MinimumVal(double v1, double v2)
 {
+  return ((v1 == ErrVal || v2 == ErrVal) ? ErrVal : (v2 < v1 ? v2 : v1));
 }
-void RFunc(double*&)
+static inline double MaximumVal(double v1, double v2)
 {
+  return ((v1 == ErrVal || v2 == ErrVal) ? ErrVal : (v2 > v1 ? v2 : v1));
 }
-void JuxtF(double*&)
+static inline double PartieEntiereVal(double v)
 {
+  return ((v == ErrVal) ? ErrVal : floor(v));
 }
-void Absolu(double*& p)
+static inline double HeavisideVal(double v)
 {
-  *p = ((*p == ErrVal) ? ErrVal : fabsl(*p));
+  return ((v == ErrVal) ? ErrVal : (v > 0 ? 1. : 0.));
 }
-void Oppose(double*& p)
+// a for c>0 and b otherwise, the value not selected may be ErrVal
+static inline double ConditionVal(double c, double a, double b)
 {
-  *p = ((*p == ErrVal) ? ErrVal : -*p);
+  return ((c == ErrVal) ? ErrVal : (c > 0 ? a : b));
 }
-void ArcSinus(double*& p)
+static inline double AbsoluVal(double v)
 {
-  *p = ((*p == ErrVal || fabsl(*p) > 1) ? ErrVal : asinl(*p));
+  return ((v == ErrVal) ? ErrVal : fabsl(v));
 }
-void ArcCosinus(double*& p)
+static inline double OpposeVal(double v)
 {
-  *p = ((*p == ErrVal || fabsl(*p) > 1) ? ErrVal : acosl(*p));
+  return ((v == ErrVal) ? ErrVal : -v);
 }
-void ArcTangente(double*& p)
+static inline double ArcSinusVal(double v)
 {
-  *p = ((*p == ErrVal) ? ErrVal : atanl(*p));
+  return ((v == ErrVal || fabsl(v) > 1) ? ErrVal : asinl(v));
 }
-void Logarithme(double*& p)
+static inline double ArcCosinusVal(double v)
 {
-  *p = ((*p == ErrVal || *p <= 0) ? ErrVal : logl(*p));
+  return ((v == ErrVal || fabsl(v) > 1) ? ErrVal : acosl(v));
 }
-void Exponentielle(double*& p)
+static inline double ArcTangenteVal(double v)
 {
-  *p = ((*p == ErrVal || *p > DBL_MAX_EXP) ? ErrVal : expl(*p));
+  return ((v == ErrVal) ? ErrVal : atanl(v));
 }
-void Sinus(double*& p)
+// ln, exp, sin and cos are computed by the kernels of vectormath.hh, which the batched RProgram::Val() evaluates at
+// a whole block of points at once, for the arguments where these functions are defined
+static inline bool LogarithmeDefined(double v)
 {
-  *p = ((*p == ErrVal || fabsl(*p) > inveps) ? ErrVal : sinl(*p));
+  return !(v == ErrVal || v <= 0);
 }
-void Tangente(double*& p)
+static inline bool ExponentielleDefined(double v)
 {
-  *p = ((*p == ErrVal || fabsl(*p) > inveps) ? ErrVal : tanl(*p));
+  return !(v == ErrVal || v > DBL_MAX_EXP);
 }
-void Cosinus(double*& p)
+static inline bool SinusDefined(double v)
 {
-  *p = ((*p == ErrVal || fabsl(*p) > inveps) ? ErrVal : cosl(*p));
+  return !(v == ErrVal || fabsl(v) > inveps);
 }
-void Racine(double*& p)
+static inline double LogarithmeVal(double v)
 {
-  *p = ((*p == ErrVal || *p > sqrtmaxfloat || *p < 0) ? ErrVal : sqrtl(*p));
+  return (LogarithmeDefined(v) ? KernelLog(v) : ErrVal);
 }
-void FonctionError(double*& p)
+static inline double ExponentielleVal(double v)
 {
-  *p = ErrVal;
+  return (ExponentielleDefined(v) ? KernelExp(v) : ErrVal);
 }
-inline void ApplyRFunc(PRFunction rf, double*& p)
+static inline double SinusVal(double v)
 {
-  p -= rf->nvars - 1;
-  *p = rf->Val(p);
+  return (SinusDefined(v) ? KernelSin(v) : ErrVal);
 }
-
-double ROperation::Val() const
+static inline double TangenteVal(double v)
 {
-  pfoncld* p1 = pinstr;
-  double **p2 = pvals, *p3 = ppile - 1;
-  PRFunction* p4 = pfuncpile;
-  for (; *p1 != NULL; p1++)
-    if (*p1 == &NextVal)
-      *(++p3) = **(p2++);
-    else if (*p1 == &RFunc)
-      ApplyRFunc(*(p4++), p3);
-    else
-      (**p1)(p3);
-  return *p3;
+  return ((v == ErrVal || fabsl(v) > inveps) ? ErrVal : tanl(v));
+}
+static inline double CosinusVal(double v)
+{
+  return (SinusDefined(v) ? KernelCos(v) : ErrVal);
+}
+static inline double RacineVal(double v)
+{
+  return ((v == ErrVal || v > sqrtmaxfloat || v < 0) ? ErrVal : sqrtl(v));
 }
 
-void BCDouble(pfoncld*& pf,
-              pfoncld* pf1,
-              pfoncld* pf2,
-              double**& pv,
-              double** pv1,
-              double** pv2,
-              double*& pp,
-              double* pp1,
-              double* pp2,
+void Addition(double*& p)
+{
+  --p;
+  *p = AdditionVal(*p, *(p + 1));
+}
+void Soustraction(double*& p)
+{
+  --p;
+  *p = SoustractionVal(*p, *(p + 1));
+}
+void Multiplication(double*& p)
+{
+  --p;
+  *p = MultiplicationVal(*p, *(p + 1));
+}
+void Division(double*& p)
+{
+  --p;
+  *p = DivisionVal(*p, *(p + 1));
+}
+void Puissance(double*& p)
+{
+  --p;
+  *p = PuissanceVal(*p, *(p + 1));
+}
+void RacineN(double*& p)
+{
+  --p;
+  *p = RacineNVal(*p, *(p + 1));
+}
+void Puiss10(double*& p)
+{
+  --p;
+  *p = Puiss10Val(*p, *(p + 1));
+}
+void ArcTangente2(double*& p)
+{
+  --p;
+  *p = ArcTangente2Val(*p, *(p + 1));
+}
+void Minimum(double*& p)
+{
+  --p;
+  *p = MinimumVal(*p, *(p + 1));
+}
+void Maximum(double*& p)
+{
+  --p;
+  *p = MaximumVal(*p, *(p + 1));
+}
+void Condition(double*& p)
+{
+  p -= 2;
+  *p = ConditionVal(*p, *(p + 1), *(p + 2));
+}
+void Encadrement(double*& p)
+{
+  p -= 2;
+  *p = MinimumVal(MaximumVal(*p, *(p + 1)), *(p + 2));
+}
+void NextVal(double*&)
+{
+}
+void RFunc(double*&)
+{
+}
+void JuxtF(double*&)
+{
+}
+void Absolu(double*& p)
+{
+  *p = AbsoluVal(*p);
+}
+void Oppose(double*& p)
+{
+  *p = OpposeVal(*p);
+}
+void ArcSinus(double*& p)
+{
+  *p = ArcSinusVal(*p);
+}
+void ArcCosinus(double*& p)
+{
+  *p = ArcCosinusVal(*p);
+}
+void ArcTangente(double*& p)
+{
+  *p = ArcTangenteVal(*p);
+}
+void Logarithme(double*& p)
+{
+  *p = LogarithmeVal(*p);
+}
+void Exponentielle(double*& p)
+{
+  *p = ExponentielleVal(*p);
+}
+void Sinus(double*& p)
+{
+  *p = SinusVal(*p);
+}
+void Tangente(double*& p)
+{
+  *p = TangenteVal(*p);
+}
+void Cosinus(double*& p)
+{
+  *p = CosinusVal(*p);
+}
+void Racine(double*& p)
+{
+  *p = RacineVal(*p);
+}
+void PartieEntiere(double*& p)
+{
+  *p = PartieEntiereVal(*p);
+}
+void Echelon(double*& p)
+{
+  *p = HeavisideVal(*p);
+}
+void FonctionError(double*& p)
+{
+  *p = ErrVal;
+}
+inline void ApplyRFunc(PRFunction rf, double*& p)
+{
+  p -= rf->nvars - 1;
+  *p = rf->Val(p);
+}
+
+// Opcodes of the code interpreted by ROperation::Val(), StepPush and StepFunc are followed by their operand
+enum RStepCode
+{
+  StepPush,
+  StepFunc,
+  StepAdd,
+  StepSub,
+  StepMult,
+  StepDiv,
+  StepPow,
+  StepNthRoot,
+  StepE10,
+  StepAtan2,
+  StepAbs,
+  StepOpp,
+  StepAsin,
+  StepAcos,
+  StepAtan,
+  StepLn,
+  StepExp,
+  StepSin,
+  StepTg,
+  StepCos,
+  StepSqrt,
+  StepMin,
+  StepMax,
+  StepFloor,
+  StepHeaviside,
+  StepIf,
+  StepClamp,
+  StepError,
+  StepEnd
+};
+
+static int StepCodeOf(pfoncld f)
+{
+  if (f == &Addition)
+    return StepAdd;
+  if (f == &Soustraction)
+    return StepSub;
+  if (f == &Multiplication)
+    return StepMult;
+  if (f == &Division)
+    return StepDiv;
+  if (f == &Puissance)
+    return StepPow;
+  if (f == &RacineN)
+    return StepNthRoot;
+  if (f == &Puiss10)
+    return StepE10;
+  if (f == &ArcTangente2)
+    return StepAtan2;
+  if (f == &Absolu)
+    return StepAbs;
+  if (f == &Oppose)
+    return StepOpp;
+  if (f == &ArcSinus)
+    return StepAsin;
+  if (f == &ArcCosinus)
+    return StepAcos;
+  if (f == &ArcTangente)
+    return StepAtan;
+  if (f == &Logarithme)
+    return StepLn;
+  if (f == &Exponentielle)
+    return StepExp;
+  if (f == &Sinus)
+    return StepSin;
+  if (f == &Tangente)
+    return StepTg;
+  if (f == &Cosinus)
+    return StepCos;
+  if (f == &Racine)
+    return StepSqrt;
+  if (f == &Minimum)
+    return StepMin;
+  if (f == &Maximum)
+    return StepMax;
+  if (f == &PartieEntiere)
+    return StepFloor;
+  if (f == &Echelon)
+    return StepHeaviside;
+  if (f == &Condition)
+    return StepIf;
+  if (f == &Encadrement)
+    return StepClamp;
+  return StepError;
+}
+
+double ROperation::Val() const
+{
+  double* p = ppile - 1;
+  for (const RStep* s = pcode;; s++)
+    switch (s->op) {
+      case StepPush:
+        *(++p) = *(++s)->pval;
+        break;
+      case StepFunc:
+        ApplyRFunc((++s)->pfunc, p);
+        break;
+      case StepAdd:
+        --p;
+        *p = AdditionVal(*p, *(p + 1));
+        break;
+      case StepSub:
+        --p;
+        *p = SoustractionVal(*p, *(p + 1));
+        break;
+      case StepMult:
+        --p;
+        *p = MultiplicationVal(*p, *(p + 1));
+        break;
+      case StepDiv:
+        --p;
+        *p = DivisionVal(*p, *(p + 1));
+        break;
+      case StepPow:
+        --p;
+        *p = PuissanceVal(*p, *(p + 1));
+        break;
+      case StepNthRoot:
+        --p;
+        *p = RacineNVal(*p, *(p + 1));
+        break;
+      case StepE10:
+        --p;
+        *p = Puiss10Val(*p, *(p + 1));
+        break;
+      case StepAtan2:
+        --p;
+        *p = ArcTangente2Val(*p, *(p + 1));
+        break;
+      case StepAbs:
+        *p = AbsoluVal(*p);
+        break;
+      case StepOpp:
+        *p = OpposeVal(*p);
+        break;
+      case StepAsin:
+        *p = ArcSinusVal(*p);
+        break;
+      case StepAcos:
+        *p = ArcCosinusVal(*p);
+        break;
+      case StepAtan:
+        *p = ArcTangenteVal(*p);
+        break;
+      case StepLn:
+        *p = LogarithmeVal(*p);
+        break;
+      case StepExp:
+        *p = ExponentielleVal(*p);
+        break;
+      case StepSin:
+        *p = SinusVal(*p);
+        break;
+      case StepTg:
+        *p = TangenteVal(*p);
+        break;
+      case StepCos:
+        *p = CosinusVal(*p);
+        break;
+      case StepSqrt:
+        *p = RacineVal(*p);
+        break;
+      case StepMin:
+        --p;
+        *p = MinimumVal(*p, *(p + 1));
+        break;
+      case StepMax:
+        --p;
+        *p = MaximumVal(*p, *(p + 1));
+        break;
+      case StepFloor:
+        *p = PartieEntiereVal(*p);
+        break;
+      case StepHeaviside:
+        *p = HeavisideVal(*p);
+        break;
+      case StepIf:
+        p -= 2;
+        *p = ConditionVal(*p, *(p + 1), *(p + 2));
+        break;
+      case StepClamp:
+        p -= 2;
+        *p = MinimumVal(MaximumVal(*p, *(p + 1)), *(p + 2));
+        break;
+      case StepError:
+        *p = ErrVal;
+        break;
+      default:
+        return *p;
+    }
+}
+
+double ROperation::ValThreaded() const
+{
+  pfoncld* p1 = pinstr;
+  double **p2 = pvals, *p3 = ppile - 1;
+  PRFunction* p4 = pfuncpile;
+  for (; *p1 != NULL; p1++)
+    if (*p1 == &NextVal)
+      *(++p3) = **(p2++);
+    else if (*p1 == &RFunc)
+      ApplyRFunc(*(p4++), p3);
+    else
+      (**p1)(p3);
+  return *p3;
+}
+
+void BCDouble(pfoncld*& pf,
+              pfoncld* pf1,
+              pfoncld* pf2,
+              double**& pv,
+              double** pv1,
+              double** pv2,
+              double*& pp,
+              double* pp1,
+              double* pp2,
               RFunction**& prf,
               RFunction** prf1,
               RFunction** prf2,
@@ -2361,8 +3218,1748 @@ void ROperation::BuildCode()
     case Fun:
       BCFun(pinstr, mmb2->pinstr, pvals, mmb2->pvals, ppile, mmb2->ppile, pfuncpile, mmb2->pfuncpile, pfunc);
       break;
+    case Min:
+    case Max:
+    case Floor:
+    case Heaviside:
+    case If:
+    case Clamp: {
+      // the stack functions take their arguments from the stack, which must hold as many of them
+      const pfoncld f = (NArguments(mmb2) != Arity(op)) ? &FonctionError
+                        : (op == Min) ? &Minimum
+                        : (op == Max) ? &Maximum
+                        : (op == Floor) ? &PartieEntiere
+                        : (op == Heaviside) ? &Echelon
+                        : (op == If) ? &Condition
+                        : &Encadrement;
+      BCSimple(pinstr, mmb2->pinstr, pvals, mmb2->pvals, ppile, mmb2->ppile, pfuncpile, mmb2->pfuncpile, f);
+      break;
+    }
     default:
       BCSimple(
           pinstr, mmb2->pinstr, pvals, mmb2->pvals, ppile, mmb2->ppile, pfuncpile, mmb2->pfuncpile, &FonctionError);
   }
+  BuildSteps();
+}
+
+// Translates pinstr, pvals and pfuncpile into pcode, the values to push and the functions to apply follow their
+// opcodes directly. JuxtF does nothing and is left out.
+void ROperation::BuildSteps()
+{
+  if (pcode != NULL) {
+    delete[] pcode;
+    pcode = NULL;
+  }
+  pfoncld* pf;
+  long n = 0;
+  for (pf = pinstr; *pf != NULL; pf++)
+    n += (*pf == &NextVal || *pf == &RFunc) ? 2 : 1;
+  pcode = new RStep[n + 1];
+  RStep* ps = pcode;
+  double** pv = pvals;
+  PRFunction* prf = pfuncpile;
+  for (pf = pinstr; *pf != NULL; pf++)
+    if (*pf == &NextVal) {
+      (ps++)->op = StepPush;
+      (ps++)->pval = *(pv++);
+    } else if (*pf == &RFunc) {
+      (ps++)->op = StepFunc;
+      (ps++)->pfunc = *(prf++);
+    } else if (*pf != &JuxtF)
+      (ps++)->op = StepCodeOf(*pf);
+  ps->op = StepEnd;
+}
+
+RProgram::RProgram()
+{
+  nvars = 0;
+  nouts = 0;
+  stacksize = 0;
+  ntemps = 0;
+}
+
+RProgram::RProgram(int nops, const ROperation* const* ppop, int nvar, const RVar* const* ppvar)
+{
+  nvars = nvar;
+  nouts = nops;
+  stacksize = 1;
+  ntemps = 0;
+  int i, depth;
+  for (i = 0; i < nops; i++) {
+    depth = 0;
+    Compile(*ppop[i], nvar, ppvar, depth);
+    Push(BCStore, i, depth);
+  }
+}
+
+int RProgram::NVars() const
+{
+  return nvars;
+}
+
+int RProgram::NOutputs() const
+{
+  return nouts;
+}
+
+int RProgram::NInstructions() const
+{
+  return (int)code.size();
+}
+
+int RProgram::StackSize() const
+{
+  return stacksize;
+}
+
+int RProgram::NTemporaries() const
+{
+  return ntemps;
+}
+
+const std::vector<RInstruction>& RProgram::Code() const
+{
+  return code;
+}
+
+const std::vector<double>& RProgram::Constants() const
+{
+  return consts;
+}
+
+int RProgram::NFunctions() const
+{
+  return (int)funcs.size();
+}
+
+size_t RProgram::WorkSize() const
+{
+  return (size_t)(stacksize + ntemps) * BlockSize;
+}
+
+void RProgram::Push(RCode c, int arg, int& depth)
+{
+  RInstruction instr;
+  instr.code = c;
+  instr.arg = arg;
+  code.push_back(instr);
+  switch (c) {
+    case BCNum:
+    case BCVar:
+    case BCLoad:
+      depth++;
+      break;
+    case BCAdd:
+    case BCSub:
+    case BCMult:
+    case BCDiv:
+    case BCPow:
+    case BCNthRoot:
+    case BCE10:
+    case BCAtan2:
+    case BCMin:
+    case BCMax:
+      depth--;
+      break;
+    case BCIf:
+      depth -= 2;
+      break;
+    case BCStore:
+      depth = 0;
+      break;
+    default:
+      break;
+  }
+  if (depth > stacksize)
+    stacksize = depth;
+}
+
+static RCode CodeOf(ROperator op)
+{
+  switch (op) {
+    case Add:
+      return BCAdd;
+    case Sub:
+      return BCSub;
+    case Mult:
+      return BCMult;
+    case Div:
+      return BCDiv;
+    case Pow:
+      return BCPow;
+    case NthRoot:
+      return BCNthRoot;
+    case E10:
+      return BCE10;
+    case Opp:
+      return BCOpp;
+    case Abs:
+      return BCAbs;
+    case Sqrt:
+      return BCSqrt;
+    case Sin:
+      return BCSin;
+    case Cos:
+      return BCCos;
+    case Tg:
+      return BCTg;
+    case Ln:
+      return BCLn;
+    case Exp:
+      return BCExp;
+    case Acos:
+      return BCAcos;
+    case Asin:
+      return BCAsin;
+    case Min:
+      return BCMin;
+    case Max:
+      return BCMax;
+    case Floor:
+      return BCFloor;
+    case Heaviside:
+      return BCHeaviside;
+    case If:
+      return BCIf;
+    default:
+      return BCError;
+  }
 }
+
+// Emits the instructions leaving the same values on the stack as the code built by ROperation::BuildCode()
+void RProgram::Compile(const ROperation& rop, int nvar, const RVar* const* ppvar, int& depth)
+{
+  int i;
+  switch (rop.op) {
+    case Num:
+      consts.push_back(rop.ValC);
+      Push(BCNum, (int)consts.size() - 1, depth);
+      return;
+    case Var:
+      for (i = 0; i < nvar; i++)
+        if (rop.pvarval == ppvar[i]->pval) {
+          Push(BCVar, i, depth);
+          return;
+        }
+      // unknown variables evaluate to an error, as they do not have a slot in vars
+      consts.push_back(ErrVal);
+      Push(BCNum, (int)consts.size() - 1, depth);
+      return;
+    case Juxt:
+      Compile(*rop.mmb1, nvar, ppvar, depth);
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      return;
+    case Add:
+    case Sub:
+    case Mult:
+    case Div:
+    case Pow:
+    case NthRoot:
+    case E10:
+      Compile(*rop.mmb1, nvar, ppvar, depth);
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      Push(CodeOf(rop.op), 0, depth);
+      return;
+    case Opp:
+    case Abs:
+    case Sqrt:
+    case Sin:
+    case Cos:
+    case Tg:
+    case Ln:
+    case Exp:
+    case Acos:
+    case Asin:
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      Push(CodeOf(rop.op), 0, depth);
+      return;
+    case Atan:
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      Push(rop.mmb2->NMembers() > 1 ? BCAtan2 : BCAtan, 0, depth);
+      return;
+    case Min:
+    case Max:
+    case Floor:
+    case Heaviside:
+    case If:
+      if (NArguments(rop.mmb2) != Arity(rop.op))
+        break;
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      Push(CodeOf(rop.op), 0, depth);
+      return;
+    case Clamp: {
+      // min(max(x,lo),hi), as computed by Encadrement()
+      const ROperation* args[3];
+      if (Arguments(rop.mmb2, args, 3) != 3)
+        break;
+      Compile(*args[0], nvar, ppvar, depth);
+      Compile(*args[1], nvar, ppvar, depth);
+      Push(BCMax, 0, depth);
+      Compile(*args[2], nvar, ppvar, depth);
+      Push(BCMin, 0, depth);
+      return;
+    }
+    case Fun:
+      if (rop.pfunc->type == 1) {
+        // inline the function, as done by ROperation::Diff()
+        ROperation body = rop.pfunc->op;
+        for (i = 0; i < rop.pfunc->nvars; i++)
+          body = body.Substitute(*rop.pfunc->ppvar[i], rop.mmb2->NthMember(i + 1));
+        Compile(body, nvar, ppvar, depth);
+        return;
+      }
+      Compile(*rop.mmb2, nvar, ppvar, depth);
+      if (rop.pfunc->type == 0) {
+        funcs.push_back(rop.pfunc->pfuncval);
+        Push(BCCall, (int)funcs.size() - 1, depth);
+      } else {
+        consts.push_back(ErrVal);
+        Push(BCNum, (int)consts.size() - 1, depth);
+      }
+      return;
+    case ErrOp:
+      consts.push_back(ErrVal);
+      Push(BCNum, (int)consts.size() - 1, depth);
+      return;
+    default:
+      break;
+  }
+  Compile(*rop.mmb2, nvar, ppvar, depth);
+  Push(BCError, 0, depth);
+}
+
+void RProgram::Val(const double* vars, double* out) const
+{
+  double buf[64];
+  std::vector<double> heapbuf;
+  double* pile = buf;
+  if (stacksize + ntemps > 64) {
+    heapbuf.resize(stacksize + ntemps);
+    pile = heapbuf.data();
+  }
+  double* temps = pile + stacksize;
+  double* p = pile - 1;
+  const RInstruction* pi = code.data();
+  const RInstruction* pe = pi + code.size();
+  for (; pi != pe; pi++)
+    switch (pi->code) {
+      case BCNum:
+        *(++p) = consts[pi->arg];
+        break;
+      case BCVar:
+        *(++p) = vars[pi->arg];
+        break;
+      case BCAdd:
+        Addition(p);
+        break;
+      case BCSub:
+        Soustraction(p);
+        break;
+      case BCMult:
+        Multiplication(p);
+        break;
+      case BCDiv:
+        Division(p);
+        break;
+      case BCPow:
+        Puissance(p);
+        break;
+      case BCNthRoot:
+        RacineN(p);
+        break;
+      case BCE10:
+        Puiss10(p);
+        break;
+      case BCAtan2:
+        ArcTangente2(p);
+        break;
+      case BCMin:
+        Minimum(p);
+        break;
+      case BCMax:
+        Maximum(p);
+        break;
+      case BCOpp:
+        *p = OpposeVal(*p);
+        break;
+      case BCAbs:
+        *p = AbsoluVal(*p);
+        break;
+      case BCSqrt:
+        *p = RacineVal(*p);
+        break;
+      case BCSin:
+        *p = SinusVal(*p);
+        break;
+      case BCCos:
+        *p = CosinusVal(*p);
+        break;
+      case BCTg:
+        *p = TangenteVal(*p);
+        break;
+      case BCLn:
+        *p = LogarithmeVal(*p);
+        break;
+      case BCExp:
+        *p = ExponentielleVal(*p);
+        break;
+      case BCAcos:
+        *p = ArcCosinusVal(*p);
+        break;
+      case BCAsin:
+        *p = ArcSinusVal(*p);
+        break;
+      case BCAtan:
+        *p = ArcTangenteVal(*p);
+        break;
+      case BCFloor:
+        *p = PartieEntiereVal(*p);
+        break;
+      case BCHeaviside:
+        *p = HeavisideVal(*p);
+        break;
+      case BCIf:
+        Condition(p);
+        break;
+      case BCError:
+        *p = ErrVal;
+        break;
+      case BCCall:
+        *p = (*funcs[pi->arg])(*p);
+        break;
+      case BCStore:
+        out[pi->arg] = *p;
+        p = pile - 1;
+        break;
+      case BCKeep:
+        temps[pi->arg] = *p;
+        break;
+      case BCLoad:
+        *(++p) = temps[pi->arg];
+        break;
+    }
+}
+
+void RProgram::Val(const double* const* vars, double* out, size_t npoints) const
+{
+  std::vector<double> work(WorkSize());
+  Val(vars, out, npoints, work.data());
+}
+
+// The batched interpreter keeps the i-th stack entry of all points of a block in work[i*BlockSize...]
+template <double (*f)(double, double)>
+static inline void BlockBinary(double*& p, int n)
+{
+  double* p1 = p - RProgram::BlockSize;
+  for (int j = 0; j < n; j++)
+    p1[j] = f(p1[j], p[j]);
+  p = p1;
+}
+
+template <double (*f)(double, double, double)>
+static inline void BlockTernary(double*& p, int n)
+{
+  double* p1 = p - 2 * RProgram::BlockSize;
+  const double* p2 = p - RProgram::BlockSize;
+  for (int j = 0; j < n; j++)
+    p1[j] = f(p1[j], p2[j], p[j]);
+  p = p1;
+}
+
+template <double (*f)(double)>
+static inline void BlockUnary(double* p, int n)
+{
+  for (int j = 0; j < n; j++)
+    p[j] = f(p[j]);
+}
+
+// Same as BlockUnary<f>, f(v) being kernel(v) if defined(v) and ErrVal otherwise
+template <void (*kernel)(const double*, double*, int), bool (*defined)(double)>
+static inline void BlockKernel(double* p, int n)
+{
+  double y[RProgram::BlockSize];
+  kernel(p, y, n);
+  for (int j = 0; j < n; j++)
+    p[j] = (defined(p[j]) ? y[j] : ErrVal);
+}
+
+void RProgram::Val(const double* const* vars, double* out, size_t npoints, double* work) const
+{
+  const RInstruction* pb = code.data();
+  const RInstruction* pe = pb + code.size();
+  double* temps = work + (size_t)stacksize * BlockSize;
+  size_t first;
+  int j, n;
+  for (first = 0; first < npoints; first += BlockSize) {
+    n = (npoints - first < (size_t)BlockSize) ? (int)(npoints - first) : BlockSize;
+    double* p = work - BlockSize;
+    for (const RInstruction* pi = pb; pi != pe; pi++)
+      switch (pi->code) {
+        case BCNum: {
+          const double v = consts[pi->arg];
+          p += BlockSize;
+          for (j = 0; j < n; j++)
+            p[j] = v;
+          break;
+        }
+        case BCVar: {
+          const double* v = vars[pi->arg] + first;
+          p += BlockSize;
+          for (j = 0; j < n; j++)
+            p[j] = v[j];
+          break;
+        }
+        case BCAdd:
+          BlockBinary<&AdditionVal>(p, n);
+          break;
+        case BCSub:
+          BlockBinary<&SoustractionVal>(p, n);
+          break;
+        case BCMult:
+          BlockBinary<&MultiplicationVal>(p, n);
+          break;
+        case BCDiv:
+          BlockBinary<&DivisionVal>(p, n);
+          break;
+        case BCPow:
+          BlockBinary<&PuissanceVal>(p, n);
+          break;
+        case BCNthRoot:
+          BlockBinary<&RacineNVal>(p, n);
+          break;
+        case BCE10:
+          BlockBinary<&Puiss10Val>(p, n);
+          break;
+        case BCAtan2:
+          BlockBinary<&ArcTangente2Val>(p, n);
+          break;
+        case BCMin:
+          BlockBinary<&MinimumVal>(p, n);
+          break;
+        case BCMax:
+          BlockBinary<&MaximumVal>(p, n);
+          break;
+        case BCOpp:
+          BlockUnary<&OpposeVal>(p, n);
+          break;
+        case BCAbs:
+          BlockUnary<&AbsoluVal>(p, n);
+          break;
+        case BCSqrt:
+          BlockUnary<&RacineVal>(p, n);
+          break;
+        case BCSin:
+          BlockKernel<&KernelSin, &SinusDefined>(p, n);
+          break;
+        case BCCos:
+          BlockKernel<&KernelCos, &SinusDefined>(p, n);
+          break;
+        case BCTg:
+          BlockUnary<&TangenteVal>(p, n);
+          break;
+        case BCLn:
+          BlockKernel<&KernelLog, &LogarithmeDefined>(p, n);
+          break;
+        case BCExp:
+          BlockKernel<&KernelExp, &ExponentielleDefined>(p, n);
+          break;
+        case BCAcos:
+          BlockUnary<&ArcCosinusVal>(p, n);
+          break;
+        case BCAsin:
+          BlockUnary<&ArcSinusVal>(p, n);
+          break;
+        case BCAtan:
+          BlockUnary<&ArcTangenteVal>(p, n);
+          break;
+        case BCFloor:
+          BlockUnary<&PartieEntiereVal>(p, n);
+          break;
+        case BCHeaviside:
+          BlockUnary<&HeavisideVal>(p, n);
+          break;
+        case BCIf:
+          BlockTernary<&ConditionVal>(p, n);
+          break;
+        case BCError:
+          for (j = 0; j < n; j++)
+            p[j] = ErrVal;
+          break;
+        case BCCall: {
+          double (*f)(double) = funcs[pi->arg];
+          for (j = 0; j < n; j++)
+            p[j] = (*f)(p[j]);
+          break;
+        }
+        case BCStore: {
+          double* o = out + (size_t)pi->arg * npoints + first;
+          for (j = 0; j < n; j++)
+            o[j] = p[j];
+          p = work - BlockSize;
+          break;
+        }
+        case BCKeep: {
+          double* t = temps + (size_t)pi->arg * BlockSize;
+          for (j = 0; j < n; j++)
+            t[j] = p[j];
+          break;
+        }
+        case BCLoad: {
+          const double* t = temps + (size_t)pi->arg * BlockSize;
+          p += BlockSize;
+          for (j = 0; j < n; j++)
+            p[j] = t[j];
+          break;
+        }
+      }
+  }
+}
+
+// Interval arithmetic for RProgram::Bounds(). An interval [lo, hi] encloses all values an instruction may produce,
+// the unbounded interval [-HUGE_VAL, HUGE_VAL] also stands for ErrVal.
+
+struct RInterval
+{
+  double lo, hi;
+};
+
+static const RInterval Unbounded = {-HUGE_VAL, HUGE_VAL};
+
+static inline RInterval MakeInterval(double lo, double hi, int ulps)
+{
+  RInterval r = {lo, hi};
+  if (lo != lo || hi != hi)
+    return Unbounded;
+  // the results of libm functions are not correctly rounded, but within one ulp
+  for (; ulps > 0; ulps--) {
+    r.lo = nextafter(r.lo, -HUGE_VAL);
+    r.hi = nextafter(r.hi, HUGE_VAL);
+  }
+  return r;
+}
+
+static inline signed char IsPoint(const RInterval& a)
+{
+  return (a.lo == a.hi);
+}
+
+static inline signed char IsUnbounded(const RInterval& a)
+{
+  return (a.lo < -sqrtmaxfloat || a.hi > sqrtmaxfloat);
+}
+
+// Whether a contains a number which the ...Val() functions treat as zero
+static inline signed char ContainsTiny(const RInterval& a)
+{
+  return (a.lo < sqrtminfloat && a.hi > -sqrtminfloat);
+}
+
+static inline RInterval PointInterval(double v)
+{
+  RInterval r = {v, v};
+  return (v == ErrVal ? Unbounded : r);
+}
+
+static inline RInterval Hull(const RInterval& a, double v)
+{
+  RInterval r = {(v < a.lo ? v : a.lo), (v > a.hi ? v : a.hi)};
+  return r;
+}
+
+static inline RInterval Hull4(double v1, double v2, double v3, double v4)
+{
+  RInterval r = {v1, v1};
+  return Hull(Hull(Hull(r, v2), v3), v4);
+}
+
+static RInterval AdditionInterval(const RInterval& a, const RInterval& b)
+{
+  if (IsUnbounded(a) || IsUnbounded(b))
+    return Unbounded;
+  return MakeInterval(a.lo + b.lo, a.hi + b.hi, 1);
+}
+
+static RInterval SoustractionInterval(const RInterval& a, const RInterval& b)
+{
+  if (IsUnbounded(a) || IsUnbounded(b))
+    return Unbounded;
+  return MakeInterval(a.lo - b.hi, a.hi - b.lo, 1);
+}
+
+static RInterval MultiplicationInterval(const RInterval& a, const RInterval& b)
+{
+  if (IsPoint(b) && fabsl(b.lo) < sqrtminfloat)
+    return PointInterval(0);
+  if (IsUnbounded(a) || IsUnbounded(b))
+    return Unbounded;
+  RInterval r = Hull4(a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi);
+  r = MakeInterval(r.lo, r.hi, 1);
+  return ((ContainsTiny(a) || ContainsTiny(b)) ? Hull(r, 0) : r);
+}
+
+static RInterval DivisionInterval(const RInterval& a, const RInterval& b)
+{
+  if (IsUnbounded(a) || IsUnbounded(b) || ContainsTiny(b))
+    return Unbounded;
+  RInterval r = Hull4(a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi);
+  r = MakeInterval(r.lo, r.hi, 1);
+  return (ContainsTiny(a) ? Hull(r, 0) : r);
+}
+
+static RInterval PuissanceInterval(const RInterval& a, const RInterval& b)
+{
+  if (IsPoint(a) && IsPoint(b))
+    return PointInterval(PuissanceVal(a.lo, b.lo));
+  if (IsUnbounded(a) || IsUnbounded(b))
+    return Unbounded;
+  RInterval r;
+  if (IsPoint(b) && !fmodl(b.lo, 1)) {
+    // integer exponent, PuissanceVal() returns 0 for a zero base
+    const double n = b.lo;
+    const signed char containszero = (a.lo <= 0 && a.hi >= 0);
+    if (containszero && n < 0)
+      return Unbounded;
+    const double vlo = powl(a.lo, n), vhi = powl(a.hi, n);
+    r.lo = (vlo < vhi ? vlo : vhi);
+    r.hi = (vlo < vhi ? vhi : vlo);
+    if (containszero && !fmodl(n, 2)) {
+      r.lo = 0;
+      if (!n)
+        r.hi = 1;
+    }
+  } else if (a.lo > 0) {
+    // a^b = exp(b*log(a)) is monotone in both arguments for a fixed sign of b and of log(a)
+    r = Hull4(powl(a.lo, b.lo), powl(a.lo, b.hi), powl(a.hi, b.lo), powl(a.hi, b.hi));
+  } else
+    return Unbounded;
+  if (fabsl(r.lo) > sqrtmaxfloat || fabsl(r.hi) > sqrtmaxfloat)
+    return Unbounded;
+  r = MakeInterval(r.lo, r.hi, 2);
+  return ((a.lo <= 0 && a.hi >= 0) ? Hull(r, 0) : r);
+}
+
+static RInterval ArcTangente2Interval(const RInterval& a, const RInterval& b)
+{
+  if (IsPoint(a) && IsPoint(b))
+    return PointInterval(ArcTangente2Val(a.lo, b.lo));
+  if (a.lo < -inveps || a.hi > inveps || b.lo < -inveps || b.hi > inveps)
+    return Unbounded;
+  // atan2(0, 0) is ErrVal
+  if (a.lo <= 0 && a.hi >= 0 && b.lo <= 0 && b.hi >= 0)
+    return Unbounded;
+  // the values jump at the negative x axis, elsewhere the extreme angles are attained at the corners
+  if (a.lo <= 0 && a.hi >= 0 && b.lo < 0)
+    return MakeInterval(-M_PI, M_PI, 2);
+  const RInterval r = Hull4(atan2(a.lo, b.lo), atan2(a.lo, b.hi), atan2(a.hi, b.lo), atan2(a.hi, b.hi));
+  return MakeInterval(r.lo, r.hi, 2);
+}
+
+// Whether ErrVal may be one of the values, in which case min, max, floor, heaviside and if return ErrVal, which only
+// the unbounded interval stands for
+static inline signed char MayBeError(const RInterval& a)
+{
+  return (a.hi >= ErrVal);
+}
+
+static RInterval MinimumInterval(const RInterval& a, const RInterval& b)
+{
+  if (MayBeError(a) || MayBeError(b))
+    return Unbounded;
+  RInterval r = {(b.lo < a.lo ? b.lo : a.lo), (b.hi < a.hi ? b.hi : a.hi)};
+  return r;
+}
+
+static RInterval MaximumInterval(const RInterval& a, const RInterval& b)
+{
+  if (MayBeError(a) || MayBeError(b))
+    return Unbounded;
+  RInterval r = {(b.lo > a.lo ? b.lo : a.lo), (b.hi > a.hi ? b.hi : a.hi)};
+  return r;
+}
+
+static RInterval ConditionInterval(const RInterval& c, const RInterval& a, const RInterval& b)
+{
+  if (MayBeError(c))
+    return Unbounded;
+  if (c.lo > 0)
+    return a;
+  if (c.hi <= 0)
+    return b;
+  return Hull(Hull(a, b.lo), b.hi);
+}
+
+static RInterval AbsoluInterval(const RInterval& a)
+{
+  if (IsUnbounded(a))
+    return Unbounded;
+  if (a.lo >= 0)
+    return a;
+  if (a.hi <= 0)
+    return MakeInterval(-a.hi, -a.lo, 0);
+  return MakeInterval(0, (-a.lo > a.hi ? -a.lo : a.hi), 0);
+}
+
+// Bounds x*x, which MultiplicationInterval() would treat like a product of two independent factors
+static RInterval SquareInterval(const RInterval& a)
+{
+  if (IsUnbounded(a))
+    return Unbounded;
+  const RInterval m = AbsoluInterval(a);
+  RInterval r = MakeInterval(m.lo * m.lo, m.hi * m.hi, 1);
+  if (r.lo < 0)
+    r.lo = 0;
+  return (ContainsTiny(a) ? Hull(r, 0) : r);
+}
+
+static RInterval MonotoneInterval(const RInterval& a, double (*f)(double), signed char increasing)
+{
+  const double vlo = (*f)(a.lo), vhi = (*f)(a.hi);
+  if (vlo == ErrVal || vhi == ErrVal)
+    return Unbounded;
+  return (increasing ? MakeInterval(vlo, vhi, 2) : MakeInterval(vhi, vlo, 2));
+}
+
+// Whether the interval contains one of the points offset + k*period, in doubt it does
+static signed char ContainsPeriodic(const RInterval& a, double offset, double period)
+{
+  const double tol = 8 * DBL_EPSILON * (fabsl(a.lo) + fabsl(a.hi) + 1);
+  const double k = ceil((a.lo - tol - offset) / period);
+  return (offset + k * period <= a.hi + tol);
+}
+
+static RInterval SinusCosinusInterval(const RInterval& a, double (*f)(double), double maxoffset)
+{
+  if (IsPoint(a))
+    return PointInterval((*f)(a.lo));
+  if (a.lo < -inveps || a.hi > inveps)
+    return Unbounded;
+  if (a.hi - a.lo >= 2 * M_PI)
+    return MakeInterval(-1, 1, 0);
+  const double vlo = (*f)(a.lo), vhi = (*f)(a.hi);
+  // the kernels of sin and cos are within one ulp of libm, as those of the monotone functions above
+  RInterval r = MakeInterval((vlo < vhi ? vlo : vhi), (vlo < vhi ? vhi : vlo), 2);
+  if (ContainsPeriodic(a, maxoffset, 2 * M_PI))
+    r.hi = 1;
+  if (ContainsPeriodic(a, maxoffset + M_PI, 2 * M_PI))
+    r.lo = -1;
+  if (r.lo < -1)
+    r.lo = -1;
+  if (r.hi > 1)
+    r.hi = 1;
+  return r;
+}
+
+static RInterval TangenteInterval(const RInterval& a)
+{
+  if (IsPoint(a))
+    return PointInterval(TangenteVal(a.lo));
+  if (a.lo < -inveps || a.hi > inveps || a.hi - a.lo >= M_PI || ContainsPeriodic(a, M_PI_2, M_PI))
+    return Unbounded;
+  return MonotoneInterval(a, &TangenteVal, 1);
+}
+
+static RInterval UnaryInterval(RCode c, const RInterval& a)
+{
+  switch (c) {
+    case BCOpp:
+      return MakeInterval(-a.hi, -a.lo, 0);
+    case BCAbs:
+      return AbsoluInterval(a);
+    case BCSqrt:
+      return ((a.lo < 0 || a.hi > sqrtmaxfloat) ? Unbounded : MonotoneInterval(a, &RacineVal, 1));
+    case BCSin:
+      return SinusCosinusInterval(a, &SinusVal, M_PI_2);
+    case BCCos:
+      return SinusCosinusInterval(a, &CosinusVal, 0);
+    case BCTg:
+      return TangenteInterval(a);
+    case BCLn:
+      return ((a.lo <= 0 || IsUnbounded(a)) ? Unbounded : MonotoneInterval(a, &LogarithmeVal, 1));
+    case BCExp: {
+      if (a.lo == -HUGE_VAL || a.hi > DBL_MAX_EXP)
+        return Unbounded;
+      RInterval r = MonotoneInterval(a, &ExponentielleVal, 1);
+      if (r.lo < 0)
+        r.lo = 0;
+      return r;
+    }
+    case BCAcos:
+      return ((a.lo < -1 || a.hi > 1) ? Unbounded : MonotoneInterval(a, &ArcCosinusVal, 0));
+    case BCAsin:
+      return ((a.lo < -1 || a.hi > 1) ? Unbounded : MonotoneInterval(a, &ArcSinusVal, 1));
+    case BCAtan:
+      return (IsUnbounded(a) ? Unbounded : MonotoneInterval(a, &ArcTangenteVal, 1));
+    case BCFloor:
+      return (MayBeError(a) ? Unbounded : MakeInterval(floor(a.lo), floor(a.hi), 0));
+    case BCHeaviside:
+      return (MayBeError(a) ? Unbounded : MakeInterval(HeavisideVal(a.lo), HeavisideVal(a.hi), 0));
+    default:
+      return Unbounded;
+  }
+}
+
+void RProgram::Bounds(const double* lower, const double* upper, double* outlower, double* outupper) const
+{
+  std::vector<RInterval> pile(stacksize + ntemps);
+  RInterval* temps = pile.data() + stacksize;
+  RInterval* p = pile.data() - 1;
+  // origins[k] identifies the value at pile[k] if it is a variable (its index) or a temporary (nvars + its index),
+  // so that products of a value with itself can be recognized
+  std::vector<int> origins(stacksize, -1);
+  const RInstruction* pi = code.data();
+  const RInstruction* pe = pi + code.size();
+  for (; pi != pe; pi++) {
+    switch (pi->code) {
+      case BCNum:
+        *(++p) = PointInterval(consts[pi->arg]);
+        break;
+      case BCVar:
+        ++p;
+        p->lo = lower[pi->arg];
+        p->hi = upper[pi->arg];
+        origins[p - pile.data()] = pi->arg;
+        continue;
+      case BCAdd:
+        --p;
+        *p = AdditionInterval(*p, *(p + 1));
+        break;
+      case BCSub:
+        --p;
+        *p = SoustractionInterval(*p, *(p + 1));
+        break;
+      case BCMult:
+        --p;
+        if (origins[p - pile.data()] >= 0 && origins[p - pile.data()] == origins[p - pile.data() + 1])
+          *p = SquareInterval(*p);
+        else
+          *p = MultiplicationInterval(*p, *(p + 1));
+        break;
+      case BCDiv:
+        --p;
+        *p = DivisionInterval(*p, *(p + 1));
+        break;
+      case BCPow:
+        --p;
+        *p = PuissanceInterval(*p, *(p + 1));
+        break;
+      case BCNthRoot:
+        --p;
+        *p = ((IsPoint(*p) && IsPoint(*(p + 1))) ? PointInterval(RacineNVal(p->lo, (p + 1)->lo)) : Unbounded);
+        break;
+      case BCE10:
+        --p;
+        *p = ((IsPoint(*p) && IsPoint(*(p + 1))) ? PointInterval(Puiss10Val(p->lo, (p + 1)->lo)) : Unbounded);
+        break;
+      case BCAtan2:
+        --p;
+        *p = ArcTangente2Interval(*p, *(p + 1));
+        break;
+      case BCMin:
+        --p;
+        *p = MinimumInterval(*p, *(p + 1));
+        break;
+      case BCMax:
+        --p;
+        *p = MaximumInterval(*p, *(p + 1));
+        break;
+      case BCIf:
+        p -= 2;
+        *p = ConditionInterval(*p, *(p + 1), *(p + 2));
+        break;
+      case BCError:
+        *p = Unbounded;
+        break;
+      case BCCall:
+        *p = (IsPoint(*p) ? PointInterval((*funcs[pi->arg])(p->lo)) : Unbounded);
+        break;
+      case BCStore:
+        outlower[pi->arg] = p->lo;
+        outupper[pi->arg] = p->hi;
+        p = pile.data() - 1;
+        continue;
+      case BCKeep:
+        temps[pi->arg] = *p;
+        origins[p - pile.data()] = nvars + pi->arg;
+        continue;
+      case BCLoad:
+        *(++p) = temps[pi->arg];
+        origins[p - pile.data()] = nvars + pi->arg;
+        continue;
+      default:
+        *p = UnaryInterval(pi->code, *p);
+    }
+    origins[p - pile.data()] = -1;
+  }
+}
+
+static double BinaryVal(RCode c, double v1, double v2)
+{
+  switch (c) {
+    case BCAdd:
+      return AdditionVal(v1, v2);
+    case BCSub:
+      return SoustractionVal(v1, v2);
+    case BCMult:
+      return MultiplicationVal(v1, v2);
+    case BCDiv:
+      return DivisionVal(v1, v2);
+    case BCPow:
+      return PuissanceVal(v1, v2);
+    case BCNthRoot:
+      return RacineNVal(v1, v2);
+    case BCE10:
+      return Puiss10Val(v1, v2);
+    case BCAtan2:
+      return ArcTangente2Val(v1, v2);
+    case BCMin:
+      return MinimumVal(v1, v2);
+    case BCMax:
+      return MaximumVal(v1, v2);
+    default:
+      return ErrVal;
+  }
+}
+
+static double UnaryVal(RCode c, double v)
+{
+  switch (c) {
+    case BCOpp:
+      return OpposeVal(v);
+    case BCAbs:
+      return AbsoluVal(v);
+    case BCSqrt:
+      return RacineVal(v);
+    case BCSin:
+      return SinusVal(v);
+    case BCCos:
+      return CosinusVal(v);
+    case BCTg:
+      return TangenteVal(v);
+    case BCLn:
+      return LogarithmeVal(v);
+    case BCExp:
+      return ExponentielleVal(v);
+    case BCAcos:
+      return ArcCosinusVal(v);
+    case BCAsin:
+      return ArcSinusVal(v);
+    case BCAtan:
+      return ArcTangenteVal(v);
+    case BCFloor:
+      return PartieEntiereVal(v);
+    case BCHeaviside:
+      return HeavisideVal(v);
+    default:
+      return ErrVal;
+  }
+}
+
+static bool IsBinary(RCode c)
+{
+  return c == BCAdd || c == BCSub || c == BCMult || c == BCDiv || c == BCPow || c == BCNthRoot || c == BCE10
+         || c == BCAtan2 || c == BCMin || c == BCMax;
+}
+
+static bool IsTernary(RCode c)
+{
+  return c == BCIf;
+}
+
+// Expression DAG used by RProgram::Optimize(), equal nodes are only stored once
+class RGraph
+{
+public:
+  struct Node
+  {
+    RCode code;
+    int arg; // variable or function index
+    double val; // value of BCNum nodes
+    int mmb1, mmb2, mmb3; // operands, -1 if unused
+  };
+
+  std::vector<Node> nodes;
+
+  int Num(double v)
+  {
+    return Find(BCNum, 0, v, -1, -1, -1);
+  }
+
+  int Var(int i)
+  {
+    return Find(BCVar, i, 0, -1, -1, -1);
+  }
+
+  int Unary(RCode c, int arg, int n1)
+  {
+    const Node& a = nodes[n1];
+    if (c == BCError)
+      return Num(ErrVal);
+    if (c != BCCall && a.code == BCNum)
+      return Num(UnaryVal(c, a.val));
+    if (c == BCOpp && a.code == BCOpp)
+      return a.mmb1;
+    return Find(c, arg, 0, n1, -1, -1);
+  }
+
+  int Binary(RCode c, int n1, int n2)
+  {
+    const Node a = nodes[n1], b = nodes[n2];
+    if (a.code == BCNum && b.code == BCNum)
+      return Num(BinaryVal(c, a.val, b.val));
+    const bool b0 = (b.code == BCNum && b.val == 0 && !signbit(b.val));
+    const bool b1 = (b.code == BCNum && b.val == 1);
+    switch (c) {
+      case BCAdd:
+        if (a.code == BCNum && a.val == 0 && !signbit(a.val))
+          return n2;
+        if (b0)
+          return n1;
+        // AdditionVal is symmetric
+        if (n2 < n1)
+          return Find(c, 0, 0, n2, n1, -1);
+        break;
+      case BCSub:
+        if (b0)
+          return n1;
+        break;
+      case BCMult:
+        if (b.code == BCNum && b.val == 0)
+          return Num(0);
+        if (b1 || (a.code == BCNum && a.val == 1))
+          return b1 ? n1 : n2;
+        break;
+      case BCDiv:
+        if (b1)
+          return n1;
+        break;
+      case BCPow:
+        if (b1)
+          return n1;
+        if (b.code == BCNum && b.val == 2)
+          return Binary(BCMult, n1, n1);
+        break;
+      case BCMin:
+      case BCMax:
+        if (n1 == n2)
+          return n1;
+        break;
+      default:
+        break;
+    }
+    return Find(c, 0, 0, n1, n2, -1);
+  } // ... Binary(...)
+
+  // BCIf, the only ternary instruction
+  int Ternary(RCode c, int n1, int n2, int n3)
+  {
+    const Node& a = nodes[n1];
+    if (a.code == BCNum)
+      return (a.val == ErrVal ? Num(ErrVal) : a.val > 0 ? n2 : n3);
+    if (n2 == n3)
+      return n2;
+    return Find(c, 0, 0, n1, n2, n3);
+  }
+
+private:
+  int Find(RCode c, int arg, double v, int n1, int n2, int n3)
+  {
+    unsigned long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    const auto key = std::make_tuple((int)c, arg, bits, n1, n2, n3);
+    const auto it = index.find(key);
+    if (it != index.end())
+      return it->second;
+    Node node;
+    node.code = c;
+    node.arg = arg;
+    node.val = v;
+    node.mmb1 = n1;
+    node.mmb2 = n2;
+    node.mmb3 = n3;
+    nodes.push_back(node);
+    index[key] = (int)nodes.size() - 1;
+    return (int)nodes.size() - 1;
+  }
+
+  std::map<std::tuple<int, int, unsigned long long, int, int, int>, int> index;
+}; // class RGraph
+
+// Emits the instructions computing node n, storing it in a temporary if it is used more than once
+static void EmitNode(const RGraph& g,
+                     int n,
+                     const std::vector<int>& uses,
+                     std::vector<int>& slots,
+                     std::map<unsigned long long, int>& constindex,
+                     std::vector<double>& consts,
+                     std::vector<RInstruction>& code,
+                     int& ntemps)
+{
+  RInstruction instr;
+  if (slots[n] >= 0) {
+    instr.code = BCLoad;
+    instr.arg = slots[n];
+    code.push_back(instr);
+    return;
+  }
+  const RGraph::Node& node = g.nodes[n];
+  instr.code = node.code;
+  instr.arg = node.arg;
+  if (node.code == BCNum) {
+    unsigned long long bits;
+    memcpy(&bits, &node.val, sizeof(bits));
+    const auto it = constindex.find(bits);
+    if (it == constindex.end()) {
+      consts.push_back(node.val);
+      instr.arg = constindex[bits] = (int)consts.size() - 1;
+    } else
+      instr.arg = it->second;
+    code.push_back(instr);
+    return;
+  }
+  if (node.mmb1 >= 0)
+    EmitNode(g, node.mmb1, uses, slots, constindex, consts, code, ntemps);
+  if (node.mmb2 >= 0)
+    EmitNode(g, node.mmb2, uses, slots, constindex, consts, code, ntemps);
+  if (node.mmb3 >= 0)
+    EmitNode(g, node.mmb3, uses, slots, constindex, consts, code, ntemps);
+  code.push_back(instr);
+  if (node.code != BCVar && uses[n] > 1) {
+    slots[n] = ntemps++;
+    instr.code = BCKeep;
+    instr.arg = slots[n];
+    code.push_back(instr);
+  }
+} // ... EmitNode(...)
+
+RProgram RProgram::Optimize() const
+{
+  std::vector<int> outputs(nouts);
+  for (int i = 0; i < nouts; i++)
+    outputs[i] = i;
+  return Rewrite(0, NULL, outputs);
+}
+
+RProgram RProgram::Bind(int n, const double* values) const
+{
+  std::vector<int> outputs(nouts);
+  for (int i = 0; i < nouts; i++)
+    outputs[i] = i;
+  return Rewrite(n, values, outputs);
+}
+
+RProgram RProgram::SelectOutputs(const std::vector<int>& outputs) const
+{
+  return Rewrite(0, NULL, outputs);
+}
+
+RProgram RProgram::Rewrite(int nbound, const double* values, const std::vector<int>& outputs) const
+{
+  RGraph g;
+  std::vector<int> pile, roots(nouts, -1), temps(ntemps, -1);
+  int n1, n2, n3;
+  for (const RInstruction& instr : code) {
+    switch (instr.code) {
+      case BCNum:
+        pile.push_back(g.Num(consts[instr.arg]));
+        break;
+      case BCVar:
+        if (instr.arg < nbound)
+          pile.push_back(g.Num(values[instr.arg]));
+        else
+          pile.push_back(g.Var(instr.arg - nbound));
+        break;
+      case BCStore:
+        roots[instr.arg] = pile.back();
+        pile.clear();
+        break;
+      case BCKeep:
+        temps[instr.arg] = pile.back();
+        break;
+      case BCLoad:
+        pile.push_back(temps[instr.arg]);
+        break;
+      default:
+        if (IsTernary(instr.code)) {
+          n3 = pile.back();
+          pile.pop_back();
+          n2 = pile.back();
+          pile.pop_back();
+          n1 = pile.back();
+          pile.pop_back();
+          pile.push_back(g.Ternary(instr.code, n1, n2, n3));
+        } else if (IsBinary(instr.code)) {
+          n2 = pile.back();
+          pile.pop_back();
+          n1 = pile.back();
+          pile.pop_back();
+          pile.push_back(g.Binary(instr.code, n1, n2));
+        } else {
+          n1 = pile.back();
+          pile.pop_back();
+          pile.push_back(g.Unary(instr.code, instr.arg, n1));
+        }
+    }
+  }
+  // count the uses of the nodes reachable from the outputs, nodes are created after their operands
+  std::vector<int> uses(g.nodes.size(), 0);
+  for (int k : outputs)
+    uses[roots[k]]++;
+  for (int n = (int)g.nodes.size() - 1; n >= 0; n--)
+    if (uses[n] > 0) {
+      if (g.nodes[n].mmb1 >= 0)
+        uses[g.nodes[n].mmb1]++;
+      if (g.nodes[n].mmb2 >= 0)
+        uses[g.nodes[n].mmb2]++;
+      if (g.nodes[n].mmb3 >= 0)
+        uses[g.nodes[n].mmb3]++;
+    }
+  RProgram result;
+  result.nvars = nvars > nbound ? nvars - nbound : 0;
+  result.nouts = (int)outputs.size();
+  result.funcs = funcs;
+  result.stacksize = 1;
+  std::vector<int> slots(g.nodes.size(), -1);
+  std::map<unsigned long long, int> constindex;
+  std::vector<RInstruction> emitted;
+  int i, depth;
+  for (i = 0; i < result.nouts; i++) {
+    emitted.clear();
+    EmitNode(g, roots[outputs[i]], uses, slots, constindex, result.consts, emitted, result.ntemps);
+    depth = 0;
+    for (const RInstruction& instr : emitted)
+      result.Push(instr.code, instr.arg, depth);
+    result.Push(BCStore, i, depth);
+  }
+  return result;
+} // ... Rewrite(...)
+
+// Degree of a value in RProgram::Degrees(), val is only meaningful for constants
+struct RDegree
+{
+  double deg, val;
+  signed char isconst, ispoly;
+};
+
+static RDegree Degree(double deg, signed char ispoly)
+{
+  RDegree r = {deg, 0, 0, ispoly};
+  return r;
+}
+
+static RDegree BinaryDegree(RCode c, const RDegree& a, const RDegree& b, double transcendental)
+{
+  if (a.isconst && b.isconst) {
+    RDegree r = {0, BinaryVal(c, a.val, b.val), 1, 1};
+    return r;
+  }
+  const signed char ispoly = (a.ispoly && b.ispoly);
+  switch (c) {
+    case BCAdd:
+    case BCSub:
+      return Degree((a.deg > b.deg ? a.deg : b.deg), ispoly);
+    case BCMult:
+      // MultiplicationVal() returns 0 for a zero factor
+      if ((a.isconst && !a.val) || (b.isconst && !b.val)) {
+        RDegree r = {0, 0, 1, 1};
+        return r;
+      }
+      return Degree(a.deg + b.deg, ispoly);
+    case BCDiv:
+      if (b.isconst)
+        return Degree(a.deg, ispoly);
+      return Degree(a.deg + transcendental * b.deg, 0);
+    case BCPow:
+      if (b.isconst && b.val >= 0 && !fmodl(b.val, 1))
+        return Degree(a.deg * b.val, ispoly);
+      break;
+    case BCMin:
+    case BCMax:
+      // piecewise a or b
+      return Degree((a.deg > b.deg ? a.deg : b.deg), 0);
+    default:
+      break;
+  }
+  return Degree(transcendental * (a.deg > b.deg ? a.deg : b.deg), 0);
+}
+
+// BCIf: piecewise a or b, the degree of the condition does not matter
+static RDegree ConditionDegree(const RDegree& c, const RDegree& a, const RDegree& b)
+{
+  if (c.isconst) {
+    if (c.val == ErrVal) {
+      RDegree r = {0, ErrVal, 1, 1};
+      return r;
+    }
+    return (c.val > 0 ? a : b);
+  }
+  return Degree((a.deg > b.deg ? a.deg : b.deg), 0);
+}
+
+static RDegree UnaryDegree(RCode c, const RDegree& a, double transcendental)
+{
+  // the values of the functions called by the program are not known here
+  if (c == BCCall)
+    return (a.isconst ? Degree(0, 1) : Degree(transcendental * a.deg, 0));
+  if (a.isconst) {
+    RDegree r = {0, UnaryVal(c, a.val), 1, 1};
+    return r;
+  }
+  if (c == BCOpp)
+    return a;
+  if (c == BCError) {
+    RDegree r = {0, ErrVal, 1, 1};
+    return r;
+  }
+  // piecewise constant
+  if (c == BCFloor || c == BCHeaviside)
+    return Degree(0, 0);
+  return Degree(transcendental * a.deg, 0);
+}
+
+bool RProgram::Degrees(int transcendental, int* out) const
+{
+  std::vector<RDegree> pile, temps(ntemps);
+  bool ispoly = true;
+  RDegree d;
+  for (const RInstruction& instr : code) {
+    switch (instr.code) {
+      case BCNum:
+        d.deg = 0;
+        d.val = consts[instr.arg];
+        d.isconst = d.ispoly = 1;
+        pile.push_back(d);
+        break;
+      case BCVar:
+        pile.push_back(Degree(1, 1));
+        break;
+      case BCStore:
+        out[instr.arg] = (pile.back().deg < INT_MAX ? (int)pile.back().deg : INT_MAX);
+        ispoly = ispoly && pile.back().ispoly;
+        pile.clear();
+        break;
+      case BCKeep:
+        temps[instr.arg] = pile.back();
+        break;
+      case BCLoad:
+        pile.push_back(temps[instr.arg]);
+        break;
+      default:
+        if (IsTernary(instr.code)) {
+          d = pile.back();
+          pile.pop_back();
+          const RDegree a = pile.back();
+          pile.pop_back();
+          pile.back() = ConditionDegree(pile.back(), a, d);
+        } else if (IsBinary(instr.code)) {
+          d = pile.back();
+          pile.pop_back();
+          pile.back() = BinaryDegree(instr.code, pile.back(), d, transcendental);
+        } else
+          pile.back() = UnaryDegree(instr.code, pile.back(), transcendental);
+    }
+  }
+  return ispoly;
+} // ... Degrees(...)
+
+// Partial derivatives of the result v = c(a) of a unary instruction, ErrVal where they are not defined
+static double UnaryPartial(RCode c, double a, double v)
+{
+  switch (c) {
+    case BCOpp:
+      return -1;
+    case BCAbs:
+      return DivisionVal(a, v);
+    case BCSqrt:
+      return DivisionVal(.5, v);
+    case BCSin:
+      return CosinusVal(a);
+    case BCCos:
+      return OpposeVal(SinusVal(a));
+    case BCTg:
+      return AdditionVal(1, MultiplicationVal(v, v));
+    case BCLn:
+      return DivisionVal(1, a);
+    case BCExp:
+      return v;
+    case BCAcos:
+      return DivisionVal(-1, RacineVal(SoustractionVal(1, MultiplicationVal(a, a))));
+    case BCAsin:
+      return DivisionVal(1, RacineVal(SoustractionVal(1, MultiplicationVal(a, a))));
+    case BCAtan:
+      return DivisionVal(1, AdditionVal(1, MultiplicationVal(a, a)));
+    case BCFloor:
+    case BCHeaviside:
+      return 0;
+    default:
+      return ErrVal;
+  }
+}
+
+// Same for v = c(a, b), pa and pb receive the derivatives w.r.t. a and b
+static void BinaryPartials(RCode c, double a, double b, double v, double& pa, double& pb)
+{
+  switch (c) {
+    case BCAdd:
+      pa = 1;
+      pb = 1;
+      break;
+    case BCSub:
+      pa = 1;
+      pb = -1;
+      break;
+    case BCMult:
+      pa = b;
+      pb = a;
+      break;
+    case BCDiv:
+      pa = DivisionVal(1, b);
+      pb = OpposeVal(DivisionVal(v, b));
+      break;
+    case BCPow:
+      pa = MultiplicationVal(b, PuissanceVal(a, SoustractionVal(b, 1)));
+      pb = MultiplicationVal(v, LogarithmeVal(a));
+      break;
+    case BCNthRoot: // v = b^(1/a)
+      pa = OpposeVal(DivisionVal(MultiplicationVal(v, LogarithmeVal(b)), MultiplicationVal(a, a)));
+      pb = DivisionVal(v, MultiplicationVal(a, b));
+      break;
+    case BCE10: // v = a*10^b
+      pa = Puiss10Val(1, b);
+      pb = MultiplicationVal(v, M_LN10);
+      break;
+    case BCAtan2: {
+      const double r = AdditionVal(MultiplicationVal(a, a), MultiplicationVal(b, b));
+      pa = DivisionVal(b, r);
+      pb = OpposeVal(DivisionVal(a, r));
+      break;
+    }
+    case BCMin:
+    case BCMax:
+      // the derivative of the selected operand
+      if (v == ErrVal)
+        pa = pb = ErrVal;
+      else {
+        pb = ((c == BCMin ? b < a : b > a) ? 1 : 0);
+        pa = 1 - pb;
+      }
+      break;
+    default:
+      pa = pb = ErrVal;
+  }
+}
+
+// Forward mode automatic differentiation: every entry of the stack and every temporary holds a value followed by its
+// derivatives w.r.t. all variables, which are combined by the chain rule. As in ROperation::Diff(), the derivative of
+// an operation with operands not depending on a variable is 0.
+void RProgram::ValDerivatives(const double* vars, double* out, double* derivatives) const
+{
+  ValDerivatives(vars, out, derivatives, 0, nvars);
+}
+
+void RProgram::ValDerivatives(const double* vars, double* out, double* derivatives, int first, int n) const
+{
+  const int stride = n + 1;
+  double buf[256];
+  std::vector<double> heapbuf;
+  double* pile = buf;
+  if ((size_t)(stacksize + ntemps) * stride > 256) {
+    heapbuf.resize((size_t)(stacksize + ntemps) * stride);
+    pile = heapbuf.data();
+  }
+  double* temps = pile + (size_t)stacksize * stride;
+  double* p = pile - stride;
+  double pa, pb;
+  int i;
+  const RInstruction* pi = code.data();
+  const RInstruction* pe = pi + code.size();
+  for (; pi != pe; pi++)
+    switch (pi->code) {
+      case BCNum:
+        p += stride;
+        p[0] = consts[pi->arg];
+        for (i = 1; i < stride; i++)
+          p[i] = 0;
+        break;
+      case BCVar:
+        p += stride;
+        p[0] = vars[pi->arg];
+        for (i = 1; i < stride; i++)
+          p[i] = 0;
+        if (pi->arg >= first && pi->arg < first + n)
+          p[pi->arg - first + 1] = 1;
+        break;
+      case BCStore:
+        out[pi->arg] = p[0];
+        for (i = 1; i < stride; i++)
+          derivatives[(size_t)pi->arg * n + i - 1] = p[i];
+        p = pile - stride;
+        break;
+      case BCKeep:
+        for (i = 0; i < stride; i++)
+          temps[(size_t)pi->arg * stride + i] = p[i];
+        break;
+      case BCLoad:
+        p += stride;
+        for (i = 0; i < stride; i++)
+          p[i] = temps[(size_t)pi->arg * stride + i];
+        break;
+      case BCError:
+        p[0] = ErrVal;
+        for (i = 1; i < stride; i++)
+          p[i] = ErrVal;
+        break;
+      case BCCall:
+        p[0] = (*funcs[pi->arg])(p[0]);
+        for (i = 1; i < stride; i++)
+          p[i] = (p[i] ? ErrVal : 0);
+        break;
+      default:
+        if (IsTernary(pi->code)) {
+          // the derivatives of the selected operand, ErrVal where an operand depends on the variable if c is ErrVal
+          double* const c = p - 2 * stride;
+          const double* const a = p - stride;
+          const double* const s = (c[0] == ErrVal ? NULL : c[0] > 0 ? a : p);
+          c[0] = ConditionVal(c[0], a[0], p[0]);
+          for (i = 1; i < stride; i++)
+            c[i] = (s != NULL ? s[i] : (c[i] || a[i] || p[i]) ? ErrVal : 0);
+          p = c;
+        } else if (IsBinary(pi->code)) {
+          double* const a = p - stride;
+          const double v = BinaryVal(pi->code, a[0], p[0]);
+          BinaryPartials(pi->code, a[0], p[0], v, pa, pb);
+          a[0] = v;
+          for (i = 1; i < stride; i++)
+            if (!p[i])
+              a[i] = (a[i] ? MultiplicationVal(pa, a[i]) : 0);
+            else if (!a[i])
+              a[i] = MultiplicationVal(pb, p[i]);
+            else
+              a[i] = AdditionVal(MultiplicationVal(pa, a[i]), MultiplicationVal(pb, p[i]));
+          p = a;
+        } else {
+          const double v = UnaryVal(pi->code, p[0]);
+          pa = UnaryPartial(pi->code, p[0], v);
+          p[0] = v;
+          for (i = 1; i < stride; i++)
+            if (p[i])
+              p[i] = MultiplicationVal(pa, p[i]);
+        }
+    }
+} // ... ValDerivatives(...)
+
+static void SaveInt(std::string& out, int v)
+{
+  out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+static bool LoadInt(const char*& in, const char* end, int& v)
+{
+  if (end - in < (long)sizeof(v))
+    return false;
+  memcpy(&v, in, sizeof(v));
+  in += sizeof(v);
+  return true;
+}
+
+// nvars, nouts, stacksize, ntemps, the number of instructions and of constants, the instructions as pairs of ints and
+// the constants
+bool RProgram::Save(std::string& out) const
+{
+  if (!funcs.empty())
+    return false;
+  SaveInt(out, nvars);
+  SaveInt(out, nouts);
+  SaveInt(out, stacksize);
+  SaveInt(out, ntemps);
+  SaveInt(out, (int)code.size());
+  SaveInt(out, (int)consts.size());
+  for (size_t i = 0; i < code.size(); i++) {
+    SaveInt(out, (int)code[i].code);
+    SaveInt(out, code[i].arg);
+  }
+  if (!consts.empty())
+    out.append(reinterpret_cast<const char*>(consts.data()), consts.size() * sizeof(double));
+  return true;
+} // ... Save(...)
+
+bool RProgram::Load(const char*& in, const char* end)
+{
+  // larger stacks or numbers of temporaries are no sensible program, but would make Val() allocate huge buffers
+  static const int max_size = 1 << 20;
+  const char* p = in;
+  RProgram r;
+  int ncode = 0, nconsts = 0, c = 0, depth = 0, maxdepth = 0, nkept = 0;
+  if (!LoadInt(p, end, r.nvars) || !LoadInt(p, end, r.nouts) || !LoadInt(p, end, r.stacksize)
+      || !LoadInt(p, end, r.ntemps) || !LoadInt(p, end, ncode) || !LoadInt(p, end, nconsts))
+    return false;
+  if (r.nvars < 0 || r.nouts < 0 || r.stacksize < 0 || r.stacksize > max_size || r.ntemps < 0
+      || r.ntemps > max_size || ncode < 0 || nconsts < 0 || (end - p) / (2 * (long)sizeof(int)) < ncode)
+    return false;
+  r.code.resize(ncode);
+  std::vector<char> stored(r.nouts, 0);
+  // The instructions have to be valid and may neither underflow the stack nor load a temporary before it was kept.
+  // Every output has to be stored exactly once, each from a stack holding nothing but its value.
+  for (int i = 0; i < ncode; i++) {
+    RInstruction& instr = r.code[i];
+    if (!LoadInt(p, end, c) || !LoadInt(p, end, instr.arg))
+      return false;
+    if (c < BCNum || c > BCLoad || c == BCCall)
+      return false;
+    instr.code = (RCode)c;
+    switch (instr.code) {
+      case BCNum:
+        if (instr.arg < 0 || instr.arg >= nconsts)
+          return false;
+        depth++;
+        break;
+      case BCVar:
+        if (instr.arg < 0 || instr.arg >= r.nvars)
+          return false;
+        depth++;
+        break;
+      case BCLoad:
+        if (instr.arg < 0 || instr.arg >= nkept)
+          return false;
+        depth++;
+        break;
+      case BCKeep:
+        // the temporaries are numbered in the order they are kept in (see EmitNode())
+        if (instr.arg < 0 || instr.arg > nkept || depth < 1)
+          return false;
+        if (instr.arg == nkept)
+          nkept++;
+        break;
+      case BCStore:
+        if (instr.arg < 0 || instr.arg >= r.nouts || depth != 1 || stored[instr.arg])
+          return false;
+        stored[instr.arg] = 1;
+        depth = 0;
+        break;
+      default: {
+        const int noperands = (IsTernary(instr.code) ? 3 : IsBinary(instr.code) ? 2 : 1);
+        if (depth < noperands)
+          return false;
+        depth -= noperands - 1;
+      }
+    }
+    if (depth > maxdepth)
+      maxdepth = depth;
+  }
+  // the sizes have to be the ones of the code, as computed by Push() (at least 1, but 0 for an empty RProgram())
+  if (depth != 0 || r.ntemps != nkept)
+    return false;
+  if (r.stacksize != (maxdepth > 1 ? maxdepth : 1) && !(ncode == 0 && r.stacksize == 0))
+    return false;
+  for (const char& is_stored : stored)
+    if (!is_stored)
+      return false;
+  if ((end - p) / (long)sizeof(double) < nconsts)
+    return false;
+  r.consts.resize(nconsts);
+  if (nconsts > 0)
+    memcpy(r.consts.data(), p, nconsts * sizeof(double));
+  p += nconsts * sizeof(double);
+  *this = r;
+  in = p;
+  return true;
+} // ... Load(...)
@@ -19,6 +19,40 @@ This software comes with absolutely no warranty.
 
 */
 
+/*
+
+Changes made for dune-xt-functions:
+
+- Added RProgram, which compiles one or several ROperations into a compact
+  instruction list that refers to variables by index and evaluates all of
+  them at a whole block of points at once (structure-of-arrays layout).
+- Added RProgram::Optimize(), which folds constants, shares common
+  subexpressions of all outputs and applies simple algebraic identities,
+  and RProgram::Bind() and RProgram::SelectOutputs().
+- ROperation(const char*, ...) first tries RParser, a single pass recursive
+  descent parser which builds the same trees without copying the string,
+  and only falls back to the original string rewriting parser for input it
+  does not know.
+- Added RProgram::Bounds(), which evaluates a program in interval arithmetic.
+- Added RProgram::Degrees(), which determines the polynomial degrees of the
+  outputs of a program.
+- Added RProgram::ValDerivatives(), which evaluates a program together with
+  its derivatives by forward mode automatic differentiation.
+- Added RProgram::Save() and RProgram::Load(), which write a program to and
+  read it from a binary string. Load() rejects data which is no valid program.
+- ROperation::Val() interprets a compact array of opcodes with inline
+  operands (RStep) instead of calling the stack functions through pointers,
+  the original interpreter is kept as ROperation::ValThreaded().
+- ln(x), exp(x), sin(x) and cos(x) are no longer computed by libm, but by the
+  kernels of vectormath.hh (within one ulp of libm), also by ROperation::Val(),
+  so scalar results may differ from libm's in the last bit.
+- Added the functions min(a,b), max(a,b), clamp(x,lo,hi), floor(x),
+  heaviside(x) (1 for x>0, 0 otherwise) and if(c,a,b) (a for c>0, b
+  otherwise), which only evaluates to ErrVal if c or the selected value
+  does, and the corresponding opcodes of RProgram.
+
+*/
+
 #ifndef DUNE_XT_FUNCTIONS_NONPARAMETRIC_EXPRESSION_MATHEXPRESSION_HH
 #define DUNE_XT_FUNCTIONS_NONPARAMETRIC_EXPRESSION_MATHEXPRESSION_HH
 
@@ -28,6 +62,9 @@ This software comes with absolutely no warranty.
 #include <math.h>
 #include <float.h>
 
+#include <string>
+#include <vector>
+
 // Compatibility with long double-typed functions
 #define atanl atan
 #define asinl asin
@@ -96,7 +133,13 @@ enum ROperator
   Asin,
   Atan,
   E10,
-  Fun
+  Fun,
+  Min,
+  Max,
+  Floor,
+  Heaviside,
+  If, // if(c,a,b) is a for c>0 and b otherwise
+  Clamp // clamp(x,lo,hi) is min(max(x,lo),hi)
 };
 
 typedef void((*pfoncld)(double*&));
@@ -106,15 +149,30 @@ typedef ROperation* PROperation;
 class RFunction;
 typedef RFunction* PRFunction;
 
+// One cell of the code interpreted by ROperation::Val(): an opcode, which is followed by the address of the value to
+// push or by the function to apply for the opcodes taking an operand
+union RStep
+{
+  int op;
+  double* pval;
+  RFunction* pfunc;
+};
+
 class ROperation
 {
   pfoncld* pinstr;
   double** pvals;
   double* ppile;
   RFunction** pfuncpile;
+  RStep* pcode;
   mutable signed char containfuncflag;
   void BuildCode();
+  void BuildSteps();
   void Destroy();
+  void ParseStr(const char* sp, int nvarp, PRVar* ppvarp, int nfuncp, PRFunction* ppfuncp);
+  // Takes ownership of the members, used by RParser
+  ROperation(ROperator, PROperation, PROperation, double, const RVar*, RFunction*);
+  friend class RParser;
 
 public:
   ROperator op;
@@ -130,6 +188,7 @@ public:
   ROperation(const char* sp, int nvarp = 0, PRVar* ppvarp = NULL, int nfuncp = 0, PRFunction* ppfuncp = NULL);
   ~ROperation();
   double Val() const;
+  double ValThreaded() const; // Same as Val(), by calling the stack functions in pinstr, kept for comparison
   signed char ContainVar(const RVar&) const;
   signed char ContainFunc(const RFunction&) const;
   signed char ContainFuncNoRec(const RFunction&) const; // No recursive test on subfunctions
@@ -158,6 +217,11 @@ public:
   friend ROperation acos(const ROperation&);
   friend ROperation asin(const ROperation&);
   friend ROperation atan(const ROperation&);
+  friend ROperation min(const ROperation&, const ROperation&);
+  friend ROperation max(const ROperation&, const ROperation&);
+  friend ROperation floor(const ROperation&);
+  friend ROperation heaviside(const ROperation&);
+  friend ROperation condition(const ROperation&, const ROperation&, const ROperation&); // if(c,a,b)
   friend ROperation ApplyOperator(int, ROperation**, ROperation (*)(const ROperation&, const ROperation&));
   ROperation Diff(const RVar&) const; //  Differentiate w.r.t a variable
   char* Expr() const;
@@ -189,6 +253,122 @@ public:
   ROperation operator()(const ROperation&);
 };
 
+// Instructions of an RProgram, the arg of an RInstruction is an index into the constants (BCNum), the variables
+// (BCVar), the function pointers (BCCall), the outputs (BCStore) or the temporaries (BCKeep, BCLoad)
+enum RCode
+{
+  BCNum,
+  BCVar,
+  BCAdd,
+  BCSub,
+  BCMult,
+  BCDiv,
+  BCPow,
+  BCNthRoot,
+  BCE10,
+  BCAtan2,
+  BCMin,
+  BCMax,
+  BCOpp,
+  BCAbs,
+  BCSqrt,
+  BCSin,
+  BCCos,
+  BCTg,
+  BCLn,
+  BCExp,
+  BCAcos,
+  BCAsin,
+  BCAtan,
+  BCFloor,
+  BCHeaviside,
+  BCIf, // pops c, a and b (pushed in this order) and pushes a for c>0 and b otherwise
+  BCError,
+  BCCall,
+  BCStore,
+  BCKeep, // copies the top of the stack to a temporary
+  BCLoad // pushes a temporary
+};
+
+struct RInstruction
+{
+  RCode code;
+  int arg;
+};
+
+// Compiled form of nops ROperations depending on nvar variables. Contrary to ROperation::Val() it does neither read
+// the variables' memory nor write to a stack owned by the object, so one RProgram may be used by several threads.
+// Results are bit-for-bit identical to ROperation::Val().
+class RProgram
+{
+  std::vector<RInstruction> code;
+  std::vector<double> consts;
+  std::vector<double((*)(double))> funcs;
+  int nvars, nouts, stacksize, ntemps;
+  void Compile(const ROperation&, int nvar, const RVar* const* ppvar, int& depth);
+  void Push(RCode, int arg, int& depth);
+  RProgram Rewrite(int nbound, const double* values, const std::vector<int>& outputs) const;
+
+public:
+  static const int BlockSize = 64;
+  RProgram();
+  RProgram(int nops, const ROperation* const* ppop, int nvar, const RVar* const* ppvar);
+  int NVars() const;
+  int NOutputs() const;
+  int NInstructions() const;
+  int StackSize() const;
+  int NTemporaries() const;
+  const std::vector<RInstruction>& Code() const;
+  const std::vector<double>& Constants() const;
+  int NFunctions() const;
+  // Number of doubles of work space needed by the batched Val()
+  size_t WorkSize() const;
+  // Returns an equivalent program with folded constants, where subexpressions shared by several outputs or
+  // occurring several times are only computed once, and x+0, x-0, x*1, x/1, x^1, --x, min(x,x), max(x,x), if(c,x,x)
+  // are simplified to x, x*0 to 0, x^2 to x*x and if(c,a,b) with a constant c to a or b. Results only differ from the
+  // ones of this program where it would have returned ErrVal or flushed a tiny value to zero, and by the rounding of
+  // pow for x^2.
+  RProgram Optimize() const;
+  // Returns an optimized program where the first n variables are replaced by the constants values[0], ...,
+  // values[n-1] and the remaining ones are renumbered from 0
+  RProgram Bind(int n, const double* values) const;
+  // Returns an optimized program computing the given outputs of this program, in that order
+  RProgram SelectOutputs(const std::vector<int>& outputs) const;
+  // Evaluates at one point, vars[i] being the value of the i-th variable, out receives NOutputs() values
+  void Val(const double* vars, double* out) const;
+  // Evaluates at npoints points, vars[i][p] being the value of the i-th variable at the p-th point, out receives
+  // NOutputs()*npoints values, the one of the k-th output at the p-th point being out[k*npoints+p]
+  void Val(const double* const* vars, double* out, size_t npoints) const;
+  // Same, using work (WorkSize() doubles) instead of allocating
+  void Val(const double* const* vars, double* out, size_t npoints, double* work) const;
+  // Interval evaluation: outlower and outupper receive NOutputs() values each, bounding the values of the outputs for
+  // all vars with lower[i] <= vars[i] <= upper[i], rounding errors included. Outputs which are not defined on the
+  // whole box or might overflow get the bounds -HUGE_VAL and HUGE_VAL. Where an intermediate value only underflows
+  // Val() may return ErrVal, which these bounds ignore.
+  void Bounds(const double* lower, const double* upper, double* outlower, double* outupper) const;
+  // Total polynomial degree of the outputs in the variables, out receives NOutputs() values. For outputs which are no
+  // polynomials this is an estimate: every other function of an argument of degree d (including division by it and
+  // powers with it as exponent) counts as a polynomial of degree transcendental*d. Returns whether all outputs are
+  // polynomials.
+  bool Degrees(int transcendental, int* out) const;
+  // Evaluates at one point like Val(vars, out) and computes the derivatives of all outputs w.r.t. all variables in the
+  // same pass (forward mode automatic differentiation), derivatives receives NOutputs()*NVars() values, the one of the
+  // k-th output w.r.t. the i-th variable being derivatives[k*NVars()+i]. Derivatives which are not defined at this
+  // point are ErrVal.
+  void ValDerivatives(const double* vars, double* out, double* derivatives) const;
+  // Same, but only w.r.t. the n variables first, ..., first+n-1, derivatives[k*n+i] being the derivative of the k-th
+  // output w.r.t. the (first+i)-th variable
+  void ValDerivatives(const double* vars, double* out, double* derivatives, int first, int n) const;
+  // Appends a binary representation of this program to out, which Load() reads back on a machine with the same
+  // byte order. Returns false and leaves out unchanged if the program calls functions (see NFunctions()), since
+  // their addresses are only valid in this process.
+  bool Save(std::string& out) const;
+  // Reads a program written by Save() from [in, end) and advances in behind it. Returns false and leaves this program
+  // unchanged if the data is truncated or not a valid program, i.e., unless its instructions stay within its
+  // variables, constants and temporaries, store every output exactly once and its sizes are the ones of its code.
+  bool Load(const char*& in, const char* end);
+};
+
 char* MidStr(const char* s, int i1, int i2);
 char* CopyStr(const char* s);
 char* InsStr(const char* s, int n, char c);
@@ -12,9 +12,14 @@
 #ifndef DUNE_XT_FUNCTIONS_EXPRESSION_PARAMETRIC_HH
 #define DUNE_XT_FUNCTIONS_EXPRESSION_PARAMETRIC_HH
 
-#include <string>
 #include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
 #include <dune/common/typetraits.hh>
 
 #include <dune/xt/common/exceptions.hh>
@@ -28,6 +33,122 @@ namespace XT {
 namespace Functions {
 
 
+/**
+ * \brief A ParametricExpressionFunction for a fixed parameter, see ParametricExpressionFunction::with_parameter().
+ *
+ * The parameter values are folded into the compiled expressions (see RProgram::Bind()) as constants, so evaluating
+ * this function only copies the coordinates and does not allocate.
+ */
+template <class E, class D, size_t d, class R, size_t r>
+class BoundExpressionFunction : public GlobalFunctionInterface<E, D, d, R, r, 1>
+{
+  typedef GlobalFunctionInterface<E, D, d, R, r, 1> BaseType;
+
+public:
+  using typename BaseType::DomainType;
+  using BaseType::dimDomain;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+  using BaseType::dimRange;
+
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".boundexpression";
+  }
+
+  /**
+   * \param program            computes the dimRange values from the dimDomain coordinates
+   * \param derivative_program computes the derivative of the ii-th value w.r.t. the jj-th coordinate as its
+   *                           (ii * dimDomain + jj)-th output
+   */
+  BoundExpressionFunction(const RProgram& program,
+                          const RProgram& derivative_program,
+                          const size_t ord = 0,
+                          const std::string nm = static_id())
+    : program_(program)
+    , derivative_program_(derivative_program)
+    , order_(ord)
+    , name_(nm)
+  {
+    if (program_.NVars() > int(dimDomain) || program_.NOutputs() != int(dimRange))
+      DUNE_THROW(Common::Exceptions::shapes_do_not_match,
+                 "program.NVars(): " << program_.NVars() << "\n   "
+                                     << "program.NOutputs(): "
+                                     << program_.NOutputs());
+    if (derivative_program_.NVars() > int(dimDomain) || derivative_program_.NOutputs() != int(dimRange * dimDomain))
+      DUNE_THROW(Common::Exceptions::shapes_do_not_match,
+                 "derivative_program.NVars(): " << derivative_program_.NVars() << "\n   "
+                                                << "derivative_program.NOutputs(): "
+                                                << derivative_program_.NOutputs());
+    if (JitMathExpression::enabled()) {
+      jit_ = JitMathExpression::create(program_);
+      derivative_jit_ = JitMathExpression::create(derivative_program_);
+    }
+  }
+
+  std::string type() const override final
+  {
+    return BaseType::static_id() + ".boundexpression";
+  }
+
+  std::string name() const override final
+  {
+    return name_;
+  }
+
+  virtual size_t order(const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    return order_;
+  }
+
+  using BaseType::evaluate;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    double args[dimDomain];
+    double values[dimRange];
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[ii] = xx[ii];
+    if (jit_)
+      jit_->evaluate(args, values);
+    else
+      program_.Val(args, values);
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      ret[rr] = values[rr];
+  }
+
+  using BaseType::jacobian;
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    double args[dimDomain];
+    double values[dimRange * dimDomain];
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[ii] = xx[ii];
+    if (derivative_jit_)
+      derivative_jit_->evaluate(args, values);
+    else
+      derivative_program_.Val(args, values);
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      for (size_t ii = 0; ii < dimDomain; ++ii)
+        ret[rr][ii] = values[rr * dimDomain + ii];
+  }
+
+  const RProgram& program() const
+  {
+    return program_;
+  }
+
+private:
+  const RProgram program_;
+  const RProgram derivative_program_;
+  const size_t order_;
+  const std::string name_;
+  std::shared_ptr<const JitMathExpression> jit_;
+  std::shared_ptr<const JitMathExpression> derivative_jit_;
+}; // class BoundExpressionFunction
+
+
 template <class E, class D, size_t d, class R, size_t r, size_t rC = 1>
 class ParametricExpressionFunction
 {
@@ -42,6 +163,8 @@ class ParametricExpressionFunction<E, D, d, R, r, 1> : public GlobalFunctionInte
   typedef DynamicMathExpressionBase<D, R, r> ActualFunctionType;
 
 public:
+  typedef BoundExpressionFunction<E, D, d, R, r> BoundFunctionType;
+
   using typename BaseType::DomainType;
   using BaseType::dimDomain;
   using typename BaseType::RangeType;
@@ -115,28 +238,7 @@ public:
 
   void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const override final
   {
-    Common::Parameter parsed_mu;
-    if (!param_type_.empty()) {
-      parsed_mu = this->parse_parameter(mu);
-      if (parsed_mu.type() != param_type_)
-        DUNE_THROW(Common::Exceptions::parameter_error,
-                   "parameter_type(): " << param_type_ << "\n   "
-                                        << "mu.type(): "
-                                        << mu.type());
-    }
-    DynamicVector<D> args(num_parameter_variables_ + dimDomain);
-    size_t II = 0;
-    for (const auto& key : param_type_.keys()) {
-      for (const auto& value : parsed_mu.get(key)) {
-        args[II] = value;
-        ++II;
-      }
-    }
-    for (size_t ii = 0; ii < dimDomain; ++ii) {
-      args[II] = xx[ii];
-      ++II;
-    }
-    function_->evaluate(args, ret);
+    function_->evaluate(arguments(xx, mu), ret);
 
 #ifndef NDEBUG
 #ifndef DUNE_XT_FUNCTIONS_EXPRESSION_DISABLE_CHECKS
@@ -179,14 +281,109 @@ public:
 #endif // NDEBUG
   } // ... evaluate(...)
 
-  void jacobian(const DomainType& /*xx*/,
-                JacobianRangeType& /*ret*/,
-                const Common::Parameter& /*mu*/ = {}) const override final
+  /**
+   * The jacobian is computed by differentiating the expressions (see DynamicMathExpressionBase::jacobian).
+   */
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    DynamicMatrix<R> derivatives;
+    // the variables of function_ are the parameter components, followed by x
+    function_->jacobian(arguments(xx, mu), num_parameter_variables_, dimDomain, derivatives);
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      for (size_t ii = 0; ii < dimDomain; ++ii)
+        ret[rr][ii] = derivatives[rr][ii];
+  } // ... jacobian(...)
+
+  /**
+   * \brief Computes the derivatives w.r.t. the parameter, ret[key][ii] being the derivative w.r.t. the ii-th component
+   *        of mu[key] (ret will be overwritten).
+   *
+   * All derivatives are computed in one pass through the compiled expressions, like the jacobian.
+   */
+  void parameter_jacobian(const DomainType& xx,
+                          std::map<std::string, std::vector<RangeType>>& ret,
+                          const Common::Parameter& mu = {}) const
+  {
+    ret.clear();
+    DynamicMatrix<R> derivatives;
+    function_->jacobian(arguments(xx, mu), 0, num_parameter_variables_, derivatives);
+    size_t II = 0;
+    for (const auto& key : param_type_.keys()) {
+      auto& key_derivatives = ret[key];
+      key_derivatives.resize(param_type_.get(key));
+      for (auto& derivative : key_derivatives) {
+        for (size_t rr = 0; rr < dimRange; ++rr)
+          derivative[rr] = derivatives[rr][II];
+        ++II;
+      }
+    }
+  } // ... parameter_jacobian(...)
+
+  std::map<std::string, std::vector<RangeType>> parameter_jacobian(const DomainType& xx,
+                                                                   const Common::Parameter& mu = {}) const
   {
-    DUNE_THROW(NotImplemented, "Not yet, at least...");
+    std::map<std::string, std::vector<RangeType>> ret;
+    parameter_jacobian(xx, ret, mu);
+    return ret;
   }
 
+  /**
+   * \brief Returns this function for the fixed parameter mu.
+   *
+   * The parameter values are folded into the compiled expressions as constants, which is much cheaper to evaluate
+   * if mu does not change over many evaluations.
+   */
+  std::unique_ptr<BoundFunctionType> with_parameter(const Common::Parameter& mu) const
+  {
+    std::vector<double> values(num_parameter_variables_);
+    copy_parameter_values(mu, values);
+    const int num_values = static_cast<int>(values.size());
+    // the derivatives w.r.t. the parameter components are not needed
+    std::vector<int> derivatives;
+    for (size_t rr = 0; rr < dimRange; ++rr)
+      for (size_t ii = 0; ii < dimDomain; ++ii)
+        derivatives.push_back(static_cast<int>(rr * (num_parameter_variables_ + dimDomain) + num_parameter_variables_
+                                               + ii));
+    return Common::make_unique<BoundFunctionType>(
+        function_->program().Bind(num_values, values.data()),
+        function_->derivative_program().SelectOutputs(derivatives).Bind(num_values, values.data()),
+        order_,
+        name_);
+  } // ... with_parameter(...)
+
 private:
+  //! Writes the values of the parameter components to values[0], values[1], ..., in the order of the variables of
+  //! function_.
+  template <class VectorType>
+  void copy_parameter_values(const Common::Parameter& mu, VectorType& values) const
+  {
+    Common::Parameter parsed_mu;
+    if (!param_type_.empty()) {
+      parsed_mu = this->parse_parameter(mu);
+      if (parsed_mu.type() != param_type_)
+        DUNE_THROW(Common::Exceptions::parameter_error,
+                   "parameter_type(): " << param_type_ << "\n   "
+                                        << "mu.type(): "
+                                        << mu.type());
+    }
+    size_t II = 0;
+    for (const auto& key : param_type_.keys()) {
+      for (const auto& value : parsed_mu.get(key)) {
+        values[II] = value;
+        ++II;
+      }
+    }
+  } // ... copy_parameter_values(...)
+
+  DynamicVector<D> arguments(const DomainType& xx, const Common::Parameter& mu) const
+  {
+    DynamicVector<D> args(num_parameter_variables_ + dimDomain);
+    copy_parameter_values(mu, args);
+    for (size_t ii = 0; ii < dimDomain; ++ii)
+      args[num_parameter_variables_ + ii] = xx[ii];
+    return args;
+  } // ... arguments(...)
+
   size_t order_;
   std::string name_;
   Common::ParameterType param_type_;
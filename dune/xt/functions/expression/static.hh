@@ -0,0 +1,749 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_EXPRESSION_STATIC_HH
+#define DUNE_XT_FUNCTIONS_EXPRESSION_STATIC_HH
+
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <dune/xt/common/memory.hh>
+
+#include "../interfaces.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+
+/**
+ * \brief Expressions which are known at compile time.
+ *
+ * The expressions are written as C++ expressions of the variables x<0>, x<1>, ... and the functions below, e.g.
+ * \code
+using namespace StaticExpressions;
+const auto expression = sin(x<0>) * x<1> + 2 * pow(x<1>, 2);
+expression(xx); // sin(xx[0]) * xx[1] + 2 * std::pow(xx[1], 2)
+derivative<1>(expression)(xx); // sin(xx[0]) + 2 * (2 * std::pow(xx[1], 1))
+\endcode
+ * The type of an expression encodes its structure, so the compiler sees the whole expression (and its derivatives,
+ * which are built at compile time) and may inline and vectorize its evaluation. Sums with and products by Zero and
+ * One are simplified, so the derivatives do not contain terms which are known to vanish.
+ *
+ * In contrast to the expressions of mathexpr.hh, the values are computed by the functions of <cmath>, so invalid
+ * operations give inf or nan instead of an error value.
+ */
+namespace StaticExpressions {
+
+
+struct ExpressionTag
+{
+};
+
+template <class T>
+struct is_expression : public std::is_base_of<ExpressionTag, T>
+{
+};
+
+
+//! The i-th variable.
+template <size_t i>
+struct Variable : public ExpressionTag
+{
+  template <class DomainType>
+  double operator()(const DomainType& xx) const
+  {
+    return xx[i];
+  }
+};
+
+struct Zero : public ExpressionTag
+{
+  template <class DomainType>
+  constexpr double operator()(const DomainType& /*xx*/) const
+  {
+    return 0.;
+  }
+};
+
+struct One : public ExpressionTag
+{
+  template <class DomainType>
+  constexpr double operator()(const DomainType& /*xx*/) const
+  {
+    return 1.;
+  }
+};
+
+struct Constant : public ExpressionTag
+{
+  constexpr Constant(const double val)
+    : value(val)
+  {
+  }
+
+  template <class DomainType>
+  constexpr double operator()(const DomainType& /*xx*/) const
+  {
+    return value;
+  }
+
+  double value;
+};
+
+
+#define DXTF_STATIC_EXPRESSION_UNARY(_Name, _value)                                                                    \
+  struct _Name                                                                                                         \
+  {                                                                                                                    \
+    static double apply(const double a)                                                                                \
+    {                                                                                                                  \
+      return _value;                                                                                                   \
+    }                                                                                                                  \
+  };
+
+#define DXTF_STATIC_EXPRESSION_BINARY(_Name, _value)                                                                   \
+  struct _Name                                                                                                         \
+  {                                                                                                                    \
+    static double apply(const double a, const double b)                                                                \
+    {                                                                                                                  \
+      return _value;                                                                                                   \
+    }                                                                                                                  \
+  };
+
+namespace Operations {
+
+DXTF_STATIC_EXPRESSION_UNARY(Negate, -a)
+DXTF_STATIC_EXPRESSION_UNARY(Abs, std::abs(a))
+DXTF_STATIC_EXPRESSION_UNARY(Sign, (a > 0) - (a < 0))
+DXTF_STATIC_EXPRESSION_UNARY(Sqrt, std::sqrt(a))
+DXTF_STATIC_EXPRESSION_UNARY(Exp, std::exp(a))
+DXTF_STATIC_EXPRESSION_UNARY(Log, std::log(a))
+DXTF_STATIC_EXPRESSION_UNARY(Sin, std::sin(a))
+DXTF_STATIC_EXPRESSION_UNARY(Cos, std::cos(a))
+DXTF_STATIC_EXPRESSION_UNARY(Tan, std::tan(a))
+DXTF_STATIC_EXPRESSION_UNARY(Asin, std::asin(a))
+DXTF_STATIC_EXPRESSION_UNARY(Acos, std::acos(a))
+DXTF_STATIC_EXPRESSION_UNARY(Atan, std::atan(a))
+DXTF_STATIC_EXPRESSION_BINARY(Plus, a + b)
+DXTF_STATIC_EXPRESSION_BINARY(Minus, a - b)
+DXTF_STATIC_EXPRESSION_BINARY(Times, a * b)
+DXTF_STATIC_EXPRESSION_BINARY(Divides, a / b)
+DXTF_STATIC_EXPRESSION_BINARY(Power, std::pow(a, b))
+
+} // namespace Operations
+
+#undef DXTF_STATIC_EXPRESSION_UNARY
+#undef DXTF_STATIC_EXPRESSION_BINARY
+
+
+template <class Op, class A>
+struct Unary : public ExpressionTag
+{
+  constexpr Unary(const A& aa)
+    : a(aa)
+  {
+  }
+
+  template <class DomainType>
+  double operator()(const DomainType& xx) const
+  {
+    return Op::apply(a(xx));
+  }
+
+  A a;
+};
+
+template <class Op, class A, class B>
+struct Binary : public ExpressionTag
+{
+  constexpr Binary(const A& aa, const B& bb)
+    : a(aa)
+    , b(bb)
+  {
+  }
+
+  template <class DomainType>
+  double operator()(const DomainType& xx) const
+  {
+    return Op::apply(a(xx), b(xx));
+  }
+
+  A a;
+  B b;
+};
+
+
+template <size_t i>
+constexpr Variable<i> x{};
+
+
+namespace internal {
+
+
+// turns numbers into Constants
+template <class E>
+constexpr const E& as_expression(const E& e, typename std::enable_if<is_expression<E>::value, int>::type = 0)
+{
+  return e;
+}
+
+constexpr Constant as_expression(const double value)
+{
+  return Constant(value);
+}
+
+template <class T>
+using expression_t = typename std::decay<decltype(as_expression(std::declval<T>()))>::type;
+
+template <class A, class B>
+using enable_if_one_is_expression_t =
+    typename std::enable_if<(is_expression<A>::value && (is_expression<B>::value || std::is_arithmetic<B>::value))
+                                || (std::is_arithmetic<A>::value && is_expression<B>::value),
+                            int>::type;
+
+
+// the following create the nodes, simplifying sums with and products by Zero and One
+
+template <class A, class B>
+constexpr Binary<Operations::Plus, A, B> plus(const A& a, const B& b)
+{
+  return {a, b};
+}
+
+template <class A>
+constexpr A plus(const A& a, const Zero&)
+{
+  return a;
+}
+
+template <class B>
+constexpr B plus(const Zero&, const B& b)
+{
+  return b;
+}
+
+constexpr Zero plus(const Zero&, const Zero&)
+{
+  return {};
+}
+
+template <class A>
+constexpr Unary<Operations::Negate, A> negate(const A& a)
+{
+  return {a};
+}
+
+constexpr Zero negate(const Zero&)
+{
+  return {};
+}
+
+template <class A, class B>
+constexpr Binary<Operations::Minus, A, B> minus(const A& a, const B& b)
+{
+  return {a, b};
+}
+
+template <class A>
+constexpr A minus(const A& a, const Zero&)
+{
+  return a;
+}
+
+template <class B>
+constexpr auto minus(const Zero&, const B& b) -> decltype(negate(b))
+{
+  return negate(b);
+}
+
+constexpr Zero minus(const Zero&, const Zero&)
+{
+  return {};
+}
+
+template <class A, class B>
+constexpr Binary<Operations::Times, A, B> times(const A& a, const B& b)
+{
+  return {a, b};
+}
+
+template <class A>
+constexpr Zero times(const A&, const Zero&)
+{
+  return {};
+}
+
+template <class B>
+constexpr Zero times(const Zero&, const B&)
+{
+  return {};
+}
+
+template <class A>
+constexpr A times(const A& a, const One&)
+{
+  return a;
+}
+
+template <class B>
+constexpr B times(const One&, const B& b)
+{
+  return b;
+}
+
+constexpr Zero times(const Zero&, const Zero&)
+{
+  return {};
+}
+
+constexpr Zero times(const Zero&, const One&)
+{
+  return {};
+}
+
+constexpr Zero times(const One&, const Zero&)
+{
+  return {};
+}
+
+constexpr One times(const One&, const One&)
+{
+  return {};
+}
+
+template <class A, class B>
+constexpr Binary<Operations::Divides, A, B> divides(const A& a, const B& b)
+{
+  return {a, b};
+}
+
+template <class A>
+constexpr A divides(const A& a, const One&)
+{
+  return a;
+}
+
+template <class B>
+constexpr Zero divides(const Zero&, const B&)
+{
+  return {};
+}
+
+constexpr Zero divides(const Zero&, const One&)
+{
+  return {};
+}
+
+
+} // namespace internal
+
+
+template <class A, class B, internal::enable_if_one_is_expression_t<A, B> = 0>
+constexpr auto operator+(const A& a, const B& b)
+    -> decltype(internal::plus(internal::as_expression(a), internal::as_expression(b)))
+{
+  return internal::plus(internal::as_expression(a), internal::as_expression(b));
+}
+
+template <class A, class B, internal::enable_if_one_is_expression_t<A, B> = 0>
+constexpr auto operator-(const A& a, const B& b)
+    -> decltype(internal::minus(internal::as_expression(a), internal::as_expression(b)))
+{
+  return internal::minus(internal::as_expression(a), internal::as_expression(b));
+}
+
+template <class A, class B, internal::enable_if_one_is_expression_t<A, B> = 0>
+constexpr auto operator*(const A& a, const B& b)
+    -> decltype(internal::times(internal::as_expression(a), internal::as_expression(b)))
+{
+  return internal::times(internal::as_expression(a), internal::as_expression(b));
+}
+
+template <class A, class B, internal::enable_if_one_is_expression_t<A, B> = 0>
+constexpr auto operator/(const A& a, const B& b)
+    -> decltype(internal::divides(internal::as_expression(a), internal::as_expression(b)))
+{
+  return internal::divides(internal::as_expression(a), internal::as_expression(b));
+}
+
+template <class A, class B, internal::enable_if_one_is_expression_t<A, B> = 0>
+constexpr Binary<Operations::Power, internal::expression_t<A>, internal::expression_t<B>> pow(const A& a, const B& b)
+{
+  return {internal::as_expression(a), internal::as_expression(b)};
+}
+
+template <class A, typename std::enable_if<is_expression<A>::value, int>::type = 0>
+constexpr auto operator-(const A& a) -> decltype(internal::negate(a))
+{
+  return internal::negate(a);
+}
+
+#define DXTF_STATIC_EXPRESSION_FUNCTION(_name, _Name)                                                                  \
+  template <class A, typename std::enable_if<is_expression<A>::value, int>::type = 0>                                  \
+  constexpr Unary<Operations::_Name, A> _name(const A& a)                                                              \
+  {                                                                                                                    \
+    return {a};                                                                                                        \
+  }
+
+DXTF_STATIC_EXPRESSION_FUNCTION(abs, Abs)
+DXTF_STATIC_EXPRESSION_FUNCTION(sqrt, Sqrt)
+DXTF_STATIC_EXPRESSION_FUNCTION(exp, Exp)
+DXTF_STATIC_EXPRESSION_FUNCTION(log, Log)
+DXTF_STATIC_EXPRESSION_FUNCTION(sin, Sin)
+DXTF_STATIC_EXPRESSION_FUNCTION(cos, Cos)
+DXTF_STATIC_EXPRESSION_FUNCTION(tan, Tan)
+DXTF_STATIC_EXPRESSION_FUNCTION(asin, Asin)
+DXTF_STATIC_EXPRESSION_FUNCTION(acos, Acos)
+DXTF_STATIC_EXPRESSION_FUNCTION(atan, Atan)
+
+#undef DXTF_STATIC_EXPRESSION_FUNCTION
+
+
+namespace internal {
+
+
+template <class Op>
+struct Derivative;
+
+template <>
+struct Derivative<Operations::Negate>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A&, const DA& da)
+  {
+    return -da;
+  }
+};
+
+template <>
+struct Derivative<Operations::Abs>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return Unary<Operations::Sign, A>(a) * da;
+  }
+};
+
+template <>
+struct Derivative<Operations::Sign>
+{
+  template <class A, class DA>
+  static constexpr Zero apply(const A&, const DA&)
+  {
+    return {};
+  }
+};
+
+template <>
+struct Derivative<Operations::Sqrt>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return da / (2 * sqrt(a));
+  }
+};
+
+template <>
+struct Derivative<Operations::Exp>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return exp(a) * da;
+  }
+};
+
+template <>
+struct Derivative<Operations::Log>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return da / a;
+  }
+};
+
+template <>
+struct Derivative<Operations::Sin>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return cos(a) * da;
+  }
+};
+
+template <>
+struct Derivative<Operations::Cos>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return -(sin(a) * da);
+  }
+};
+
+template <>
+struct Derivative<Operations::Tan>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return da / (cos(a) * cos(a));
+  }
+};
+
+template <>
+struct Derivative<Operations::Asin>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return da / sqrt(1 - a * a);
+  }
+};
+
+template <>
+struct Derivative<Operations::Acos>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return -(da / sqrt(1 - a * a));
+  }
+};
+
+template <>
+struct Derivative<Operations::Atan>
+{
+  template <class A, class DA>
+  static constexpr auto apply(const A& a, const DA& da)
+  {
+    return da / (1 + a * a);
+  }
+};
+
+template <>
+struct Derivative<Operations::Plus>
+{
+  template <class A, class B, class DA, class DB>
+  static constexpr auto apply(const A&, const B&, const DA& da, const DB& db)
+  {
+    return da + db;
+  }
+};
+
+template <>
+struct Derivative<Operations::Minus>
+{
+  template <class A, class B, class DA, class DB>
+  static constexpr auto apply(const A&, const B&, const DA& da, const DB& db)
+  {
+    return da - db;
+  }
+};
+
+template <>
+struct Derivative<Operations::Times>
+{
+  template <class A, class B, class DA, class DB>
+  static constexpr auto apply(const A& a, const B& b, const DA& da, const DB& db)
+  {
+    return da * b + a * db;
+  }
+};
+
+template <>
+struct Derivative<Operations::Divides>
+{
+  template <class A, class B, class DA, class DB>
+  static constexpr auto apply(const A& a, const B& b, const DA& da, const DB& db)
+  {
+    return (da * b - a * db) / (b * b);
+  }
+};
+
+template <>
+struct Derivative<Operations::Power>
+{
+  // constant exponent
+  template <class A, class DA, class DB>
+  static constexpr auto apply(const A& a, const Constant& b, const DA& da, const DB&)
+  {
+    return b * pow(a, b.value - 1) * da;
+  }
+
+  template <class A, class B, class DA, class DB>
+  static constexpr auto apply(const A& a, const B& b, const DA& da, const DB& db)
+  {
+    return pow(a, b) * (db * log(a) + b * da / a);
+  }
+};
+
+
+} // namespace internal
+
+
+//! The derivative of an expression w.r.t. x<i>.
+template <size_t i, size_t j>
+constexpr typename std::conditional<i == j, One, Zero>::type derivative(const Variable<j>&)
+{
+  return {};
+}
+
+template <size_t i>
+constexpr Zero derivative(const Zero&)
+{
+  return {};
+}
+
+template <size_t i>
+constexpr Zero derivative(const One&)
+{
+  return {};
+}
+
+template <size_t i>
+constexpr Zero derivative(const Constant&)
+{
+  return {};
+}
+
+template <size_t i, class Op, class A>
+constexpr auto derivative(const Unary<Op, A>& e)
+{
+  return internal::Derivative<Op>::apply(e.a, derivative<i>(e.a));
+}
+
+template <size_t i, class Op, class A, class B>
+constexpr auto derivative(const Binary<Op, A, B>& e)
+{
+  return internal::Derivative<Op>::apply(e.a, e.b, derivative<i>(e.a), derivative<i>(e.b));
+}
+
+
+} // namespace StaticExpressions
+
+
+/**
+ * \brief A function given by StaticExpressions, one for each component of its range.
+ *
+ * The expressions and their derivatives are evaluated without any parsing or interpretation. Use
+ * make_static_expression_function() to create these functions, e.g.
+ * \code
+using namespace StaticExpressions;
+auto function = make_static_expression_function<EntityType, double, 2, double>(2, x<0> * x<1>, sin(x<0>));
+\endcode
+ */
+template <class EntityImp, class DomainFieldImp, size_t domainDim, class RangeFieldImp, class... Expressions>
+class StaticExpressionFunction
+    : public GlobalFunctionInterface<EntityImp, DomainFieldImp, domainDim, RangeFieldImp, sizeof...(Expressions), 1>
+{
+  typedef GlobalFunctionInterface<EntityImp, DomainFieldImp, domainDim, RangeFieldImp, sizeof...(Expressions), 1>
+      BaseType;
+  typedef std::make_index_sequence<sizeof...(Expressions)> RangeIndices;
+  typedef std::make_index_sequence<domainDim> DomainIndices;
+
+public:
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+  using BaseType::dimDomain;
+  using BaseType::dimRange;
+
+  static std::string static_id()
+  {
+    return BaseType::static_id() + ".staticexpression";
+  }
+
+  StaticExpressionFunction(const size_t ord, const std::string nm, const Expressions&... expressions)
+    : expressions_(expressions...)
+    , order_(ord)
+    , name_(nm)
+  {
+  }
+
+  std::string type() const override final
+  {
+    return BaseType::static_id() + ".staticexpression";
+  }
+
+  std::string name() const override final
+  {
+    return name_;
+  }
+
+  size_t order(const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    return order_;
+  }
+
+  using BaseType::evaluate;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    evaluate(xx, ret, RangeIndices());
+  }
+
+  using BaseType::jacobian;
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& /*mu*/ = {}) const override final
+  {
+    jacobian(xx, ret, RangeIndices());
+  }
+
+  const std::tuple<Expressions...>& expressions() const
+  {
+    return expressions_;
+  }
+
+private:
+  template <size_t... rr>
+  void evaluate(const DomainType& xx, RangeType& ret, std::index_sequence<rr...>) const
+  {
+    using expand = int[];
+    (void)expand{0, (ret[rr] = std::get<rr>(expressions_)(xx), 0)...};
+  }
+
+  template <size_t... rr>
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, std::index_sequence<rr...>) const
+  {
+    using expand = int[];
+    (void)expand{0, (jacobian_row(std::get<rr>(expressions_), xx, ret[rr], DomainIndices()), 0)...};
+  }
+
+  template <class E, class RowType, size_t... jj>
+  static void jacobian_row(const E& expression, const DomainType& xx, RowType& row, std::index_sequence<jj...>)
+  {
+    using expand = int[];
+    (void)expand{0, (row[jj] = StaticExpressions::derivative<jj>(expression)(xx), 0)...};
+  }
+
+  const std::tuple<Expressions...> expressions_;
+  const size_t order_;
+  const std::string name_;
+}; // class StaticExpressionFunction
+
+
+template <class E, class D, size_t d, class R, class... Expressions>
+std::unique_ptr<StaticExpressionFunction<E, D, d, R, Expressions...>>
+make_static_expression_function(const size_t order, const Expressions&... expressions)
+{
+  typedef StaticExpressionFunction<E, D, d, R, Expressions...> FunctionType;
+  return Common::make_unique<FunctionType>(order, FunctionType::static_id(), expressions...);
+}
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_EXPRESSION_STATIC_HH
@@ -0,0 +1,395 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <config.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "vectormath.hh"
+
+// Every operation has to be rounded on its own: fusing a multiplication and an addition where the instruction set
+// allows it would make the results depend on the CPU.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DXTF_VECTORMATH_X86 1
+// passing the vector types below to functions compiled without AVX would change the ABI, which never happens here
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+#ifndef DXTF_VECTORMATH_INLINE
+#define DXTF_VECTORMATH_INLINE inline __attribute__((always_inline))
+#endif
+
+// The kernels are written once for V = double (with I = unsigned long long) and for the vectors of the GCC vector
+// extension below, which the compiler maps to AVX2 or AVX-512 instructions in the functions marked with the respective
+// target. The helpers below hide the few places where scalars and vectors differ.
+
+typedef unsigned long long KernelBits;
+
+static DXTF_VECTORMATH_INLINE KernelBits AsBits(double x)
+{
+  KernelBits b;
+  std::memcpy(&b, &x, sizeof(b));
+  return b;
+}
+
+static DXTF_VECTORMATH_INLINE double AsValue(KernelBits b)
+{
+  double x;
+  std::memcpy(&x, &b, sizeof(x));
+  return x;
+}
+
+static DXTF_VECTORMATH_INLINE bool Less(double a, double b)
+{
+  return a < b;
+}
+
+static DXTF_VECTORMATH_INLINE bool NonZero(KernelBits b)
+{
+  return b != 0;
+}
+
+static DXTF_VECTORMATH_INLINE double Select(bool mask, double a, double b)
+{
+  return mask ? a : b;
+}
+
+static DXTF_VECTORMATH_INLINE KernelBits Select(bool mask, KernelBits a, KernelBits b)
+{
+  return mask ? a : b;
+}
+
+#ifdef DXTF_VECTORMATH_X86
+
+typedef double KernelVec4 __attribute__((vector_size(32)));
+typedef unsigned long long KernelBits4 __attribute__((vector_size(32)));
+typedef long long KernelMask4 __attribute__((vector_size(32)));
+typedef double KernelVec8 __attribute__((vector_size(64)));
+typedef unsigned long long KernelBits8 __attribute__((vector_size(64)));
+typedef long long KernelMask8 __attribute__((vector_size(64)));
+
+#define DXTF_VECTORMATH_HELPERS(V, I, M)                                                                              \
+  static DXTF_VECTORMATH_INLINE I AsBits(const V& x)                                                                  \
+  {                                                                                                                    \
+    return (I)x;                                                                                                       \
+  }                                                                                                                    \
+  static DXTF_VECTORMATH_INLINE V AsValue(const I& b)                                                                 \
+  {                                                                                                                    \
+    return (V)b;                                                                                                       \
+  }                                                                                                                    \
+  static DXTF_VECTORMATH_INLINE M Less(const V& a, double b)                                                          \
+  {                                                                                                                    \
+    return a < (V{} + b);                                                                                              \
+  }                                                                                                                    \
+  static DXTF_VECTORMATH_INLINE M NonZero(const I& b)                                                                 \
+  {                                                                                                                    \
+    return b != (I{} + 0);                                                                                             \
+  }                                                                                                                    \
+  static DXTF_VECTORMATH_INLINE V Select(const M& mask, const V& a, const V& b)                                       \
+  {                                                                                                                    \
+    return mask ? a : b;                                                                                               \
+  }                                                                                                                    \
+  static DXTF_VECTORMATH_INLINE I Select(const M& mask, const I& a, const I& b)                                       \
+  {                                                                                                                    \
+    return mask ? a : b;                                                                                               \
+  }
+
+DXTF_VECTORMATH_HELPERS(KernelVec4, KernelBits4, KernelMask4)
+DXTF_VECTORMATH_HELPERS(KernelVec8, KernelBits8, KernelMask8)
+
+#undef DXTF_VECTORMATH_HELPERS
+
+#endif // DXTF_VECTORMATH_X86
+
+static const double kernel_magic = 0x1.8p52; // adding and subtracting it rounds to an integer
+
+// Reduces x to r = x - k pi/2 with |r| <= pi/4 as the sum y + yy of two doubles and evaluates the polynomial
+// approximations of sin(y + yy) and cos(y + yy) of fdlibm. pi/2 is split into the parts of fdlibm, the first three of
+// which have 33 bits, so their products with k are exact for |k| < 2^20. The rounding errors of subtracting them are
+// carried along, so the reduction stays accurate if x is close to a multiple of pi/2.
+template <class V, class I>
+static DXTF_VECTORMATH_INLINE V SinCosKernel(const V& x, KernelBits quadrant)
+{
+  V kk = x * 6.36619772367581382433e-01 + kernel_magic;
+  const I q = AsBits(kk) - AsBits(kernel_magic) + quadrant;
+  kk = kk - kernel_magic;
+  const V t1 = x - kk * 1.57079632673412561417e+00;
+  const V w2 = kk * 6.07710050630396597660e-11;
+  const V t2 = t1 - w2;
+  const V e2 = (t1 - t2) - w2;
+  const V w3 = kk * 2.02226624871116645580e-21;
+  const V r = t2 - w3;
+  const V w = kk * 8.47842766036889956997e-32 - ((t2 - r) - w3) - e2;
+  const V y = r - w;
+  const V yy = (r - y) - w;
+  const V z = y * y;
+  const V v = z * y;
+  const V sp = 8.33333333332248946124e-03
+               + z * (-1.98412698298579493134e-04
+                      + z * (2.75573137070700676789e-06
+                             + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+  const V s = y - ((z * (0.5 * yy - v * sp) - yy) - v * -1.66666666666666324348e-01);
+  const V hz = 0.5 * z;
+  const V cw = 1. - hz;
+  const V c = cw
+              + (((1. - cw) - hz)
+                 + (z * z
+                        * (4.16666666666666019037e-02
+                           + z * (-1.38888888888741095749e-03
+                                  + z * (2.48015872894767294178e-05
+                                         + z * (-2.75573143513906633035e-07
+                                                + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))))
+                    - y * yy));
+  // sin(r + q pi/2) is sin(r), cos(r), -sin(r), -cos(r) for q = 0, 1, 2, 3 (mod 4)
+  const V sc = Select(NonZero(q & 1), c, s);
+  return AsValue(AsBits(sc) ^ ((q & 2) << 62));
+}
+
+// Reduces x to r = x - n log(2) with |r| <= log(2)/2 and approximates exp(r) as fdlibm does
+template <class V, class I>
+static DXTF_VECTORMATH_INLINE V ExpKernel(const V& x)
+{
+  V kk = x * 1.44269504088896338700e+00 + kernel_magic;
+  const I n = AsBits(kk) - AsBits(kernel_magic);
+  kk = kk - kernel_magic;
+  const V hi = x - kk * 6.93147180369123816490e-01;
+  const V lo = kk * 1.90821492927058770002e-10;
+  const V r = hi - lo;
+  const V z = r * r;
+  const V c = r
+              - z * (1.66666666666666019037e-01
+                     + z * (-2.77777777770155933842e-03
+                            + z * (6.61375632143793436117e-05
+                                   + z * (-1.65339022054652515390e-06 + z * 4.13813679705723846039e-08))));
+  const V e = 1. - ((lo - (r * c) / (2. - c)) - hi);
+  return e * AsValue((n + 1023) << 52);
+}
+
+// Splits x = m 2^e with sqrt(1/2) <= m < sqrt(2) and approximates log(m) as fdlibm does
+template <class V, class I>
+static DXTF_VECTORMATH_INLINE V LogKernel(const V& x)
+{
+  const I bits = AsBits(x);
+  const V m = AsValue((bits & 0x000fffffffffffffULL) | 0x3fe0000000000000ULL);
+  const auto small = Less(m, 7.07106781186547524401e-1);
+  const I e = (bits >> 52) - Select(small, (I{} + 1023), (I{} + 1022));
+  const V f = Select(small, m + m - 1., m - 1.);
+  const V fe = AsValue(e + AsBits(kernel_magic)) - kernel_magic;
+  const V s = f / (2. + f);
+  const V z = s * s;
+  const V w = z * z;
+  const V t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+  const V t2 =
+      z * (6.666666666666735130e-01
+           + w * (2.857142874366239149e-01 + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+  const V hfsq = 0.5 * f * f;
+  return fe * 6.93147180369123816490e-01 - ((hfsq - (s * (hfsq + (t2 + t1)) + fe * 1.90821492927058770002e-10)) - f);
+}
+
+struct SinKernelType
+{
+  template <class V, class I>
+  static DXTF_VECTORMATH_INLINE V apply(const V& x)
+  {
+    return SinCosKernel<V, I>(x, 0);
+  }
+  static bool in_range(double x)
+  {
+    return std::abs(x) <= 0x1p19;
+  }
+  static double fallback(double x)
+  {
+    return std::sin(x);
+  }
+};
+
+struct CosKernelType
+{
+  template <class V, class I>
+  static DXTF_VECTORMATH_INLINE V apply(const V& x)
+  {
+    return SinCosKernel<V, I>(x, 1);
+  }
+  static bool in_range(double x)
+  {
+    return std::abs(x) <= 0x1p19;
+  }
+  static double fallback(double x)
+  {
+    return std::cos(x);
+  }
+};
+
+struct ExpKernelType
+{
+  template <class V, class I>
+  static DXTF_VECTORMATH_INLINE V apply(const V& x)
+  {
+    return ExpKernel<V, I>(x);
+  }
+  static bool in_range(double x)
+  {
+    return std::abs(x) <= 708.;
+  }
+  static double fallback(double x)
+  {
+    return std::exp(x);
+  }
+};
+
+struct LogKernelType
+{
+  template <class V, class I>
+  static DXTF_VECTORMATH_INLINE V apply(const V& x)
+  {
+    return LogKernel<V, I>(x);
+  }
+  static bool in_range(double x)
+  {
+    return x >= DBL_MIN && x <= DBL_MAX;
+  }
+  static double fallback(double x)
+  {
+    return std::log(x);
+  }
+};
+
+template <class K>
+static double ScalarKernel(double x)
+{
+  return K::in_range(x) ? K::template apply<double, KernelBits>(x) : K::fallback(x);
+}
+
+template <class K>
+static void ScalarKernels(const double* x, double* y, int n)
+{
+  for (int j = 0; j < n; j++)
+    y[j] = ScalarKernel<K>(x[j]);
+}
+
+#ifdef DXTF_VECTORMATH_X86
+
+template <class K, class V, class I>
+static DXTF_VECTORMATH_INLINE void VectorKernels(const double* x, double* y, int n)
+{
+  const int w = sizeof(V) / sizeof(double);
+  int j = 0;
+  for (; j + w <= n; j += w) {
+    V v;
+    std::memcpy(&v, x + j, sizeof(v));
+    const V r = K::template apply<V, I>(v);
+    std::memcpy(y + j, &r, sizeof(r));
+    for (int l = 0; l < w; l++)
+      if (!K::in_range(v[l]))
+        y[j + l] = K::fallback(v[l]);
+  }
+  for (; j < n; j++)
+    y[j] = ScalarKernel<K>(x[j]);
+}
+
+template <class K>
+__attribute__((target("avx2"))) static void Avx2Kernels(const double* x, double* y, int n)
+{
+  VectorKernels<K, KernelVec4, KernelBits4>(x, y, n);
+}
+
+template <class K>
+__attribute__((target("avx512f"))) static void Avx512Kernels(const double* x, double* y, int n)
+{
+  VectorKernels<K, KernelVec8, KernelBits8>(x, y, n);
+}
+
+#endif // DXTF_VECTORMATH_X86
+
+static int DetectKernelWidth()
+{
+  const char* env = std::getenv("DXT_FUNCTIONS_EXPRESSION_SIMD");
+  if (env != nullptr && std::string(env) == "0")
+    return 1;
+#ifdef DXTF_VECTORMATH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return 8;
+  if (__builtin_cpu_supports("avx2"))
+    return 4;
+#endif
+  return 1;
+}
+
+int KernelWidth()
+{
+  static const int width = DetectKernelWidth();
+  return width;
+}
+
+template <class K>
+static void Kernels(const double* x, double* y, int n)
+{
+#ifdef DXTF_VECTORMATH_X86
+  switch (KernelWidth()) {
+    case 8:
+      Avx512Kernels<K>(x, y, n);
+      return;
+    case 4:
+      Avx2Kernels<K>(x, y, n);
+      return;
+    default:
+      break;
+  }
+#endif
+  ScalarKernels<K>(x, y, n);
+}
+
+double KernelSin(double x)
+{
+  return ScalarKernel<SinKernelType>(x);
+}
+
+double KernelCos(double x)
+{
+  return ScalarKernel<CosKernelType>(x);
+}
+
+double KernelExp(double x)
+{
+  return ScalarKernel<ExpKernelType>(x);
+}
+
+double KernelLog(double x)
+{
+  return ScalarKernel<LogKernelType>(x);
+}
+
+void KernelSin(const double* x, double* y, int n)
+{
+  Kernels<SinKernelType>(x, y, n);
+}
+
+void KernelCos(const double* x, double* y, int n)
+{
+  Kernels<CosKernelType>(x, y, n);
+}
+
+void KernelExp(const double* x, double* y, int n)
+{
+  Kernels<ExpKernelType>(x, y, n);
+}
+
+void KernelLog(const double* x, double* y, int n)
+{
+  Kernels<LogKernelType>(x, y, n);
+}
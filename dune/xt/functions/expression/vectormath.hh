@@ -0,0 +1,32 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_EXPRESSION_VECTORMATH_HH
+#define DUNE_XT_FUNCTIONS_EXPRESSION_VECTORMATH_HH
+
+// sin, cos, exp and log as used by the ...Val() functions of mathexpr.cc, within one ulp of the results of libm.
+// Each comes for one value and for n values at once, the latter uses AVX-512 or AVX2 if the CPU supports them (see
+// KernelWidth()). All of them perform the same floating point operations, so the results are bit-for-bit identical
+// for one value, for n values and on every CPU. Arguments outside of the range of the polynomial approximations
+// (|x| > 2^19 for sin and cos, |x| > 708 for exp, no positive normal number for log) are passed to libm.
+
+double KernelSin(double x);
+double KernelCos(double x);
+double KernelExp(double x);
+double KernelLog(double x);
+
+// y[j] = KernelSin(x[j]) for 0 <= j < n, x and y may be the same
+void KernelSin(const double* x, double* y, int n);
+void KernelCos(const double* x, double* y, int n);
+void KernelExp(const double* x, double* y, int n);
+void KernelLog(const double* x, double* y, int n);
+
+// Number of values the functions for n values compute at once: 8 (AVX-512), 4 (AVX2) or 1 if the CPU supports
+// neither or the environment variable DXT_FUNCTIONS_EXPRESSION_SIMD is set to 0
+int KernelWidth();
+
+#endif // DUNE_XT_FUNCTIONS_EXPRESSION_VECTORMATH_HH
@@ -54,6 +54,7 @@ public:
   typedef typename BaseType::RangeFieldType RangeFieldType;
   static const size_t dimRange = BaseType::dimRange;
   typedef typename BaseType::RangeType RangeType;
+  typedef StaticGlobalLocalfunction<ThisType> StaticLocalfunctionType;
 
   typedef Common::FieldVector<DomainFieldType, dimDomain> StuffDomainType;
   typedef Common::FieldVector<RangeFieldType, dimRange> StuffRangeType;
@@ -132,7 +133,22 @@ public:
     return 3 * dimDomain;
   }
 
-  virtual void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const override
+  virtual void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const override
+  {
+    evaluate_static(xx, ret, mu);
+  }
+
+  /**
+   * \name ´´Statically dispatched (and inlinable) counterparts of local_function() and evaluate().''
+   * \sa   StaticLocalfunctionInterface
+   * \{
+   **/
+  StaticLocalfunctionType static_local_function(const EntityType& entity) const
+  {
+    return StaticLocalfunctionType(*this, entity);
+  }
+
+  void evaluate_static(const DomainType& xx, RangeType& ret, const Common::Parameter& /*mu*/ = {}) const
   {
     ret = value_;
     for (size_t dd = 0; dd < dimDomain; ++dd) {
@@ -159,7 +175,8 @@ public:
         break;
       }
     }
-  } // ... evaluate(...)
+  } // ... evaluate_static(...)
+  /* \} */
 
 private:
   void check_input() const
@@ -17,6 +17,7 @@
 #include "interfaces/localizable-flux-function.hh"
 #include "interfaces/global-function.hh"
 #include "interfaces/global-flux-function.hh"
+#include "interfaces/static-local-function.hh"
 #include "interfaces.lib.hh"
 
 #endif // DUNE_XT_FUNCTIONS_INTERFACES_HH
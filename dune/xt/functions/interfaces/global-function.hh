@@ -12,6 +12,11 @@
 #ifndef DUNE_XT_FUNCTIONS_INTERFACES_GLOBAL_FUNCTION_HH
 #define DUNE_XT_FUNCTIONS_INTERFACES_GLOBAL_FUNCTION_HH
 
+#include <algorithm>
+#include <vector>
+
+#include <dune/xt/functions/arena.hh>
+
 #include "localizable-function.hh"
 
 namespace Dune {
@@ -45,6 +50,8 @@ public:
   typedef typename BaseType::DomainType DomainType;
   typedef typename BaseType::RangeType RangeType;
   typedef typename BaseType::JacobianRangeType JacobianRangeType;
+  typedef typename BaseType::HessianRangeType HessianRangeType;
+  typedef typename LocalfunctionType::StridedValuesViewType StridedValuesViewType;
 
   virtual ~GlobalFunctionInterface()
   {
@@ -73,9 +80,102 @@ public:
     return ret;
   }
 
+  /**
+   * \brief Evaluates the function and its jacobian at the same point, which the default does by calling evaluate() and
+   *        jacobian(). Functions computing both from the same intermediate values should override this.
+   */
+  virtual void evaluate_with_jacobian(const DomainType& xx,
+                                      RangeType& value,
+                                      JacobianRangeType& derivative,
+                                      const Common::Parameter& mu = {}) const
+  {
+    evaluate(xx, value, mu);
+    jacobian(xx, derivative, mu);
+  }
+
+  /**
+   * \brief Evaluates at all points at once, which the local functions of this function use to evaluate at all points
+   *        of a quadrature (see LocalfunctionInterface). The default calls evaluate() once per point.
+   * \attention ret will be resized!
+   */
+  virtual void
+  evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
+  {
+    ret.resize(xx.size());
+    for (size_t pp = 0; pp < xx.size(); ++pp)
+      evaluate(xx[pp], ret[pp], mu);
+  }
+
+  /**
+   * \sa evaluate(const std::vector<DomainType>&, ...)
+   * \attention ret will be resized!
+   */
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const
+  {
+    ret.resize(xx.size());
+    for (size_t pp = 0; pp < xx.size(); ++pp)
+      jacobian(xx[pp], ret[pp], mu);
+  }
+
+  /**
+   * \brief Evaluates at all points at once into ret(cc, 0, pp), which the local functions of this function use for
+   *        their component-major evaluation (see LocalfunctionSetInterface). The default adapts
+   *        evaluate(const std::vector<DomainType>&, std::vector<RangeType>&, ...).
+   */
+  virtual void
+  evaluate(const std::vector<DomainType>& xx, const StridedValuesViewType& ret, const Common::Parameter& mu = {}) const
+  {
+    assert(ret.num_functions() >= 1 && ret.num_points() >= xx.size());
+    std::vector<RangeType> values;
+    evaluate(xx, values, mu);
+    for (size_t pp = 0; pp < values.size(); ++pp)
+      ret.set(0, pp, values[pp]);
+  }
+
+  //! \sa evaluate(const std::vector<DomainType>&, const StridedValuesViewType&, ...)
+  virtual void
+  jacobian(const std::vector<DomainType>& xx, const StridedValuesViewType& ret, const Common::Parameter& mu = {}) const
+  {
+    assert(ret.num_functions() >= 1 && ret.num_points() >= xx.size());
+    std::vector<JacobianRangeType> values;
+    jacobian(xx, values, mu);
+    for (size_t pp = 0; pp < values.size(); ++pp)
+      ret.set(0, pp, values[pp]);
+  }
+
+  //! \sa LocalfunctionInterface::hessian
+  virtual void hessian(const DomainType& /*xx*/, HessianRangeType& /*ret*/, const Common::Parameter& /*mu*/ = {}) const
+  {
+    DUNE_THROW(NotImplemented, "You have to implement it if you intend to use it!");
+  }
+
+  HessianRangeType hessian(const DomainType& xx, const Common::Parameter& mu = {}) const
+  {
+    HessianRangeType ret;
+    HessianRangeTypeSelector<domainDim, RangeFieldImp, rangeDim, rangeDimCols>::set_zero(ret);
+    hessian(xx, ret, mu);
+    return ret;
+  }
+
+  /**
+   * \brief Computes bounds lower <= value <= upper (componentwise), which hold for all points x with
+   *        lower_corner <= x <= upper_corner (componentwise).
+   * \return false if this function cannot guarantee any bounds (the default), lower and upper are not touched then
+   */
+  virtual bool bounds(const DomainType& /*lower_corner*/,
+                      const DomainType& /*upper_corner*/,
+                      RangeType& /*lower*/,
+                      RangeType& /*upper*/,
+                      const Common::Parameter& /*mu*/ = {}) const
+  {
+    return false;
+  }
+
   virtual std::unique_ptr<LocalfunctionType> local_function(const EntityImp& entity) const override final
   {
-    return Common::make_unique<Localfunction>(entity, *this);
+    return LocalfunctionArena::make_unique<Localfunction>(entity, *this);
   }
 
   virtual std::string type() const override
@@ -103,6 +203,12 @@ private:
     {
     }
 
+    virtual void bind(const EntityImp& ent) override final
+    {
+      this->bind_entity(ent);
+      geometry_ = ent.geometry();
+    }
+
     virtual void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const override final
     {
       const auto xx_global = geometry_.global(xx);
@@ -116,13 +222,151 @@ private:
       global_function_.jacobian(xx_global, ret, mu);
     }
 
+    virtual void evaluate_with_jacobian(const DomainType& xx,
+                                        RangeType& value,
+                                        JacobianRangeType& derivative,
+                                        const Common::Parameter& mu = {}) const override final
+    {
+      const auto xx_global = geometry_.global(xx);
+      global_function_.evaluate_with_jacobian(xx_global, value, derivative, mu);
+    }
+
+    virtual void
+    hessian(const DomainType& xx, HessianRangeType& ret, const Common::Parameter& mu = {}) const override final
+    {
+      const auto xx_global = geometry_.global(xx);
+      global_function_.hessian(xx_global, ret, mu);
+    }
+
+    virtual void evaluate(const typename LocalfunctionType::QuadratureRuleType& quadrature,
+                          std::vector<RangeType>& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      evaluate_all(quadrature, ret, mu);
+    }
+
+    virtual void evaluate(const std::vector<DomainType>& xx,
+                          std::vector<RangeType>& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      evaluate_all(xx, ret, mu);
+    }
+
+    virtual void jacobian(const typename LocalfunctionType::QuadratureRuleType& quadrature,
+                          std::vector<JacobianRangeType>& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      jacobian_all(quadrature, ret, mu);
+    }
+
+    virtual void jacobian(const std::vector<DomainType>& xx,
+                          std::vector<JacobianRangeType>& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      jacobian_all(xx, ret, mu);
+    }
+
+    virtual void evaluate(const typename LocalfunctionType::QuadratureRuleType& quadrature,
+                          const StridedValuesViewType& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      global_function_.evaluate(global_points(quadrature), ret, mu);
+    }
+
+    virtual void evaluate(const std::vector<DomainType>& xx,
+                          const StridedValuesViewType& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      global_function_.evaluate(global_points(xx), ret, mu);
+    }
+
+    virtual void jacobian(const typename LocalfunctionType::QuadratureRuleType& quadrature,
+                          const StridedValuesViewType& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      global_function_.jacobian(global_points(quadrature), ret, mu);
+    }
+
+    virtual void jacobian(const std::vector<DomainType>& xx,
+                          const StridedValuesViewType& ret,
+                          const Common::Parameter& mu = {}) const override final
+    {
+      global_function_.jacobian(global_points(xx), ret, mu);
+    }
+
     virtual size_t order(const Common::Parameter& mu = {}) const override final
     {
       return global_function_.order(mu);
     }
 
+    /**
+     * \note Uses the bounding box of the corners of the entity, which contains the whole entity for affine and
+     *       multilinear geometries.
+     */
+    virtual bool bounds(RangeType& lower, RangeType& upper, const Common::Parameter& mu = {}) const override final
+    {
+      DomainType lower_corner = geometry_.corner(0);
+      DomainType upper_corner = lower_corner;
+      for (int cc = 1; cc < geometry_.corners(); ++cc) {
+        const auto corner = geometry_.corner(cc);
+        for (size_t dd = 0; dd < domainDim; ++dd) {
+          lower_corner[dd] = std::min(lower_corner[dd], corner[dd]);
+          upper_corner[dd] = std::max(upper_corner[dd], corner[dd]);
+        }
+      }
+      return global_function_.bounds(lower_corner, upper_corner, lower, upper, mu);
+    }
+
   private:
-    const typename EntityImp::Geometry geometry_;
+    // maps all points at once, the mapping of an affine geometry is the same matrix and offset for all of them
+    template <class PointsType>
+    std::vector<DomainType> global_points(const PointsType& points) const
+    {
+      std::vector<DomainType> xx_global(points.size());
+      size_t pp = 0;
+      if (geometry_.affine()) {
+        const DomainType origin(0);
+        const auto offset = geometry_.global(origin);
+        const auto jacobian_transposed = geometry_.jacobianTransposed(origin);
+        for (const auto& point : points) {
+          xx_global[pp] = offset;
+          jacobian_transposed.umtv(LocalfunctionType::position_of(point), xx_global[pp]);
+          ++pp;
+        }
+      } else {
+        for (const auto& point : points)
+          xx_global[pp++] = geometry_.global(LocalfunctionType::position_of(point));
+      }
+      return xx_global;
+    } // ... global_points(...)
+
+    template <class PointsType>
+    void evaluate_all(const PointsType& points, std::vector<RangeType>& ret, const Common::Parameter& mu) const
+    {
+      assert(ret.size() >= points.size());
+      if (ret.size() == points.size()) {
+        global_function_.evaluate(global_points(points), ret, mu);
+      } else {
+        std::vector<RangeType> values;
+        global_function_.evaluate(global_points(points), values, mu);
+        std::copy(values.begin(), values.end(), ret.begin());
+      }
+    }
+
+    template <class PointsType>
+    void jacobian_all(const PointsType& points, std::vector<JacobianRangeType>& ret, const Common::Parameter& mu) const
+    {
+      assert(ret.size() >= points.size());
+      if (ret.size() == points.size()) {
+        global_function_.jacobian(global_points(points), ret, mu);
+      } else {
+        std::vector<JacobianRangeType> values;
+        global_function_.jacobian(global_points(points), values, mu);
+        std::copy(values.begin(), values.end(), ret.begin());
+      }
+    }
+
+    typename EntityImp::Geometry geometry_;
     const ThisType& global_function_;
   }; // class Localfunction
 
@@ -21,8 +21,11 @@
 #include <dune/geometry/quadraturerules.hh>
 #include <dune/geometry/referenceelements.hh>
 
+#include <dune/xt/common/exceptions.hh>
 #include <dune/xt/common/parameter.hh>
 
+#include <dune/xt/functions/strided-values.hh>
+
 namespace Dune {
 namespace XT {
 namespace Functions {
@@ -52,6 +55,34 @@ struct JacobianRangeTypeSelector<dimDomain, RangeFieldType, dimRange, 1>
   typedef Dune::FieldMatrix<RangeFieldType, dimRange, dimDomain> type;
 };
 
+//! ret[cc][rr][ii][jj] is the second derivative of component (rr, cc) w.r.t. x_ii and x_jj, ret[rr][ii][jj] if rC = 1
+template <size_t dimDomain, class RangeFieldType, size_t dimRange, size_t dimRangeCols>
+struct HessianRangeTypeSelector
+{
+  typedef Dune::FieldVector<Dune::FieldVector<Dune::FieldMatrix<RangeFieldType, dimDomain, dimDomain>, dimRange>,
+                            dimRangeCols>
+      type;
+
+  static void set_zero(type& ret)
+  {
+    for (auto& col : ret)
+      for (auto& row : col)
+        row = 0.;
+  }
+};
+
+template <size_t dimDomain, class RangeFieldType, size_t dimRange>
+struct HessianRangeTypeSelector<dimDomain, RangeFieldType, dimRange, 1>
+{
+  typedef Dune::FieldVector<Dune::FieldMatrix<RangeFieldType, dimDomain, dimDomain>, dimRange> type;
+
+  static void set_zero(type& ret)
+  {
+    for (auto& row : ret)
+      row = 0.;
+  }
+};
+
 template <size_t dimDomain, class RangeFieldImp, size_t dimRange, size_t dimRangeCols>
 struct RangeColumnHelper
 {
@@ -144,6 +175,9 @@ public:
   static const constexpr size_t dimRangeCols = rangeDimCols;
   typedef typename RangeTypeSelector<RangeFieldType, dimRange, dimRangeCols>::type RangeType;
   typedef typename JacobianRangeTypeSelector<dimDomain, RangeFieldType, dimRange, dimRangeCols>::type JacobianRangeType;
+  typedef typename HessianRangeTypeSelector<dimDomain, RangeFieldType, dimRange, dimRangeCols>::type HessianRangeType;
+  typedef Dune::QuadratureRule<DomainFieldType, dimDomain> QuadratureRuleType;
+  typedef StridedValuesView<RangeFieldType> StridedValuesViewType;
 
   typedef EntityType E;
   typedef DomainFieldType D;
@@ -153,7 +187,7 @@ public:
   static const constexpr size_t rC = dimRangeCols;
 
   LocalfunctionSetInterface(const EntityType& ent)
-    : entity_(ent)
+    : entity_(&ent)
   {
   }
 
@@ -161,7 +195,18 @@ public:
 
   virtual const EntityType& entity() const
   {
-    return entity_;
+    return *entity_;
+  }
+
+  /**
+   * \brief Binds this to another entity, which allows to create a local function once (e.g., per thread) and to reuse
+   *        it for all entities of a grid walk, instead of calling local_function() for each of them.
+   * \note  The default throws, implementations which can be rebound call bind_entity() and rebind everything they
+   *        obtained from the entity.
+   */
+  virtual void bind(const EntityType& /*ent*/)
+  {
+    DUNE_THROW(NotImplemented, "This local function cannot be rebound, create a new one for each entity!");
   }
 
   /**
@@ -197,9 +242,57 @@ public:
     jacobian(xx, ret, mu);
     return ret;
   }
+
+  /**
+   * \brief Evaluates all functions of this set at all points of a quadrature at once into ret, where ret(cc, ii, pp)
+   *        is the cc-th component (see FlatComponents) of the value of the ii-th function at the pp-th point. Thus ret
+   *        has to have FlatComponents<RangeType>::size components, at least size() functions and at least
+   *        quadrature.size() points.
+   * \note  The default calls evaluate() once per point and scatters the values, sets which can compute all values of
+   *        one component at once should override this and the methods below.
+   */
+  virtual void evaluate(const QuadratureRuleType& quadrature,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const
+  {
+    evaluate_strided(quadrature, ret, mu);
+  }
+
+  //! evaluate at N points, \sa evaluate(const QuadratureRuleType&, const StridedValuesViewType&, ...)
+  virtual void
+  evaluate(const std::vector<DomainType>& xx, const StridedValuesViewType& ret, const Common::Parameter& mu = {}) const
+  {
+    evaluate_strided(xx, ret, mu);
+  }
+
+  //! jacobian at N quadrature points, ret has to have FlatComponents<JacobianRangeType>::size components
+  virtual void jacobian(const QuadratureRuleType& quadrature,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const
+  {
+    jacobian_strided(quadrature, ret, mu);
+  }
+
+  //! jacobian at N points, \sa jacobian(const QuadratureRuleType&, const StridedValuesViewType&, ...)
+  virtual void
+  jacobian(const std::vector<DomainType>& xx, const StridedValuesViewType& ret, const Common::Parameter& mu = {}) const
+  {
+    jacobian_strided(xx, ret, mu);
+  }
   /* \} */
 
 protected:
+  //! allows overrides of the methods above to treat both kinds of points alike
+  static const DomainType& position_of(const DomainType& xx)
+  {
+    return xx;
+  }
+
+  static const DomainType& position_of(const Dune::QuadraturePoint<DomainFieldType, dimDomain>& point)
+  {
+    return point.position();
+  }
+
   bool is_a_valid_point(const DomainType&
 #ifndef DUNE_XT_FUNCTIONS_DISABLE_CHECKS
                             xx
@@ -216,7 +309,41 @@ protected:
 #endif
   }
 
-  const EntityType& entity_;
+  void bind_entity(const EntityType& ent)
+  {
+    entity_ = &ent;
+  }
+
+  const EntityType* entity_;
+
+private:
+  template <class PointsType>
+  void evaluate_strided(const PointsType& points, const StridedValuesViewType& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.num_functions() >= size() && ret.num_points() >= points.size());
+    std::vector<RangeType> values(size(), RangeType(0));
+    size_t pp = 0;
+    for (const auto& point : points) {
+      evaluate(position_of(point), values, mu);
+      for (size_t ii = 0; ii < values.size(); ++ii)
+        ret.set(ii, pp, values[ii]);
+      ++pp;
+    }
+  } // ... evaluate_strided(...)
+
+  template <class PointsType>
+  void jacobian_strided(const PointsType& points, const StridedValuesViewType& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.num_functions() >= size() && ret.num_points() >= points.size());
+    std::vector<JacobianRangeType> values(size(), JacobianRangeType(0));
+    size_t pp = 0;
+    for (const auto& point : points) {
+      jacobian(position_of(point), values, mu);
+      for (size_t ii = 0; ii < values.size(); ++ii)
+        ret.set(ii, pp, values[ii]);
+      ++pp;
+    }
+  } // ... jacobian_strided(...)
 }; // class LocalfunctionSetInterface
 
 
@@ -243,6 +370,9 @@ public:
   typedef typename BaseType::DomainType DomainType;
   typedef typename BaseType::RangeType RangeType;
   typedef typename BaseType::JacobianRangeType JacobianRangeType;
+  typedef typename BaseType::HessianRangeType HessianRangeType;
+  typedef typename BaseType::QuadratureRuleType QuadratureRuleType;
+  typedef typename BaseType::StridedValuesViewType StridedValuesViewType;
 
   LocalfunctionInterface(const EntityType& ent)
     : BaseType(ent)
@@ -306,10 +436,53 @@ public:
     return ret;
   }
 
-  //! evaluate at N quadrature points into vector of size >= N
-  void evaluate(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
-                std::vector<RangeType>& ret,
-                const Common::Parameter& mu = {})
+  /**
+   * \brief Evaluates the function and its jacobian at the same point, which the default does by calling evaluate() and
+   *        jacobian(). Functions computing both from the same intermediate values should override this.
+   */
+  virtual void evaluate_with_jacobian(const DomainType& xx,
+                                      RangeType& value,
+                                      JacobianRangeType& derivative,
+                                      const Common::Parameter& mu = {}) const
+  {
+    evaluate(xx, value, mu);
+    jacobian(xx, derivative, mu);
+  }
+
+  /**
+   * \brief Computes the second derivatives, see HessianRangeTypeSelector for the layout of ret.
+   * \note  The default throws, only functions which know their second derivatives override this.
+   */
+  virtual void hessian(const DomainType& /*xx*/, HessianRangeType& /*ret*/, const Common::Parameter& /*mu*/ = {}) const
+  {
+    DUNE_THROW(NotImplemented, "This local function does not provide its hessian!");
+  }
+
+  HessianRangeType hessian(const DomainType& xx, const Common::Parameter& mu = {}) const
+  {
+    HessianRangeType ret;
+    HessianRangeTypeSelector<dimDomain, typename BaseType::RangeFieldType, BaseType::dimRange, BaseType::dimRangeCols>::
+        set_zero(ret);
+    hessian(xx, ret, mu);
+    return ret;
+  }
+
+  /**
+   * \brief Computes bounds lower <= value <= upper (componentwise), which hold everywhere on the entity.
+   * \return false if this function cannot guarantee any bounds (the default), lower and upper are not touched then
+   */
+  virtual bool bounds(RangeType& /*lower*/, RangeType& /*upper*/, const Common::Parameter& /*mu*/ = {}) const
+  {
+    return false;
+  }
+
+  /**
+   * \brief Evaluates at all points of a quadrature at once into ret, which has to have at least quadrature.size()
+   *        entries. The default calls evaluate() once per point, functions which can evaluate many points more
+   *        efficiently (e.g., by mapping them all at once) should override this and the method below.
+   */
+  virtual void
+  evaluate(const QuadratureRuleType& quadrature, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
   {
     assert(ret.size() >= quadrature.size());
     std::size_t i = 0;
@@ -317,17 +490,94 @@ public:
       evaluate(point.position(), ret[i++], mu);
   }
 
-  //! jacobian at N quadrature points into vector of size >= N
-  void jacobian(const Dune::QuadratureRule<DomainFieldType, dimDomain>& quadrature,
-                std::vector<JacobianRangeType>& ret,
-                const Common::Parameter& mu = {})
+  //! evaluate at N points into vector of size >= N, \sa evaluate(const QuadratureRuleType&, ...)
+  virtual void
+  evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
+  {
+    assert(ret.size() >= xx.size());
+    for (size_t pp = 0; pp < xx.size(); ++pp)
+      evaluate(xx[pp], ret[pp], mu);
+  }
+
+  //! jacobian at N quadrature points into vector of size >= N, \sa evaluate(const QuadratureRuleType&, ...)
+  virtual void jacobian(const QuadratureRuleType& quadrature,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const
   {
     assert(ret.size() >= quadrature.size());
     std::size_t i = 0;
     for (const auto& point : quadrature)
       jacobian(point.position(), ret[i++], mu);
   }
+
+  //! jacobian at N points into vector of size >= N, \sa evaluate(const QuadratureRuleType&, ...)
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const
+  {
+    assert(ret.size() >= xx.size());
+    for (size_t pp = 0; pp < xx.size(); ++pp)
+      jacobian(xx[pp], ret[pp], mu);
+  }
+
+  /**
+   * \brief Evaluates at all points of a quadrature at once into ret(cc, 0, pp), see
+   *        LocalfunctionSetInterface::evaluate(const QuadratureRuleType&, const StridedValuesViewType&, ...).
+   * \note  The default adapts evaluate(const QuadratureRuleType&, std::vector<RangeType>&, ...), and thus benefits from
+   *        its overrides. Functions which compute component-major values natively should override these methods, too.
+   */
+  virtual void evaluate(const QuadratureRuleType& quadrature,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const override
+  {
+    evaluate_strided(quadrature, ret, mu);
+  }
+
+  //! evaluate at N points, \sa evaluate(const QuadratureRuleType&, const StridedValuesViewType&, ...)
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const override
+  {
+    evaluate_strided(xx, ret, mu);
+  }
+
+  //! jacobian at N quadrature points, \sa evaluate(const QuadratureRuleType&, const StridedValuesViewType&, ...)
+  virtual void jacobian(const QuadratureRuleType& quadrature,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const override
+  {
+    jacobian_strided(quadrature, ret, mu);
+  }
+
+  //! jacobian at N points, \sa evaluate(const QuadratureRuleType&, const StridedValuesViewType&, ...)
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        const StridedValuesViewType& ret,
+                        const Common::Parameter& mu = {}) const override
+  {
+    jacobian_strided(xx, ret, mu);
+  }
   /* \} */
+
+private:
+  template <class PointsType>
+  void evaluate_strided(const PointsType& points, const StridedValuesViewType& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.num_functions() >= 1 && ret.num_points() >= points.size());
+    std::vector<RangeType> values(points.size());
+    evaluate(points, values, mu);
+    for (size_t pp = 0; pp < values.size(); ++pp)
+      ret.set(0, pp, values[pp]);
+  }
+
+  template <class PointsType>
+  void jacobian_strided(const PointsType& points, const StridedValuesViewType& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.num_functions() >= 1 && ret.num_points() >= points.size());
+    std::vector<JacobianRangeType> values(points.size());
+    jacobian(points, values, mu);
+    for (size_t pp = 0; pp < values.size(); ++pp)
+      ret.set(0, pp, values[pp]);
+  }
 }; // class LocalfunctionInterface
 
 
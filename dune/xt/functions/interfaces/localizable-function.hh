@@ -95,6 +95,7 @@ public:
   typedef typename LocalfunctionType::DomainType DomainType;
   typedef typename LocalfunctionType::RangeType RangeType;
   typedef typename LocalfunctionType::JacobianRangeType JacobianRangeType;
+  typedef typename LocalfunctionType::HessianRangeType HessianRangeType;
 
   static const bool available = false;
 
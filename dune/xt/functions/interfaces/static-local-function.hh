@@ -0,0 +1,479 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_INTERFACES_STATIC_LOCAL_FUNCTION_HH
+#define DUNE_XT_FUNCTIONS_INTERFACES_STATIC_LOCAL_FUNCTION_HH
+
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/xt/common/memory.hh>
+
+#include "local-functions.hh"
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+
+
+/**
+ * \brief Interface for local functions which are dispatched statically (CRTP), as a counterpart of
+ *        LocalfunctionInterface.
+ *
+ *        Since none of the methods are virtual and the local functions are handled by value, the compiler sees all
+ *        calls and may inline the evaluation of compositions of several functions, e.g. within the loop of an
+ *        assembler over the points of a quadrature:
+\code
+const auto difference = one - two;
+auto local_difference = difference.static_local_function(entity);
+for (auto&& ent : elements(grid_view)) {
+  local_difference.bind(ent);
+  local_difference.evaluate(quadrature, values);
+}
+\endcode
+ *        Functions provide these local functions by static_local_function() and the type StaticLocalfunctionType, use
+ *        StaticLocalfunction to obtain them for any localizable function. Such a local function may be handed to code
+ *        expecting a LocalfunctionInterface by wrapping it into a StaticLocalfunctionAdapter.
+ *
+ *        Imp has to implement
+\code
+void bind(const EntityType& ent); // has to call bind_entity(ent)
+size_t order(const Common::Parameter& mu = {}) const;
+void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const;
+void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const;
+\endcode
+ *        and has to bring the methods provided by this interface into scope (using BaseType::evaluate, ...).
+ */
+template <class Imp,
+          class EntityImp,
+          class DomainFieldImp,
+          size_t domainDim,
+          class RangeFieldImp,
+          size_t rangeDim,
+          size_t rangeDimCols = 1>
+class StaticLocalfunctionInterface
+{
+public:
+  //! the dynamic counterpart, \sa StaticLocalfunctionAdapter
+  typedef LocalfunctionInterface<EntityImp, DomainFieldImp, domainDim, RangeFieldImp, rangeDim, rangeDimCols>
+      InterfaceType;
+
+  typedef EntityImp EntityType;
+  typedef DomainFieldImp DomainFieldType;
+  static const constexpr size_t dimDomain = domainDim;
+  typedef typename InterfaceType::DomainType DomainType;
+  typedef RangeFieldImp RangeFieldType;
+  static const constexpr size_t dimRange = rangeDim;
+  static const constexpr size_t dimRangeCols = rangeDimCols;
+  typedef typename InterfaceType::RangeType RangeType;
+  typedef typename InterfaceType::JacobianRangeType JacobianRangeType;
+  typedef typename InterfaceType::QuadratureRuleType QuadratureRuleType;
+
+  StaticLocalfunctionInterface(const EntityType& ent)
+    : entity_(&ent)
+  {
+  }
+
+  const EntityType& entity() const
+  {
+    return *entity_;
+  }
+
+  /**
+   * \name ´´These methods are provided by the interface.''
+   * \{
+   **/
+  RangeType evaluate(const DomainType& xx, const Common::Parameter& mu = {}) const
+  {
+    RangeType ret(0);
+    as_imp().evaluate(xx, ret, mu);
+    return ret;
+  }
+
+  JacobianRangeType jacobian(const DomainType& xx, const Common::Parameter& mu = {}) const
+  {
+    JacobianRangeType ret(0);
+    as_imp().jacobian(xx, ret, mu);
+    return ret;
+  }
+
+  //! \sa LocalfunctionInterface::evaluate(const QuadratureRuleType&, ...)
+  void
+  evaluate(const QuadratureRuleType& quadrature, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
+  {
+    evaluate_all(quadrature, ret, mu);
+  }
+
+  void evaluate(const std::vector<DomainType>& xx, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
+  {
+    evaluate_all(xx, ret, mu);
+  }
+
+  void jacobian(const QuadratureRuleType& quadrature,
+                std::vector<JacobianRangeType>& ret,
+                const Common::Parameter& mu = {}) const
+  {
+    jacobian_all(quadrature, ret, mu);
+  }
+
+  void jacobian(const std::vector<DomainType>& xx,
+                std::vector<JacobianRangeType>& ret,
+                const Common::Parameter& mu = {}) const
+  {
+    jacobian_all(xx, ret, mu);
+  }
+  /* \} */
+
+protected:
+  void bind_entity(const EntityType& ent)
+  {
+    entity_ = &ent;
+  }
+
+  const Imp& as_imp() const
+  {
+    return static_cast<const Imp&>(*this);
+  }
+
+private:
+  static const DomainType& position_of(const DomainType& xx)
+  {
+    return xx;
+  }
+
+  static const DomainType& position_of(const Dune::QuadraturePoint<DomainFieldType, dimDomain>& point)
+  {
+    return point.position();
+  }
+
+  template <class PointsType>
+  void evaluate_all(const PointsType& points, std::vector<RangeType>& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.size() >= points.size());
+    size_t pp = 0;
+    for (const auto& point : points)
+      as_imp().evaluate(position_of(point), ret[pp++], mu);
+  }
+
+  template <class PointsType>
+  void jacobian_all(const PointsType& points, std::vector<JacobianRangeType>& ret, const Common::Parameter& mu) const
+  {
+    assert(ret.size() >= points.size());
+    size_t pp = 0;
+    for (const auto& point : points)
+      as_imp().jacobian(position_of(point), ret[pp++], mu);
+  }
+
+  const EntityType* entity_;
+}; // class StaticLocalfunctionInterface
+
+
+/**
+ * \brief Type erasure of a local function derived from StaticLocalfunctionInterface, which may thus be used wherever a
+ *        LocalfunctionInterface is expected. Only calls to the adapter itself are dispatched dynamically.
+ */
+template <class StaticLocalfunctionImp>
+class StaticLocalfunctionAdapter : public StaticLocalfunctionImp::InterfaceType
+{
+  typedef typename StaticLocalfunctionImp::InterfaceType BaseType;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+  using typename BaseType::QuadratureRuleType;
+
+  StaticLocalfunctionAdapter(StaticLocalfunctionImp&& local_function)
+    : BaseType(local_function.entity())
+    , local_function_(std::move(local_function))
+  {
+  }
+
+  virtual void bind(const EntityType& ent) override final
+  {
+    this->bind_entity(ent);
+    local_function_.bind(ent);
+  }
+
+  virtual size_t order(const Common::Parameter& mu = {}) const override final
+  {
+    return local_function_.order(mu);
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+  virtual void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.evaluate(xx, ret, mu);
+  }
+
+  virtual void
+  jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.jacobian(xx, ret, mu);
+  }
+
+  virtual void evaluate(const QuadratureRuleType& quadrature,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.evaluate(quadrature, ret, mu);
+  }
+
+  virtual void evaluate(const std::vector<DomainType>& xx,
+                        std::vector<RangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.evaluate(xx, ret, mu);
+  }
+
+  virtual void jacobian(const QuadratureRuleType& quadrature,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.jacobian(quadrature, ret, mu);
+  }
+
+  virtual void jacobian(const std::vector<DomainType>& xx,
+                        std::vector<JacobianRangeType>& ret,
+                        const Common::Parameter& mu = {}) const override final
+  {
+    local_function_.jacobian(xx, ret, mu);
+  }
+
+private:
+  StaticLocalfunctionImp local_function_;
+}; // class StaticLocalfunctionAdapter
+
+
+template <class StaticLocalfunctionImp>
+std::unique_ptr<typename StaticLocalfunctionImp::InterfaceType>
+make_local_function_adapter(StaticLocalfunctionImp local_function)
+{
+  return Common::make_unique<StaticLocalfunctionAdapter<StaticLocalfunctionImp>>(std::move(local_function));
+}
+
+
+/**
+ * \brief The statically dispatched local function of a global function, which calls its non-virtual methods
+ *        evaluate_static() and jacobian_static(), if available, and evaluate() and jacobian() otherwise.
+ */
+template <class GlobalFunctionImp>
+class StaticGlobalLocalfunction
+    : public StaticLocalfunctionInterface<StaticGlobalLocalfunction<GlobalFunctionImp>,
+                                          typename GlobalFunctionImp::EntityType,
+                                          typename GlobalFunctionImp::DomainFieldType,
+                                          GlobalFunctionImp::dimDomain,
+                                          typename GlobalFunctionImp::RangeFieldType,
+                                          GlobalFunctionImp::dimRange,
+                                          GlobalFunctionImp::dimRangeCols>
+{
+  typedef StaticLocalfunctionInterface<StaticGlobalLocalfunction<GlobalFunctionImp>,
+                                       typename GlobalFunctionImp::EntityType,
+                                       typename GlobalFunctionImp::DomainFieldType,
+                                       GlobalFunctionImp::dimDomain,
+                                       typename GlobalFunctionImp::RangeFieldType,
+                                       GlobalFunctionImp::dimRange,
+                                       GlobalFunctionImp::dimRangeCols>
+      BaseType;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+
+  StaticGlobalLocalfunction(const GlobalFunctionImp& global_function, const EntityType& ent)
+    : BaseType(ent)
+    , geometry_(ent.geometry())
+    , global_function_(global_function)
+  {
+  }
+
+  void bind(const EntityType& ent)
+  {
+    this->bind_entity(ent);
+    geometry_ = ent.geometry();
+  }
+
+  size_t order(const Common::Parameter& mu = {}) const
+  {
+    return global_function_.order(mu);
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    evaluate_global(global_function_, geometry_.global(xx), ret, mu, 0);
+  }
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    jacobian_global(global_function_, geometry_.global(xx), ret, mu, 0);
+  }
+
+private:
+  // the int overloads are preferred, if they are viable
+  template <class F>
+  static auto
+  evaluate_global(const F& function, const DomainType& xx, RangeType& ret, const Common::Parameter& mu, int)
+      -> decltype(function.evaluate_static(xx, ret, mu))
+  {
+    function.evaluate_static(xx, ret, mu);
+  }
+
+  template <class F>
+  static void
+  evaluate_global(const F& function, const DomainType& xx, RangeType& ret, const Common::Parameter& mu, long)
+  {
+    function.evaluate(xx, ret, mu);
+  }
+
+  template <class F>
+  static auto
+  jacobian_global(const F& function, const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu, int)
+      -> decltype(function.jacobian_static(xx, ret, mu))
+  {
+    function.jacobian_static(xx, ret, mu);
+  }
+
+  template <class F>
+  static void
+  jacobian_global(const F& function, const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu, long)
+  {
+    function.jacobian(xx, ret, mu);
+  }
+
+  typename EntityType::Geometry geometry_;
+  const GlobalFunctionImp& global_function_;
+}; // class StaticGlobalLocalfunction
+
+
+namespace internal {
+
+
+/**
+ * \brief Wraps the local function of a function which is not statically dispatched, to allow for compositions of
+ *        statically and dynamically dispatched functions.
+ */
+template <class FunctionType>
+class DynamicLocalfunction : public StaticLocalfunctionInterface<DynamicLocalfunction<FunctionType>,
+                                                                 typename FunctionType::EntityType,
+                                                                 typename FunctionType::DomainFieldType,
+                                                                 FunctionType::dimDomain,
+                                                                 typename FunctionType::RangeFieldType,
+                                                                 FunctionType::dimRange,
+                                                                 FunctionType::dimRangeCols>
+{
+  typedef StaticLocalfunctionInterface<DynamicLocalfunction<FunctionType>,
+                                       typename FunctionType::EntityType,
+                                       typename FunctionType::DomainFieldType,
+                                       FunctionType::dimDomain,
+                                       typename FunctionType::RangeFieldType,
+                                       FunctionType::dimRange,
+                                       FunctionType::dimRangeCols>
+      BaseType;
+
+public:
+  using typename BaseType::EntityType;
+  using typename BaseType::DomainType;
+  using typename BaseType::RangeType;
+  using typename BaseType::JacobianRangeType;
+  using typename BaseType::QuadratureRuleType;
+
+  DynamicLocalfunction(std::unique_ptr<typename FunctionType::LocalfunctionType>&& local_function)
+    : BaseType(local_function->entity())
+    , local_function_(std::move(local_function))
+  {
+  }
+
+  void bind(const EntityType& ent)
+  {
+    this->bind_entity(ent);
+    local_function_->bind(ent);
+  }
+
+  size_t order(const Common::Parameter& mu = {}) const
+  {
+    return local_function_->order(mu);
+  }
+
+  using BaseType::evaluate;
+  using BaseType::jacobian;
+
+  void evaluate(const DomainType& xx, RangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    local_function_->evaluate(xx, ret, mu);
+  }
+
+  void jacobian(const DomainType& xx, JacobianRangeType& ret, const Common::Parameter& mu = {}) const
+  {
+    local_function_->jacobian(xx, ret, mu);
+  }
+
+  // the wrapped local function may evaluate at many points more efficiently
+  void
+  evaluate(const QuadratureRuleType& quadrature, std::vector<RangeType>& ret, const Common::Parameter& mu = {}) const
+  {
+    local_function_->evaluate(quadrature, ret, mu);
+  }
+
+  void jacobian(const QuadratureRuleType& quadrature,
+                std::vector<JacobianRangeType>& ret,
+                const Common::Parameter& mu = {}) const
+  {
+    local_function_->jacobian(quadrature, ret, mu);
+  }
+
+private:
+  std::unique_ptr<typename FunctionType::LocalfunctionType> local_function_;
+}; // class DynamicLocalfunction
+
+
+} // namespace internal
+
+
+/**
+ * \brief Selects the statically dispatched local function of FunctionType: StaticLocalfunctionType, if FunctionType
+ *        provides static_local_function(), the wrapped local_function() otherwise.
+ */
+template <class FunctionType, class = void>
+struct StaticLocalfunction
+{
+  typedef internal::DynamicLocalfunction<FunctionType> type;
+
+  static type create(const FunctionType& function, const typename FunctionType::EntityType& entity)
+  {
+    return type(function.local_function(entity));
+  }
+};
+
+template <class FunctionType>
+struct StaticLocalfunction<FunctionType,
+                           typename std::conditional<true, void, typename FunctionType::StaticLocalfunctionType>::type>
+{
+  typedef typename FunctionType::StaticLocalfunctionType type;
+
+  static type create(const FunctionType& function, const typename FunctionType::EntityType& entity)
+  {
+    return function.static_local_function(entity);
+  }
+};
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_INTERFACES_STATIC_LOCAL_FUNCTION_HH
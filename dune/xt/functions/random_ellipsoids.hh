@@ -25,6 +25,7 @@
 #include <dune/xt/common/fvector.hh>
 #include <dune/xt/common/random.hh>
 
+#include <dune/xt/functions/arena.hh>
 #include <dune/xt/functions/interfaces.hh>
 
 namespace Dune {
@@ -302,7 +303,7 @@ public:
       }
     }
     std::vector<EllipsoidType> tmp = ellipsoids_;
-    return std::unique_ptr<Localfunction>(new Localfunction(entity, local_value, std::move(tmp)));
+    return LocalfunctionArena::make_unique<Localfunction>(entity, local_value, std::move(tmp));
   } // ... local_function(...)
 
 private:
@@ -15,6 +15,7 @@
 
 #include <dune/xt/functions/type_traits.hh>
 #include <dune/xt/functions/interfaces/localizable-function.hh>
+#include <dune/xt/functions/interfaces/static-local-function.hh>
 
 namespace Dune {
 namespace XT {
@@ -68,6 +69,12 @@ class SlicedLocalizableFunction<LF, r, 1>
     {
     }
 
+    void bind(const EntityType& ent) override final
+    {
+      this->bind_entity(ent);
+      local_function_->bind(ent);
+    }
+
     size_t order(const XT::Common::Parameter& = {}) const override final
     {
       return local_function_->order();
@@ -92,9 +99,72 @@ class SlicedLocalizableFunction<LF, r, 1>
     const std::array<size_t, r>& dims_;
   }; // class SlicedLocalFunction
 
+  class StaticSlicedLocalFunction
+      : public XT::Functions::StaticLocalfunctionInterface<StaticSlicedLocalFunction,
+                                                           typename LF::E,
+                                                           typename LF::D,
+                                                           LF::d,
+                                                           typename LF::R,
+                                                           r,
+                                                           1>
+  {
+    using BaseType = XT::Functions::StaticLocalfunctionInterface<StaticSlicedLocalFunction,
+                                                                 typename LF::E,
+                                                                 typename LF::D,
+                                                                 LF::d,
+                                                                 typename LF::R,
+                                                                 r,
+                                                                 1>;
+    using FunctionLocal = StaticLocalfunction<LF>;
+
+  public:
+    using typename BaseType::EntityType;
+    using typename BaseType::DomainType;
+    using typename BaseType::RangeType;
+    using typename BaseType::JacobianRangeType;
+
+    StaticSlicedLocalFunction(const LF& function, const std::array<size_t, r>& dims, const EntityType& ent)
+      : BaseType(ent)
+      , local_function_(FunctionLocal::create(function, ent))
+      , dims_(dims)
+    {
+    }
+
+    void bind(const EntityType& ent)
+    {
+      this->bind_entity(ent);
+      local_function_.bind(ent);
+    }
+
+    size_t order(const XT::Common::Parameter& = {}) const
+    {
+      return local_function_.order();
+    }
+
+    using BaseType::evaluate;
+    using BaseType::jacobian;
+
+    void evaluate(const DomainType& xx, RangeType& ret, const XT::Common::Parameter& mu = {}) const
+    {
+      const auto value = local_function_.evaluate(xx, mu);
+      for (size_t ii = 0; ii < r; ++ii)
+        ret[ii] = value[dims_[ii]];
+    }
+
+    void jacobian(const DomainType& /*xx*/, JacobianRangeType& /*ret*/, const XT::Common::Parameter& /*mu*/ = {}) const
+    {
+      DUNE_THROW(NotImplemented, "Yet!");
+    }
+
+  private:
+    typename FunctionLocal::type local_function_;
+    const std::array<size_t, r>& dims_;
+  }; // class StaticSlicedLocalFunction
+
 public:
   using typename BaseType::EntityType;
   using typename BaseType::LocalfunctionType;
+  using StaticLocalfunctionType = StaticSlicedLocalFunction;
 
   SlicedLocalizableFunction(const LF& function, const std::array<size_t, r>& dims, const std::string& nm = "")
     : function_(function)
@@ -124,6 +194,12 @@ public:
     return std::make_unique<SlicedLocalFunction>(function_, dims_, entity);
   }
 
+  //! Statically dispatched counterpart of local_function(), \sa StaticLocalfunctionInterface
+  StaticLocalfunctionType static_local_function(const EntityType& entity) const
+  {
+    return StaticLocalfunctionType(function_, dims_, entity);
+  }
+
 private:
   const LF& function_;
   const std::array<size_t, r> dims_;
@@ -0,0 +1,245 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#ifndef DUNE_XT_FUNCTIONS_STRIDED_VALUES_HH
+#define DUNE_XT_FUNCTIONS_STRIDED_VALUES_HH
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+namespace Dune {
+namespace XT {
+namespace Functions {
+
+
+/**
+ * \brief The components of scalars, FieldVector and FieldMatrix (and nestings thereof, e.g. the JacobianRangeType of
+ *        matrix-valued functions), in the order in which they are stored in memory.
+ */
+template <class T>
+struct FlatComponents
+{
+  static const constexpr size_t size = 1;
+
+  static T& at(T& value, const size_t /*cc*/)
+  {
+    return value;
+  }
+
+  static const T& at(const T& value, const size_t /*cc*/)
+  {
+    return value;
+  }
+};
+
+template <class K, int n>
+struct FlatComponents<Dune::FieldVector<K, n>>
+{
+  static const constexpr size_t size = n * FlatComponents<K>::size;
+
+  template <class V>
+  static auto at(V& value, const size_t cc) -> decltype(FlatComponents<K>::at(value[0], cc))
+  {
+    return FlatComponents<K>::at(value[cc / FlatComponents<K>::size], cc % FlatComponents<K>::size);
+  }
+};
+
+template <class K, int rows, int cols>
+struct FlatComponents<Dune::FieldMatrix<K, rows, cols>>
+{
+  static const constexpr size_t size = rows * cols * FlatComponents<K>::size;
+
+  template <class M>
+  static auto at(M& value, const size_t cc) -> decltype(FlatComponents<K>::at(value[0][0], cc))
+  {
+    const size_t entry = cc / FlatComponents<K>::size;
+    return FlatComponents<K>::at(value[entry / cols][entry % cols], cc % FlatComponents<K>::size);
+  }
+};
+
+
+/**
+ * \brief Non-owning view of the values of several functions at several points, stored component-major: component cc
+ *        of the value of function ii at point pp is
+\code
+data[cc * component_stride + ii * function_stride + pp]
+\endcode
+ *        so that the values of one component of one function at all points are contiguous (see row()) and loops over
+ *        the points, e.g. to contract with quadrature weights, may be vectorized. The components of a value are its
+ *        entries in the order in which they are stored in memory, see FlatComponents.
+ */
+template <class R>
+class StridedValuesView
+{
+public:
+  StridedValuesView(R* data,
+                    const size_t num_components,
+                    const size_t num_functions,
+                    const size_t num_points,
+                    const size_t function_stride,
+                    const size_t component_stride)
+    : data_(data)
+    , num_components_(num_components)
+    , num_functions_(num_functions)
+    , num_points_(num_points)
+    , function_stride_(function_stride)
+    , component_stride_(component_stride)
+  {
+    assert(function_stride_ >= num_points_ || num_functions_ <= 1);
+    assert(component_stride_ >= num_functions_ * function_stride_ || num_components_ <= 1);
+  }
+
+  //! densely packed
+  StridedValuesView(R* data, const size_t num_components, const size_t num_functions, const size_t num_points)
+    : StridedValuesView(data, num_components, num_functions, num_points, num_points, num_functions * num_points)
+  {
+  }
+
+  R& operator()(const size_t cc, const size_t ii, const size_t pp) const
+  {
+    assert(cc < num_components_ && ii < num_functions_ && pp < num_points_);
+    return data_[cc * component_stride_ + ii * function_stride_ + pp];
+  }
+
+  //! stores all components of value (e.g. a RangeType) as the value of function ii at point pp
+  template <class ValueType>
+  void set(const size_t ii, const size_t pp, const ValueType& value) const
+  {
+    assert(num_components_ == FlatComponents<ValueType>::size);
+    for (size_t cc = 0; cc < FlatComponents<ValueType>::size; ++cc)
+      operator()(cc, ii, pp) = FlatComponents<ValueType>::at(value, cc);
+  }
+
+  //! the counterpart of set()
+  template <class ValueType>
+  void get(const size_t ii, const size_t pp, ValueType& value) const
+  {
+    assert(num_components_ == FlatComponents<ValueType>::size);
+    for (size_t cc = 0; cc < FlatComponents<ValueType>::size; ++cc)
+      FlatComponents<ValueType>::at(value, cc) = operator()(cc, ii, pp);
+  }
+
+  //! the num_points() contiguous values of component cc of function ii
+  R* row(const size_t cc, const size_t ii) const
+  {
+    assert(cc < num_components_ && ii < num_functions_);
+    return data_ + cc * component_stride_ + ii * function_stride_;
+  }
+
+  R* data() const
+  {
+    return data_;
+  }
+
+  size_t num_components() const
+  {
+    return num_components_;
+  }
+
+  size_t num_functions() const
+  {
+    return num_functions_;
+  }
+
+  size_t num_points() const
+  {
+    return num_points_;
+  }
+
+  size_t function_stride() const
+  {
+    return function_stride_;
+  }
+
+  size_t component_stride() const
+  {
+    return component_stride_;
+  }
+
+private:
+  R* data_;
+  size_t num_components_;
+  size_t num_functions_;
+  size_t num_points_;
+  size_t function_stride_;
+  size_t component_stride_;
+}; // class StridedValuesView
+
+
+/**
+ * \brief Storage for StridedValuesView, where each row starts at an address aligned to alignment bytes (the number of
+ *        points is padded accordingly).
+ */
+template <class R, size_t alignment = 64>
+class StridedValues
+{
+  static_assert(alignment % sizeof(R) == 0, "alignment has to be a multiple of the size of R!");
+  static const size_t padding = alignment / sizeof(R);
+
+public:
+  StridedValues(const size_t num_components = 0, const size_t num_functions = 0, const size_t num_points = 0)
+  {
+    resize(num_components, num_functions, num_points);
+  }
+
+  StridedValues(const StridedValues& other) = delete;
+
+  StridedValues& operator=(const StridedValues& other) = delete;
+
+  //! does not keep any values
+  void resize(const size_t num_components, const size_t num_functions, const size_t num_points)
+  {
+    const size_t function_stride = (num_points + padding - 1) / padding * padding;
+    const size_t size = num_components * num_functions * function_stride;
+    storage_.resize(size + padding);
+    // the first element of storage_ which is suitably aligned
+    const size_t offset = (alignment - reinterpret_cast<std::uintptr_t>(storage_.data()) % alignment) % alignment;
+    assert(offset % sizeof(R) == 0);
+    view_ = StridedValuesView<R>(storage_.data() + offset / sizeof(R),
+                                 num_components,
+                                 num_functions,
+                                 num_points,
+                                 function_stride,
+                                 num_functions * function_stride);
+  } // ... resize(...)
+
+  const StridedValuesView<R>& view()
+  {
+    return view_;
+  }
+
+  operator const StridedValuesView<R>&()
+  {
+    return view_;
+  }
+
+  const R& operator()(const size_t cc, const size_t ii, const size_t pp) const
+  {
+    return view_(cc, ii, pp);
+  }
+
+  const R* row(const size_t cc, const size_t ii) const
+  {
+    return view_.row(cc, ii);
+  }
+
+private:
+  std::vector<R> storage_;
+  StridedValuesView<R> view_ = StridedValuesView<R>(nullptr, 0, 0, 0);
+}; // class StridedValues
+
+
+} // namespace Functions
+} // namespace XT
+} // namespace Dune
+
+#endif // DUNE_XT_FUNCTIONS_STRIDED_VALUES_HH
@@ -12,6 +12,9 @@
 #include <dune/xt/common/test/main.hxx>
 
 #include <memory>
+#include <vector>
+
+#include <dune/geometry/quadraturerules.hh>
 
 #include <dune/xt/common/exceptions.hh>
 
@@ -64,10 +67,56 @@ struct AffineFunctionTest : public FunctionTest<TESTFUNCTIONTYPE>
         ASSERT_TRUE(XT::Common::FloatCmp::eq(jacobian[rC], matrices[rC]));
     }
   }
+
+  void check_quadrature_evaluation()
+  {
+    using MatrixType = typename TESTFUNCTIONTYPE::FieldMatrixType;
+    using RangeType = typename TESTFUNCTIONTYPE::RangeType;
+    using JacobianRangeType = typename TESTFUNCTIONTYPE::JacobianRangeType;
+    static constexpr size_t dimDomain = TESTFUNCTIONTYPE::dimDomain;
+    static constexpr size_t dimRange = TESTFUNCTIONTYPE::dimRange;
+    static constexpr size_t dimRangeCols = TESTFUNCTIONTYPE::dimRangeCols;
+    auto grid = XT::Grid::make_cube_grid<GRIDTYPE>();
+    auto matrices = FieldVector<MatrixType, dimRangeCols>(XT::LA::eye_matrix<MatrixType>(dimRange, dimDomain));
+    for (size_t rC = 0; rC < dimRangeCols; ++rC)
+      matrices[rC] *= rC + 1;
+    const auto testfunction = TESTFUNCTIONTYPE(matrices, RangeType(1));
+    for (auto&& entity : elements(grid.leaf_view())) {
+      const auto local_function = testfunction.local_function(entity);
+      const auto& quadrature = QuadratureRules<double, dimDomain>::rule(entity.type(), 3);
+      // larger than required
+      std::vector<RangeType> values(quadrature.size() + 1);
+      std::vector<JacobianRangeType> jacobians(quadrature.size());
+      local_function->evaluate(quadrature, values);
+      local_function->jacobian(quadrature, jacobians);
+      // component-major, with more points than required
+      StridedValues<double> strided_values(FlatComponents<RangeType>::size, 1, quadrature.size() + 1);
+      StridedValues<double> strided_jacobians(FlatComponents<JacobianRangeType>::size, 1, quadrature.size());
+      local_function->evaluate(quadrature, strided_values.view());
+      local_function->jacobian(quadrature, strided_jacobians.view());
+      RangeType value;
+      JacobianRangeType jacobian;
+      size_t pp = 0;
+      for (const auto& point : quadrature) {
+        EXPECT_TRUE(XT::Common::FloatCmp::eq(local_function->evaluate(point.position()), values[pp]));
+        EXPECT_EQ(local_function->jacobian(point.position()), jacobians[pp]);
+        strided_values.view().get(0, pp, value);
+        strided_jacobians.view().get(0, pp, jacobian);
+        EXPECT_EQ(values[pp], value);
+        EXPECT_EQ(jacobians[pp], jacobian);
+        ++pp;
+      }
+    }
+  } // ... check_quadrature_evaluation(...)
 };
 
 TEST_F(AffineFunctionTest, creation_and_evalution)
 {
   this->check();
 }
+
+TEST_F(AffineFunctionTest, evaluates_at_all_quadrature_points_at_once)
+{
+  this->check_quadrature_evaluation();
+}
 #endif // HAVE_DUNE_XT_LA
@@ -98,3 +98,20 @@ TYPED_TEST(DifferenceFunctionTest, evaluate_check)
     }
   }
 } // DifferenceFunctionTest, evaluate_check
+TYPED_TEST(DifferenceFunctionTest, bind_check)
+{
+  auto grid_ptr = this->create_grid();
+  auto func = this->create(1.0, 2.0);
+  const auto grid_view = grid_ptr->leafGridView();
+  // one local function for the whole grid walk
+  const auto first_entity = grid_view.template begin<0>();
+  const auto local_func = func->local_function(*first_entity);
+  for (auto&& entity : elements(grid_view)) {
+    local_func->bind(entity);
+    EXPECT_EQ(&entity, &local_func->entity());
+    const auto& quadrature = QuadratureRules<double, TypeParam::value>::rule(
+        entity.type(), boost::numeric_cast<int>(local_func->order() + 2));
+    for (const auto& element : quadrature)
+      EXPECT_EQ(func->local_function(entity)->evaluate(element.position()), local_func->evaluate(element.position()));
+  }
+} // DifferenceFunctionTest, bind_check
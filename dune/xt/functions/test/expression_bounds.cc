@@ -0,0 +1,75 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <dune/xt/functions/expression/base.hh>
+
+using namespace Dune::XT::Functions;
+
+
+GTEST_TEST(MathExpressionBase, bounds_enclose_values)
+{
+  const std::vector<std::string> expressions = {"1 + x[0]*x[1]",
+                                                "x[0]^2 - 3*x[1]",
+                                                "sin(4*x[0])*exp(-x[1])",
+                                                "cos(x[0] + x[1])",
+                                                "sqrt(1 + x[1]^2)/(2 + x[0])",
+                                                "atan(x[1]) + abs(x[0])",
+                                                "ln(3 + x[0])*x[1]^3",
+                                                "x[0]^x[1]",
+                                                "1/x[0]"};
+  const MathExpressionBase<double, 2, double, 9> function("x", expressions);
+  const double boxes[3][4] = {{-1., 1., -0.5, 2.}, {0.25, 0.5, 1., 1.5}, {-0.1, 0.1, 3., 3.}};
+  for (const auto& box : boxes) {
+    const double lower[2] = {box[0], box[2]};
+    const double upper[2] = {box[1], box[3]};
+    double lower_values[9];
+    double upper_values[9];
+    function.bounds(lower, upper, lower_values, upper_values);
+    const size_t num_samples = 40;
+    for (size_t ii = 0; ii <= num_samples; ++ii)
+      for (size_t jj = 0; jj <= num_samples; ++jj) {
+        const Dune::FieldVector<double, 2> xx = {lower[0] + (upper[0] - lower[0]) * ii / num_samples,
+                                                 lower[1] + (upper[1] - lower[1]) * jj / num_samples};
+        Dune::FieldVector<double, 9> values;
+        function.evaluate(xx, values);
+        for (size_t kk = 0; kk < 9; ++kk) {
+          if (values[kk] == ErrVal)
+            EXPECT_EQ(-HUGE_VAL, lower_values[kk]) << expressions[kk];
+          EXPECT_LE(lower_values[kk], values[kk]) << expressions[kk];
+          EXPECT_GE(upper_values[kk], values[kk]) << expressions[kk];
+        }
+      }
+  }
+} // MathExpressionBase, bounds_enclose_values
+
+GTEST_TEST(MathExpressionBase, bounds_are_tight)
+{
+  const MathExpressionBase<double, 1, double, 4> function(
+      "x", std::vector<std::string>{"x[0]^2", "sin(x[0])", "2*x[0] + 1", "1/x[0]"});
+  const double lower[1] = {-1.};
+  const double upper[1] = {2.};
+  double lower_values[4];
+  double upper_values[4];
+  function.bounds(lower, upper, lower_values, upper_values);
+  // x^2 is not bounded by the products of the corners
+  EXPECT_EQ(0., lower_values[0]);
+  EXPECT_DOUBLE_EQ(4., upper_values[0]);
+  // the maximum of sin is attained inside the box
+  EXPECT_DOUBLE_EQ(std::sin(-1.), lower_values[1]);
+  EXPECT_EQ(1., upper_values[1]);
+  EXPECT_DOUBLE_EQ(-1., lower_values[2]);
+  EXPECT_DOUBLE_EQ(5., upper_values[2]);
+  // the box contains a pole
+  EXPECT_EQ(-HUGE_VAL, lower_values[3]);
+  EXPECT_EQ(HUGE_VAL, upper_values[3]);
+} // MathExpressionBase, bounds_are_tight
@@ -0,0 +1,212 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dune/xt/functions/expression/base.hh>
+
+using namespace Dune::XT::Functions;
+
+typedef MathExpressionBase<double, 2, double, 3> FunctionType;
+
+static const std::vector<std::string> expressions = {"sin(x[0])*cos(x[1])", "exp(x[0]*x[1]) + 1", "x[0]^2 - x[1]"};
+
+
+GTEST_TEST(MathExpressionCache, shares_compiled_expressions)
+{
+  MathExpressionCache::clear();
+  const FunctionType function("x", expressions);
+  const FunctionType same_function("x", expressions);
+  const FunctionType other_variable("y", expressions);
+  EXPECT_EQ(&function.program(), &same_function.program());
+  EXPECT_NE(&function.program(), &other_variable.program());
+  const auto stats = MathExpressionCache::statistics();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(2u, stats.size);
+  // entries in use stay valid
+  MathExpressionCache::clear();
+  EXPECT_EQ(0u, MathExpressionCache::statistics().size);
+  const Dune::FieldVector<double, 2> xx = {0.5, 2.};
+  Dune::FieldVector<double, 3> value;
+  same_function.evaluate(xx, value);
+  EXPECT_DOUBLE_EQ(0.25 - 2., value[2]);
+}
+
+GTEST_TEST(MathExpressionCache, is_thread_safe)
+{
+  MathExpressionCache::clear();
+  const size_t num_threads = 4;
+  const size_t num_functions = 100;
+  std::vector<const RProgram*> programs(num_threads * num_functions, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t tt = 0; tt < num_threads; ++tt)
+    threads.emplace_back([&, tt]() {
+      for (size_t ii = 0; ii < num_functions; ++ii)
+        programs[tt * num_functions + ii] =
+            &MathExpressionCache::get({"x[0]", "x[1]"}, {"x[0]*" + std::to_string(ii % 10)})->program;
+    });
+  for (auto& thread : threads)
+    thread.join();
+  const auto stats = MathExpressionCache::statistics();
+  EXPECT_EQ(10u, stats.size);
+  EXPECT_EQ(num_threads * num_functions, stats.hits + stats.misses);
+  for (size_t ii = 0; ii < programs.size(); ++ii)
+    EXPECT_EQ(programs[ii % 10], programs[ii]);
+}
+
+GTEST_TEST(MathExpressionCache, compiles_once_for_repeated_constructions)
+{
+  const size_t num_functions = 5;
+  for (size_t ii = 0; ii < num_functions; ++ii) {
+    MathExpressionCache::clear();
+    const FunctionType function("x", expressions);
+  }
+  for (size_t ii = 0; ii < num_functions; ++ii)
+    const FunctionType function("x", expressions);
+  EXPECT_EQ(num_functions, MathExpressionCache::statistics().hits);
+}
+
+GTEST_TEST(MathExpressionCache, releases_entries_no_function_uses)
+{
+  MathExpressionCache::clear();
+  const size_t capacity = MathExpressionCache::capacity();
+  MathExpressionCache::set_capacity(10);
+  const FunctionType function("x", expressions);
+  for (size_t ii = 0; ii < 100; ++ii)
+    MathExpressionCache::get({"x[0]", "x[1]"}, {"x[0]*" + std::to_string(ii)});
+  // the ten entries used most recently and the one of function
+  EXPECT_EQ(11u, MathExpressionCache::statistics().size);
+  EXPECT_EQ(&function.program(), &MathExpressionCache::get({"x[0]", "x[1]"}, expressions)->program);
+  MathExpressionCache::get({"x[0]", "x[1]"}, {"x[0]*99"});
+  EXPECT_EQ(101u, MathExpressionCache::statistics().misses);
+  MathExpressionCache::set_capacity(0);
+  EXPECT_EQ(1u, MathExpressionCache::statistics().size);
+  MathExpressionCache::set_capacity(capacity);
+}
+
+GTEST_TEST(MathExpressionCache, saves_and_loads_compiled_expressions)
+{
+  MathExpressionCache::clear();
+  const Dune::FieldVector<double, 2> xx = {0.5, 2.};
+  Dune::FieldVector<double, 3> expected_value, value;
+  Dune::FieldMatrix<double, 3, 2> expected_jacobian, jacobian;
+  {
+    const FunctionType function("x", expressions);
+    function.evaluate(xx, expected_value);
+    function.jacobian(xx, expected_jacobian);
+  }
+  const std::string filename = "expression_cache_saves_and_loads.blob";
+  MathExpressionCache::save(filename);
+  const std::string blob = MathExpressionCache::save();
+  MathExpressionCache::clear();
+  EXPECT_EQ(1u, MathExpressionCache::load(filename));
+  // a file is only read once
+  EXPECT_EQ(0u, MathExpressionCache::load(filename));
+  std::remove(filename.c_str());
+  const FunctionType function("x", expressions);
+  const auto stats = MathExpressionCache::statistics();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  function.evaluate(xx, value);
+  function.jacobian(xx, jacobian);
+  EXPECT_EQ(expected_value, value);
+  EXPECT_EQ(expected_jacobian, jacobian);
+  // existing entries are kept
+  EXPECT_EQ(0u, MathExpressionCache::load(blob.data(), blob.size()));
+  // broken blobs are rejected as a whole
+  MathExpressionCache::clear();
+  EXPECT_THROW(MathExpressionCache::load(blob.data(), blob.size() - 1), Dune::IOError);
+  std::string other_version = blob;
+  ++other_version[8];
+  EXPECT_THROW(MathExpressionCache::load(other_version.data(), other_version.size()), Dune::IOError);
+  EXPECT_THROW(MathExpressionCache::load(blob.data() + 1, blob.size() - 1), Dune::IOError);
+  // as are blobs whose programs do not fit their keys, here with one variable and four expressions
+  std::string other_key = blob;
+  const auto key = other_key.find("2:4:x[0]4:x[1]");
+  ASSERT_NE(std::string::npos, key);
+  other_key[key] = '1';
+  EXPECT_THROW(MathExpressionCache::load(other_key.data(), other_key.size()), Dune::IOError);
+  EXPECT_EQ(0u, MathExpressionCache::statistics().size);
+}
+
+GTEST_TEST(MathExpressionCache, compiles_derivatives_on_first_use)
+{
+  MathExpressionCache::clear();
+  const auto compiled = MathExpressionCache::get({"x[0]", "x[1]"}, expressions);
+  EXPECT_EQ(nullptr, compiled->derivatives_if_compiled());
+  const FunctionType function("x", expressions);
+  const RProgram& derivative_program = function.derivative_program();
+  EXPECT_EQ(&compiled->derivatives(), compiled->derivatives_if_compiled());
+  EXPECT_EQ(&derivative_program, &compiled->derivatives().program);
+  EXPECT_EQ(6, derivative_program.NOutputs());
+  // the derivatives are saved and loaded along with the expressions, if they were compiled
+  const auto other = MathExpressionCache::get({"y[0]", "y[1]"}, expressions);
+  const std::string blob = MathExpressionCache::save();
+  MathExpressionCache::clear();
+  EXPECT_EQ(2u, MathExpressionCache::load(blob.data(), blob.size()));
+  const auto loaded = MathExpressionCache::get({"x[0]", "x[1]"}, expressions);
+  ASSERT_NE(nullptr, loaded->derivatives_if_compiled());
+  EXPECT_EQ(derivative_program.NInstructions(), loaded->derivatives().program.NInstructions());
+  const auto other_loaded = MathExpressionCache::get({"y[0]", "y[1]"}, expressions);
+  EXPECT_EQ(nullptr, other_loaded->derivatives_if_compiled());
+  EXPECT_EQ(6, other_loaded->derivatives().program.NOutputs());
+}
+
+GTEST_TEST(RProgram, saves_and_loads)
+{
+  const internal::MathExpressionParser parsed({"x[0]", "x[1]"}, expressions);
+  const RProgram program = parsed.derivative_program().Optimize();
+  std::string data;
+  EXPECT_TRUE(program.Save(data));
+  RProgram loaded;
+  const char* begin = data.data();
+  EXPECT_TRUE(loaded.Load(begin, data.data() + data.size()));
+  EXPECT_EQ(data.data() + data.size(), begin);
+  EXPECT_EQ(program.NInstructions(), loaded.NInstructions());
+  EXPECT_EQ(program.NTemporaries(), loaded.NTemporaries());
+  const double xx[2] = {0.5, 2.};
+  std::vector<double> expected(program.NOutputs()), values(program.NOutputs());
+  program.Val(xx, expected.data());
+  loaded.Val(xx, values.data());
+  EXPECT_EQ(expected, values);
+  // programs referring to constants or variables they do not have are rejected
+  std::string broken = data;
+  broken[0] = 0;
+  begin = broken.data();
+  EXPECT_FALSE(loaded.Load(begin, broken.data() + broken.size()));
+  EXPECT_EQ(broken.data(), begin);
+  // as are programs whose sizes (nvars, nouts, stacksize, ntemps) do not match their code
+  const auto patched = [&](const size_t field, const int value) {
+    std::string ret = data;
+    std::memcpy(&ret[field * sizeof(int)], &value, sizeof(int));
+    return ret;
+  };
+  for (const std::string& wrong : {patched(1, program.NOutputs() + 1),
+                                   patched(2, std::numeric_limits<int>::max()),
+                                   patched(2, program.StackSize() + 1),
+                                   patched(2, program.StackSize() - 1),
+                                   patched(3, 1 << 29),
+                                   patched(3, program.NTemporaries() + 1)}) {
+    begin = wrong.data();
+    EXPECT_FALSE(loaded.Load(begin, wrong.data() + wrong.size()));
+  }
+  // the unoptimized programs and the empty one are valid as well
+  for (const RProgram& other : {parsed.program(), parsed.derivative_program(), RProgram()}) {
+    std::string other_data;
+    EXPECT_TRUE(other.Save(other_data));
+    begin = other_data.data();
+    EXPECT_TRUE(loaded.Load(begin, other_data.data() + other_data.size()));
+  }
+}
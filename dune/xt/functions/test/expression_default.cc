@@ -12,6 +12,7 @@
 #include <dune/xt/common/test/main.hxx>
 
 #include <memory>
+#include <vector>
 
 #include <dune/common/exceptions.hh>
 
@@ -42,9 +43,166 @@ struct ExpressionFunctionTest : public FunctionTest<TESTFUNCTIONTYPE>
     const std::unique_ptr<const FunctionType> function3(
         new FunctionType("x", "sin(x[0])", 3, FunctionType::static_id(), {"cos(x[0])", "0", "0"}));
   }
+
+  void check_batched_evaluation() const
+  {
+    const std::unique_ptr<const FunctionType> function(FunctionType::create(FunctionType::default_config()));
+    // more points than one block of the compiled program
+    std::vector<DomainType> points;
+    for (size_t ii = 0; ii < 100; ++ii) {
+      DomainType xx(0.5 - 0.01 * ii);
+      xx[0] = 0.01 * ii;
+      points.push_back(xx);
+    }
+    std::vector<RangeType> values;
+    function->evaluate(points, values);
+    ASSERT_EQ(points.size(), values.size());
+    for (size_t ii = 0; ii < points.size(); ++ii)
+      EXPECT_EQ(function->evaluate(points[ii]), values[ii]);
+    // the same values, component-major
+    Functions::StridedValues<double> strided_values(Functions::FlatComponents<RangeType>::size, 1, points.size());
+    function->evaluate(points, strided_values.view());
+    RangeType value;
+    for (size_t ii = 0; ii < points.size(); ++ii) {
+      strided_values.view().get(0, ii, value);
+      EXPECT_EQ(values[ii], value);
+    }
+    function->evaluate(std::vector<DomainType>(), values);
+    EXPECT_EQ(size_t(0), values.size());
+    std::vector<JacobianRangeType> jacobians;
+    function->jacobian(points, jacobians);
+    ASSERT_EQ(points.size(), jacobians.size());
+    for (size_t ii = 0; ii < points.size(); ++ii)
+      expect_jacobian_eq(function->jacobian(points[ii]), jacobians[ii]);
+    Functions::StridedValues<double> strided_jacobians(
+        Functions::FlatComponents<JacobianRangeType>::size, 1, points.size());
+    function->jacobian(points, strided_jacobians.view());
+    JacobianRangeType jacobian;
+    for (size_t ii = 0; ii < points.size(); ++ii) {
+      strided_jacobians.view().get(0, ii, jacobian);
+      expect_jacobian_eq(jacobians[ii], jacobian);
+    }
+  } // ... check_batched_evaluation(...)
+
+  void check_symbolic_jacobian() const
+  {
+    Common::Configuration config = FunctionType::default_config();
+    config["expression"] = "[2*x[0] 3*x[0] 4*x[0]; 1 sin(x[0]) 0; cos(x[0]) x[0] 0]";
+    const std::unique_ptr<const FunctionType> symbolic(FunctionType::create(config));
+    if (dimRangeCols == 1)
+      config["gradient"] = "[2 0 0; 0 0 0; -sin(x[0]) 0 0]";
+    else {
+      config["gradient.0"] = "[2 0 0; 0 0 0; -sin(x[0]) 0 0]";
+      config["gradient.1"] = "[3 0 0; cos(x[0]) 0 0; 1 0 0]";
+      config["gradient.2"] = "[4 0 0; 0 0 0; 0 0 0]";
+    }
+    const std::unique_ptr<const FunctionType> given(FunctionType::create(config));
+    for (size_t ii = 0; ii < 10; ++ii) {
+      const DomainType xx(0.1 * ii);
+      expect_jacobian_eq(given->jacobian(xx), symbolic->jacobian(xx));
+    }
+  } // ... check_symbolic_jacobian(...)
+
+  void check_evaluate_with_jacobian() const
+  {
+    Common::Configuration config = FunctionType::default_config();
+    config["expression"] = "[2*x[0] 3*x[0] 4*x[0]; 1 sin(x[0]) 0; cos(x[0]) x[0] 0]";
+    const std::unique_ptr<const FunctionType> function(FunctionType::create(config));
+    RangeType value;
+    JacobianRangeType jacobian;
+    for (size_t ii = 0; ii < 10; ++ii) {
+      const DomainType xx(0.1 * ii);
+      function->evaluate_with_jacobian(xx, value, jacobian);
+      EXPECT_EQ(function->evaluate(xx), value);
+      expect_jacobian_eq(function->jacobian(xx), jacobian);
+    }
+  } // ... check_evaluate_with_jacobian(...)
+
+  void check_hessian() const
+  {
+    Common::Configuration config = FunctionType::default_config();
+    config["expression"] = "[2*x[0] 3*x[0] 4*x[0]; 1 sin(x[0]) 0; cos(x[0]) x[0] 0]";
+    const std::unique_ptr<const FunctionType> symbolic(FunctionType::create(config));
+    if (dimRangeCols == 1)
+      config["gradient"] = "[2 0 0; 0 0 0; -sin(x[0]) 0 0]";
+    else {
+      config["gradient.0"] = "[2 0 0; 0 0 0; -sin(x[0]) 0 0]";
+      config["gradient.1"] = "[3 0 0; cos(x[0]) 0 0; 1 0 0]";
+      config["gradient.2"] = "[4 0 0; 0 0 0; 0 0 0]";
+    }
+    const std::unique_ptr<const FunctionType> given(FunctionType::create(config));
+    for (size_t ii = 0; ii < 10; ++ii) {
+      const DomainType xx(0.1 * ii);
+      expect_jacobian_eq(given->hessian(xx), symbolic->hessian(xx));
+    }
+  } // ... check_hessian(...)
+
+  void check_order_detection() const
+  {
+    EXPECT_EQ(size_t(0), FunctionType("x", "2*pi").order());
+    EXPECT_EQ(size_t(2), FunctionType("x", "(x[0] - 1)*(x[0] + 1)/2").order());
+    EXPECT_EQ(size_t(3), FunctionType("x", "sin(x[0])").order());
+    EXPECT_EQ(size_t(5), FunctionType("x", "sin(x[0])", 5).order());
+    EXPECT_EQ(size_t(1), FunctionType("x", "sin(x[0])", FunctionType::automatic_order, "f", {}, 1).order());
+    Common::Configuration config = FunctionType::default_config();
+    EXPECT_EQ(size_t(3), FunctionType::create(config)->order());
+    config["expression"] = "[x[0]^3 0 0; 1 x[0] 0; 0 0 x[0]*x[0]]";
+    EXPECT_EQ(size_t(3), FunctionType::create(config)->order());
+    config["order"] = "1";
+    EXPECT_EQ(size_t(1), FunctionType::create(config)->order());
+  } // ... check_order_detection(...)
+
+  template <class K, int rows, int cols>
+  static void expect_jacobian_eq(const FieldMatrix<K, rows, cols>& expected, const FieldMatrix<K, rows, cols>& actual)
+  {
+    for (int ii = 0; ii < rows; ++ii)
+      for (int jj = 0; jj < cols; ++jj)
+        EXPECT_DOUBLE_EQ(expected[ii][jj], actual[ii][jj]);
+  }
+
+  template <class K, int rows, int cols, int size>
+  static void expect_jacobian_eq(const FieldVector<FieldMatrix<K, rows, cols>, size>& expected,
+                                 const FieldVector<FieldMatrix<K, rows, cols>, size>& actual)
+  {
+    for (int cc = 0; cc < size; ++cc)
+      expect_jacobian_eq(expected[cc], actual[cc]);
+  }
+
+  template <class K, int rows, int cols, int size, int cols_size>
+  static void expect_jacobian_eq(const FieldVector<FieldVector<FieldMatrix<K, rows, cols>, size>, cols_size>& expected,
+                                 const FieldVector<FieldVector<FieldMatrix<K, rows, cols>, size>, cols_size>& actual)
+  {
+    for (int cc = 0; cc < cols_size; ++cc)
+      expect_jacobian_eq(expected[cc], actual[cc]);
+  }
 };
 
 TEST_F(ExpressionFunctionTest, provides_required_methods)
 {
   this->check();
 }
+
+TEST_F(ExpressionFunctionTest, evaluates_many_points_at_once)
+{
+  this->check_batched_evaluation();
+}
+
+TEST_F(ExpressionFunctionTest, computes_jacobian_symbolically)
+{
+  this->check_symbolic_jacobian();
+}
+
+TEST_F(ExpressionFunctionTest, evaluates_with_jacobian)
+{
+  this->check_evaluate_with_jacobian();
+}
+
+TEST_F(ExpressionFunctionTest, computes_hessian)
+{
+  this->check_hessian();
+}
+
+TEST_F(ExpressionFunctionTest, detects_order)
+{
+  this->check_order_detection();
+}
@@ -0,0 +1,76 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dune/xt/functions/expression/mathexpr.hh>
+
+// the expressions of expression_default.cc
+static const std::vector<std::string> expressions = {"x[0]",
+                                                     "sin(x[0])",
+                                                     "exp(x[0])",
+                                                     "2*x[0]",
+                                                     "3*x[0]",
+                                                     "4*x[0]",
+                                                     "cos(x[0])",
+                                                     "-sin(x[0])",
+                                                     "2*pi",
+                                                     "(x[0] - 1)*(x[0] + 1)/2",
+                                                     "x[0]^3",
+                                                     "x[0]*x[0]",
+                                                     "x[0]*x[0]*x[1] + exp(x[0])"};
+
+struct ROperationTest : public ::testing::Test
+{
+  ROperationTest()
+    : x0("x[0]", &xx[0])
+    , x1("x[1]", &xx[1])
+  {
+    vars[0] = &x0;
+    vars[1] = &x1;
+  }
+
+  double xx[2];
+  RVar x0;
+  RVar x1;
+  PRVar vars[2];
+};
+
+TEST_F(ROperationTest, interpreters_agree)
+{
+  std::vector<std::string> all = expressions;
+  for (const auto& expression : {"atan(x[0], x[1]) + x[1]^x[0] - 10^x[0]",
+                                 "sqrt(x[0]) + ln(x[1]) + abs(x[0] - x[1])",
+                                 "asin(x[0]/4) + acos(-x[1]/4) + atan(x[0]) + tan(x[1])",
+                                 "ln(x[0]) + 1/(x[1] - x[1])",
+                                 "min(x[0], x[1]) + max(x[0], 1) - clamp(x[1], -1, x[0]) + floor(x[0]*x[1])",
+                                 "heaviside(x[1]) + if(x[0], sqrt(x[0]), ln(-x[0]))"})
+    all.push_back(expression);
+  for (const auto& expression : all) {
+    const ROperation operation(expression.c_str(), 2, vars);
+    for (size_t ii = 0; ii < 101; ++ii) {
+      xx[0] = -3. + 0.06 * ii;
+      xx[1] = 2. - 0.03 * ii;
+      const double value = operation.Val();
+      const double expected = operation.ValThreaded();
+      EXPECT_EQ(0, std::memcmp(&expected, &value, sizeof(double))) << expression << " at " << xx[0] << ", " << xx[1];
+    }
+  }
+  // user defined functions are called by both
+  RFunction square(ROperation("x[0]*x[0]", 1, vars), &x0);
+  square.SetName("square");
+  PRFunction funcs[1] = {&square};
+  const ROperation operation("square(x[1]) + x[0]", 2, vars, 1, funcs);
+  xx[0] = 0.5;
+  xx[1] = 3.;
+  EXPECT_EQ(9.5, operation.Val());
+  EXPECT_EQ(operation.ValThreaded(), operation.Val());
+}
@@ -0,0 +1,177 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <dune/xt/functions/expression/base.hh>
+#include <dune/xt/functions/expression/jit.hh>
+
+using namespace Dune::XT::Functions;
+
+
+static uint64_t bits(const double value)
+{
+  uint64_t ret;
+  std::memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+
+
+// compares the compiled program with the interpreter bit for bit at the points (args[0][pp], args[1][pp])
+static void check_jit(const RProgram& program, const std::vector<std::vector<double>>& args)
+{
+  const size_t num_outputs = program.NOutputs();
+  const auto jit = JitMathExpression::create(program, "expression_jit_cache");
+  if (!jit) {
+    std::cout << "no compiler available, nothing to test" << std::endl;
+    return;
+  }
+  // a second request is served from the cache
+  EXPECT_EQ(jit, JitMathExpression::create(program, "expression_jit_cache"));
+  const size_t num_points = args[0].size();
+  const double* arg_ptrs[2] = {args[0].data(), args[1].data()};
+  std::vector<double> expected(num_outputs * num_points);
+  std::vector<double> values(num_outputs * num_points);
+  program.Val(arg_ptrs, expected.data(), num_points);
+  jit->evaluate(arg_ptrs, values.data(), num_points);
+  for (size_t ii = 0; ii < values.size(); ++ii) {
+    const size_t pp = ii % num_points;
+    EXPECT_EQ(bits(expected[ii]), bits(values[ii]))
+        << "output " << ii / num_points << " at (" << args[0][pp] << ", " << args[1][pp] << ")";
+  }
+  for (size_t pp = 0; pp < num_points; ++pp) {
+    const double point[2] = {args[0][pp], args[1][pp]};
+    std::vector<double> value(num_outputs);
+    jit->evaluate(point, value.data());
+    for (size_t ii = 0; ii < num_outputs; ++ii)
+      EXPECT_EQ(bits(expected[ii * num_points + pp]), bits(value[ii]));
+  }
+} // ... check_jit(...)
+
+
+static void check_jit(const RProgram& program)
+{
+  const size_t num_points = 100;
+  std::vector<std::vector<double>> args(2, std::vector<double>(num_points));
+  for (size_t pp = 0; pp < num_points; ++pp) {
+    args[0][pp] = -0.5 + 0.01 * pp;
+    args[1][pp] = 2. - 0.02 * pp;
+  }
+  check_jit(program, args);
+}
+
+
+GTEST_TEST(JitMathExpression, gives_same_results_as_interpreter)
+{
+  const std::vector<std::string> variables = {"x[0]", "x[1]"};
+  const std::vector<std::string> expressions = {"x[0]*x[1]",
+                                                "sin(x[0])*cos(x[1])",
+                                                "exp(x[1])+1",
+                                                "x[0]^x[1]+atan(x[0],x[1])-sqrt(x[1])/3",
+                                                "ln(x[0])",
+                                                "sin(x[0])*cos(x[1])+x[0]*x[1]",
+                                                "min(x[0], x[1]) + if(x[0], floor(3*x[1]), heaviside(x[1] - 1))",
+                                                "clamp(x[1], 0, 1)*max(x[0], 0)"};
+  const RProgram program = internal::MathExpressionParser(variables, expressions).program();
+  check_jit(program);
+  // the optimized program uses temporaries
+  check_jit(program.Optimize());
+}
+
+GTEST_TEST(JitMathExpression, gives_same_results_as_interpreter_for_every_opcode)
+{
+  // one output per opcode, written directly since the parser does not emit all of them, in the format of Save()
+  std::vector<int> code;
+  int nouts = 0;
+  const auto append = [&](const std::vector<int>& instructions) {
+    code.insert(code.end(), instructions.begin(), instructions.end());
+    code.insert(code.end(), {BCStore, nouts++});
+  };
+  for (const int op : {BCAdd, BCSub, BCMult, BCDiv, BCPow, BCNthRoot, BCE10, BCAtan2, BCMin, BCMax})
+    append({BCVar, 0, BCVar, 1, op, 0});
+  for (const int op : {BCOpp, BCAbs, BCSqrt, BCSin, BCCos, BCTg, BCLn, BCExp, BCAcos, BCAsin, BCAtan, BCFloor,
+                       BCHeaviside, BCError})
+    append({BCVar, 0, op, 0});
+  append({BCVar, 0, BCVar, 1, BCNum, 0, BCIf, 0});
+  const double constant = 2.5;
+  std::vector<int> header = {2, nouts, 3, 0, int(code.size() / 2), 1};
+  std::string data(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(int));
+  data.append(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(int));
+  data.append(reinterpret_cast<const char*>(&constant), sizeof(constant));
+  RProgram program;
+  const char* begin = data.data();
+  ASSERT_TRUE(program.Load(begin, data.data() + data.size()));
+  // at all pairs of values around the bounds of the kernels, ErrVal, infinity and NaN included
+  const double max = std::numeric_limits<double>::max();
+  const std::vector<double> values = {0.,    -0.,   1e-300, -1e-300, 0.5,  -0.5, 1.,   -1.,      2.,   -2.5, 3.,
+                                      700.,  800.,  -800.,  1e20,    -1e20, 1e200, max, -max, HUGE_VAL, NAN};
+  std::vector<std::vector<double>> args(2);
+  for (const double x0 : values)
+    for (const double x1 : values) {
+      args[0].push_back(x0);
+      args[1].push_back(x1);
+    }
+  check_jit(program, args);
+}
+
+GTEST_TEST(JitMathExpression, ignores_directories_others_may_write_to)
+{
+  const RProgram program = internal::MathExpressionParser({"x[0]"}, {"x[0]*x[0] + 1"}).program();
+  if (!JitMathExpression::create(program, "expression_jit_cache")) {
+    std::cout << "no compiler available, nothing to test" << std::endl;
+    return;
+  }
+  ::mkdir("expression_jit_cache_shared", 0700);
+  ASSERT_EQ(0, ::chmod("expression_jit_cache_shared", 0777));
+  EXPECT_EQ(nullptr, JitMathExpression::create(program, "expression_jit_cache_shared"));
+  ::rmdir("expression_jit_cache_shared");
+}
+
+GTEST_TEST(JitMathExpression, runs_the_compiler_without_a_shell)
+{
+  const RProgram program = internal::MathExpressionParser({"x[0]"}, {"2*x[0] - 1"}).program();
+  if (!JitMathExpression::create(program, "expression_jit_cache")) {
+    std::cout << "no compiler available, nothing to test" << std::endl;
+    return;
+  }
+  const auto jit = JitMathExpression::create(program, "expression_jit_cache/it's a $(cache)");
+  ASSERT_NE(nullptr, jit);
+  const double xx = 3.;
+  double value;
+  jit->evaluate(&xx, &value);
+  EXPECT_EQ(5., value);
+}
+
+GTEST_TEST(JitMathExpression, compiles_once_for_all_threads)
+{
+  const RProgram program = internal::MathExpressionParser({"x[0]"}, {"3*x[0] + 1"}).program();
+  std::vector<std::shared_ptr<const JitMathExpression>> jits(4);
+  std::vector<std::thread> threads;
+  for (size_t tt = 0; tt < jits.size(); ++tt)
+    threads.emplace_back([&, tt]() { jits[tt] = JitMathExpression::create(program, "expression_jit_cache"); });
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& jit : jits)
+    EXPECT_EQ(jits[0], jit);
+  // a program which fails does not affect the others
+  if (jits[0] != nullptr) {
+    const RProgram other = internal::MathExpressionParser({"x[0]"}, {"3*x[0] + 2"}).program();
+    EXPECT_EQ(nullptr, JitMathExpression::create(other, "/dev/null/expression_jit_cache"));
+    EXPECT_NE(nullptr, JitMathExpression::create(other, "expression_jit_cache"));
+  }
+}
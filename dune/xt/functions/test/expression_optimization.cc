@@ -0,0 +1,231 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dune/xt/functions/expression/base.hh>
+
+using namespace Dune::XT::Functions;
+
+
+static void check_same_values(const RProgram& expected_program, const RProgram& program)
+{
+  ASSERT_EQ(expected_program.NOutputs(), program.NOutputs());
+  const size_t num_points = 150;
+  const size_t num_outputs = program.NOutputs();
+  std::vector<double> args(2 * num_points);
+  for (size_t pp = 0; pp < num_points; ++pp) {
+    args[pp] = -1.5 + 0.02 * pp;
+    args[num_points + pp] = 2. - 0.01 * pp;
+  }
+  const double* arg_ptrs[2] = {args.data(), args.data() + num_points};
+  std::vector<double> expected(num_outputs * num_points);
+  std::vector<double> values(num_outputs * num_points);
+  expected_program.Val(arg_ptrs, expected.data(), num_points);
+  program.Val(arg_ptrs, values.data(), num_points);
+  for (size_t ii = 0; ii < values.size(); ++ii)
+    EXPECT_DOUBLE_EQ(expected[ii], values[ii]);
+  for (size_t pp = 0; pp < num_points; ++pp) {
+    const double point[2] = {args[pp], args[num_points + pp]};
+    std::vector<double> value(num_outputs);
+    program.Val(point, value.data());
+    for (size_t ii = 0; ii < num_outputs; ++ii)
+      EXPECT_DOUBLE_EQ(expected[ii * num_points + pp], value[ii]);
+  }
+} // ... check_same_values(...)
+
+
+GTEST_TEST(RProgram, optimize_keeps_values)
+{
+  const std::vector<std::string> variables = {"x[0]", "x[1]"};
+  const std::vector<std::string> expressions = {"sin(x[0])*cos(x[1]) + x[1]^2",
+                                                "sin(x[0])*cos(x[1])",
+                                                "exp(x[0]*x[1]) + exp(x[1]*x[0])",
+                                                "2*3 + x[0]*1 + 0 - -(-x[1])",
+                                                "sqrt(2)*x[0] + x[0]^1/1",
+                                                "atan(x[0], x[1]) + 0*ln(x[1])"};
+  const internal::MathExpressionParser parsed(variables, expressions);
+  const RProgram program = parsed.program();
+  const RProgram optimized = program.Optimize();
+  EXPECT_LT(optimized.NInstructions(), program.NInstructions());
+  EXPECT_GT(optimized.NTemporaries(), 0);
+  check_same_values(program, optimized);
+  // optimizing twice does not change anything
+  const RProgram twice = optimized.Optimize();
+  EXPECT_EQ(optimized.NInstructions(), twice.NInstructions());
+  check_same_values(program, twice);
+  // the derivatives share a lot of subexpressions
+  const RProgram derivatives = parsed.derivative_program();
+  const RProgram optimized_derivatives = derivatives.Optimize();
+  EXPECT_LT(optimized_derivatives.NInstructions(), derivatives.NInstructions());
+  check_same_values(derivatives, optimized_derivatives);
+}
+
+GTEST_TEST(MathExpressionBase, reports_instructions)
+{
+  const MathExpressionBase<double, 2, double, 2> function(
+      "x", std::vector<std::string>{"sin(x[0])*x[1]^2", "sin(x[0])*x[1]^2 + 1"});
+  std::stringstream report;
+  function.report_instructions(report);
+  EXPECT_NE(std::string::npos, report.str().find("expressions:"));
+  EXPECT_NE(std::string::npos, report.str().find("derivatives:"));
+  const double xx[2] = {0.5, 2.};
+  const Dune::FieldVector<double, 2> arg = {xx[0], xx[1]};
+  Dune::FieldVector<double, 2> value;
+  function.evaluate(arg, value);
+  EXPECT_DOUBLE_EQ(std::sin(0.5) * 4., value[0]);
+  EXPECT_DOUBLE_EQ(std::sin(0.5) * 4. + 1., value[1]);
+  const double* arg_ptrs[2] = {&xx[0], &xx[1]};
+  double values[2];
+  function.evaluate(arg_ptrs, values, 1);
+  EXPECT_DOUBLE_EQ(value[0], values[0]);
+  EXPECT_DOUBLE_EQ(value[1], values[1]);
+}
+
+GTEST_TEST(MathExpressionBase, evaluates_into_matrix)
+{
+  const MathExpressionBase<double, 2, double, 4> function(
+      "x", std::vector<std::string>{"x[0]*x[1]", "sin(x[0]*x[1])", "sin(x[0]*x[1])", "exp(x[0]) + x[0]*x[1]"});
+  const Dune::FieldVector<double, 2> arg = {0.5, 2.};
+  Dune::FieldMatrix<double, 2, 2> matrix;
+  function.evaluate(arg, matrix);
+  Dune::FieldVector<double, 4> vector;
+  function.evaluate(arg, vector);
+  for (size_t ii = 0; ii < 4; ++ii)
+    EXPECT_EQ(vector[ii], matrix[ii / 2][ii % 2]);
+  EXPECT_DOUBLE_EQ(1., matrix[0][0]);
+  EXPECT_DOUBLE_EQ(std::sin(1.), matrix[0][1]);
+  EXPECT_DOUBLE_EQ(std::sin(1.), matrix[1][0]);
+  EXPECT_DOUBLE_EQ(std::exp(0.5) + 1., matrix[1][1]);
+}
+
+GTEST_TEST(RProgram, computes_degrees)
+{
+  const std::vector<std::string> variables = {"x[0]", "x[1]"};
+  const std::vector<std::string> expressions = {"3",
+                                                "x[0]*x[1]^2 - 1",
+                                                "(x[0] + x[1])^(1 + 2)/4",
+                                                "sin(2)*x[0] + 0*exp(x[1])",
+                                                "sin(x[0]^2)",
+                                                "x[0]/x[1]",
+                                                "x[0]^x[1]"};
+  const internal::MathExpressionParser parsed(variables, expressions);
+  std::vector<int> degrees(expressions.size());
+  EXPECT_FALSE(parsed.program().Degrees(3, degrees.data()));
+  EXPECT_EQ(std::vector<int>({0, 3, 3, 1, 6, 4, 3}), degrees);
+  const RProgram polynomials = parsed.program().SelectOutputs({0, 1, 2, 3});
+  EXPECT_TRUE(polynomials.Degrees(3, degrees.data()));
+  EXPECT_TRUE(polynomials.Optimize().Degrees(3, degrees.data()));
+  EXPECT_EQ(std::vector<int>({0, 3, 3, 1}), std::vector<int>(degrees.begin(), degrees.begin() + 4));
+}
+
+
+GTEST_TEST(RProgram, computes_derivatives_with_values)
+{
+  const std::vector<std::string> variables = {"x[0]", "x[1]"};
+  const std::vector<std::string> expressions = {"sin(x[0])*cos(x[1]) + x[1]^2",
+                                                "exp(x[0]*x[1])/(1 + x[0]^2)",
+                                                "x[0]^x[1] - sqrt(x[1])*ln(x[0])",
+                                                "atan(x[0], x[1]) + atan(x[0]*x[1]) + abs(x[0] - x[1])",
+                                                "tan(x[0]) + asin(x[0]/2) - acos(x[1]/3)",
+                                                "2*3 + x[0]*1"};
+  const internal::MathExpressionParser parsed(variables, expressions);
+  const RProgram program = parsed.program().Optimize();
+  const RProgram symbolic = parsed.derivative_program().Optimize();
+  const size_t num_outputs = expressions.size();
+  for (size_t pp = 0; pp < 50; ++pp) {
+    const double point[2] = {0.1 + 0.02 * pp, 2. - 0.03 * pp};
+    std::vector<double> expected_values(num_outputs), values(num_outputs);
+    std::vector<double> expected_derivatives(2 * num_outputs), derivatives(2 * num_outputs);
+    program.Val(point, expected_values.data());
+    symbolic.Val(point, expected_derivatives.data());
+    program.ValDerivatives(point, values.data(), derivatives.data());
+    // the values are the ones of Val(), the derivatives only differ by rounding from the symbolic ones
+    EXPECT_EQ(expected_values, values);
+    for (size_t ii = 0; ii < 2 * num_outputs; ++ii)
+      EXPECT_NEAR(expected_derivatives[ii], derivatives[ii], 1e-13 * (1 + std::abs(expected_derivatives[ii])))
+          << expressions[ii / 2];
+  }
+  // x[1] does not appear in the last expression, which is not defined at this point
+  double values[6], derivatives[12];
+  const double point[2] = {ErrVal, ErrVal};
+  program.ValDerivatives(point, values, derivatives);
+  EXPECT_EQ(0., derivatives[11]);
+}
+
+GTEST_TEST(RProgram, evaluates_piecewise_functions)
+{
+  const std::vector<std::string> variables = {"x[0]", "x[1]"};
+  const std::vector<std::string> expressions = {"min(x[0], x[1]) + max(x[0]^2, 1)",
+                                                "clamp(x[0]*x[1], -0.5, 1)",
+                                                "floor(2*x[0]) + heaviside(x[1] - 1)",
+                                                "if(x[0], sqrt(x[0]), x[0]^2) + if(1, x[1], ln(x[1]))",
+                                                "min(x[0], x[0]) + if(x[1] - x[0], x[1], x[1])"};
+  const internal::MathExpressionParser parsed(variables, expressions);
+  const RProgram program = parsed.program();
+  const RProgram optimized = program.Optimize();
+  EXPECT_LT(optimized.NInstructions(), program.NInstructions());
+  check_same_values(program, optimized);
+  double values[5];
+  const double point[2] = {0.25, 2.};
+  optimized.Val(point, values);
+  EXPECT_EQ(std::vector<double>({1.25, 0.5, 1., 2.5, 2.25}), std::vector<double>(values, values + 5));
+  const double other_point[2] = {-1., 0.5};
+  optimized.Val(other_point, values);
+  EXPECT_EQ(std::vector<double>({0., -0.5, -2., 1.5, -0.5}), std::vector<double>(values, values + 5));
+  // the derivatives of the selected values
+  const RProgram symbolic = parsed.derivative_program().Optimize();
+  for (size_t pp = 0; pp < 50; ++pp) {
+    const double xx[2] = {0.1 + 0.02 * pp, 2. - 0.03 * pp};
+    double expected_derivatives[10], derivatives[10];
+    symbolic.Val(xx, expected_derivatives);
+    optimized.ValDerivatives(xx, values, derivatives);
+    for (size_t ii = 0; ii < 10; ++ii)
+      EXPECT_NEAR(expected_derivatives[ii], derivatives[ii], 1e-13 * (1 + std::abs(expected_derivatives[ii])))
+          << expressions[ii / 2];
+  }
+  // the bounds enclose the values
+  const double lower[2] = {0.1, 0.5}, upper[2] = {0.9, 2.};
+  double outlower[5], outupper[5];
+  optimized.Bounds(lower, upper, outlower, outupper);
+  for (size_t pp = 0; pp <= 20; ++pp)
+    for (size_t qq = 0; qq <= 20; ++qq) {
+      const double xx[2] = {0.1 + 0.04 * pp, 0.5 + 0.075 * qq};
+      optimized.Val(xx, values);
+      for (size_t ii = 0; ii < 5; ++ii) {
+        EXPECT_LE(outlower[ii], values[ii]) << expressions[ii];
+        EXPECT_GE(outupper[ii], values[ii]) << expressions[ii];
+      }
+    }
+  EXPECT_NEAR(0., outlower[2], 1e-15);
+  EXPECT_NEAR(2., outupper[2], 1e-15);
+  // piecewise polynomials of the degrees of their pieces
+  std::vector<int> degrees(expressions.size());
+  EXPECT_FALSE(program.Degrees(3, degrees.data()));
+  EXPECT_EQ(std::vector<int>({2, 2, 0, 3, 1}), degrees);
+}
+
+GTEST_TEST(MathExpressionBase, computes_hessian)
+{
+  const MathExpressionBase<double, 2, double, 2> function(
+      "x", std::vector<std::string>{"x[0]^2*x[1] + exp(x[0])", "sin(x[0]*x[1]) + x[1]"});
+  const Dune::FieldVector<double, 2> arg = {0.5, 2.};
+  Dune::FieldVector<Dune::FieldMatrix<double, 2, 2>, 2> hessian;
+  function.hessian(arg, hessian);
+  EXPECT_DOUBLE_EQ(2. * 2. + std::exp(0.5), hessian[0][0][0]);
+  EXPECT_DOUBLE_EQ(2. * 0.5, hessian[0][0][1]);
+  EXPECT_DOUBLE_EQ(2. * 0.5, hessian[0][1][0]);
+  EXPECT_DOUBLE_EQ(0., hessian[0][1][1]);
+  EXPECT_DOUBLE_EQ(-4. * std::sin(1.), hessian[1][0][0]);
+  EXPECT_DOUBLE_EQ(std::cos(1.) - std::sin(1.), hessian[1][0][1]);
+  EXPECT_DOUBLE_EQ(hessian[1][0][1], hessian[1][1][0]);
+  EXPECT_DOUBLE_EQ(-0.25 * std::sin(1.), hessian[1][1][1]);
+}
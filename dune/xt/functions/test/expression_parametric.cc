@@ -40,6 +40,78 @@ struct ExpressionFunctionTest : public FunctionTest<TESTFUNCTIONTYPE>
       }
     }
   }
+
+  void check_jacobian() const
+  {
+    auto grid = XT::Grid::make_cube_grid<GRIDTYPE>();
+    auto leaf_view = grid.leaf_view();
+
+    TESTFUNCTIONTYPE func("x", std::make_pair("t_", 1), {"t_*x[0]*x[0]"});
+    for (auto&& entity : elements(leaf_view)) {
+      auto xx_global = entity.geometry().center();
+      for (auto t_ : {-17., 0., 42.}) {
+        const auto jacobian = func.jacobian(xx_global, t_);
+        EXPECT_DOUBLE_EQ(2 * t_ * xx_global[0], jacobian[0][0]);
+        for (size_t ii = 1; ii < dimDomain; ++ii)
+          EXPECT_EQ(0., jacobian[0][ii]);
+      }
+    }
+  }
+
+  void check_parameter_jacobian() const
+  {
+    auto grid = XT::Grid::make_cube_grid<GRIDTYPE>();
+    auto leaf_view = grid.leaf_view();
+
+    TESTFUNCTIONTYPE func("x", std::make_pair("mu", 2), {"mu[0]*x[0]*x[0] + sin(mu[1])"});
+    for (auto&& entity : elements(leaf_view)) {
+      const auto xx_global = entity.geometry().center();
+      for (auto t_ : {-17., 0., 42.}) {
+        const Common::Parameter mu("mu", std::vector<double>({t_, 2 * t_}));
+        const auto derivatives = func.parameter_jacobian(xx_global, mu);
+        ASSERT_EQ(size_t(1), derivatives.size());
+        ASSERT_EQ(size_t(2), derivatives.at("mu").size());
+        EXPECT_DOUBLE_EQ(xx_global[0] * xx_global[0], derivatives.at("mu")[0][0]);
+        EXPECT_DOUBLE_EQ(std::cos(2 * t_), derivatives.at("mu")[1][0]);
+      }
+    }
+  }
+
+  void check_with_parameter() const
+  {
+    auto grid = XT::Grid::make_cube_grid<GRIDTYPE>();
+    auto leaf_view = grid.leaf_view();
+
+    TESTFUNCTIONTYPE func("x", std::make_pair("t_", 1), {"t_*x[0]*x[0] + sin(t_)"});
+    for (auto t_ : {-17., 0., 42.}) {
+      const auto bound_func = func.with_parameter(t_);
+      EXPECT_FALSE(bound_func->is_parametric());
+      // the parameter is a constant now
+      EXPECT_EQ(int(dimDomain), bound_func->program().NVars());
+      for (auto&& entity : elements(leaf_view)) {
+        const auto xx_global = entity.geometry().center();
+        EXPECT_DOUBLE_EQ(func.evaluate(xx_global, t_)[0], bound_func->evaluate(xx_global)[0]);
+        const auto expected_jacobian = func.jacobian(xx_global, t_);
+        const auto jacobian = bound_func->jacobian(xx_global);
+        for (size_t ii = 0; ii < dimDomain; ++ii)
+          EXPECT_DOUBLE_EQ(expected_jacobian[0][ii], jacobian[0][ii]);
+      }
+    }
+  }
+
+  void check_many_parameter_components() const
+  {
+    // more components than any fixed size table of variables would hold
+    const size_t num_components = 300;
+    TESTFUNCTIONTYPE func("x", std::make_pair("mu", int(num_components)), {"mu[0] + mu[299]*x[0]"});
+    std::vector<double> values(num_components, 0.);
+    values[0] = 1.;
+    values[299] = 3.;
+    const Common::Parameter mu("mu", values);
+    DomainType xx(0.5);
+    EXPECT_DOUBLE_EQ(2.5, func.evaluate(xx, mu)[0]);
+    EXPECT_DOUBLE_EQ(3., func.jacobian(xx, mu)[0][0]);
+  }
 };
 
 
@@ -47,3 +119,23 @@ TEST_F(ExpressionFunctionTest, creation_and_evalution)
 {
   this->check();
 }
+
+TEST_F(ExpressionFunctionTest, symbolic_jacobian)
+{
+  this->check_jacobian();
+}
+
+TEST_F(ExpressionFunctionTest, parameter_jacobian)
+{
+  this->check_parameter_jacobian();
+}
+
+TEST_F(ExpressionFunctionTest, with_parameter)
+{
+  this->check_with_parameter();
+}
+
+TEST_F(ExpressionFunctionTest, many_parameter_components)
+{
+  this->check_many_parameter_components();
+}
@@ -0,0 +1,113 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <dune/xt/functions/expression/mathexpr.hh>
+
+struct ParserTest : public ::testing::Test
+{
+  ParserTest()
+    : x0("x[0]", &values[0])
+    , x1("x[1]", &values[1])
+    , y("y", &values[2])
+    , ys("ys", &values[3])
+  {
+    values[0] = 0.5;
+    values[1] = 2.;
+    values[2] = 3.;
+    values[3] = 5.;
+    vars[0] = &x0;
+    vars[1] = &x1;
+    vars[2] = &y;
+    vars[3] = &ys;
+  }
+
+  ROperation parse(const std::string& expression)
+  {
+    return ROperation(expression.c_str(), 4, vars);
+  }
+
+  double values[4];
+  RVar x0, x1, y, ys;
+  RVar* vars[4];
+}; // struct ParserTest
+
+
+TEST_F(ParserTest, keeps_precedences)
+{
+  // '+' is split before '-' and '*' before '/'
+  const auto sum = parse("x[0] - x[1] + y - ys");
+  ASSERT_EQ(Add, sum.op);
+  EXPECT_EQ(Sub, sum.mmb1->op);
+  EXPECT_EQ(Sub, sum.mmb2->op);
+  const auto product = parse("x[0]/x[1]*y/ys");
+  ASSERT_EQ(Mult, product.op);
+  EXPECT_EQ(Div, product.mmb1->op);
+  EXPECT_EQ(Div, product.mmb2->op);
+  // a leading minus applies to the whole product, '^' is left associative
+  const auto negated = parse("-x[0]*x[1]^2^y");
+  ASSERT_EQ(Opp, negated.op);
+  ASSERT_EQ(Mult, negated.mmb2->op);
+  ASSERT_EQ(Pow, negated.mmb2->mmb2->op);
+  EXPECT_EQ(Pow, negated.mmb2->mmb2->mmb1->op);
+  // juxtaposed operands are multiplied
+  const auto juxtaposed = parse("2x[0]sin(y)");
+  ASSERT_EQ(Mult, juxtaposed.op);
+  EXPECT_EQ(Sin, juxtaposed.mmb2->op);
+  // the longest variable wins
+  const auto var = parse("ys");
+  ASSERT_EQ(Var, var.op);
+  EXPECT_EQ(&ys, var.pvar);
+}
+
+TEST_F(ParserTest, evaluates)
+{
+  EXPECT_DOUBLE_EQ(0.5 * 2. + 3., parse("x[0]*x[1] + y").Val());
+  EXPECT_DOUBLE_EQ(-0.25, parse("-x[0]^2").Val());
+  EXPECT_DOUBLE_EQ(0.5 / -2. * 3., parse("x[0]/-x[1]*y").Val());
+  EXPECT_DOUBLE_EQ(std::atan2(0.5, 2.), parse("atan(x[0], x[1])").Val());
+  EXPECT_DOUBLE_EQ(2. * M_PI * 3., parse("2pi y").Val());
+  EXPECT_DOUBLE_EQ(std::sqrt(5.) + std::log(2.), parse(" sqrt ( ys ) + ln(x[1]) ").Val());
+  EXPECT_DOUBLE_EQ(std::exp(-2.), parse("exp(-(x[1]))").Val());
+  // syntax handled by the original parser only
+  EXPECT_DOUBLE_EQ(std::sin(0.5), parse("sin x[0]").Val());
+  EXPECT_DOUBLE_EQ(300., parse("3E2").Val());
+  EXPECT_DOUBLE_EQ(std::sqrt(3.), parse("#y").Val());
+  EXPECT_DOUBLE_EQ(23. * 0.5, parse("(2 3)x[0]").Val());
+  EXPECT_TRUE(parse("x[0] +").HasError());
+  EXPECT_TRUE(parse("x[0] + z").HasError());
+}
+
+TEST_F(ParserTest, evaluates_piecewise_functions)
+{
+  EXPECT_EQ(0.5, parse("min(x[0], x[1])").Val());
+  EXPECT_EQ(3., parse("max(x[1], y)").Val());
+  EXPECT_EQ(3., parse("clamp(ys, x[0], y)").Val());
+  EXPECT_EQ(2., parse("clamp(x[1], x[0], y)").Val());
+  EXPECT_EQ(-1., parse("floor(-x[0])").Val());
+  EXPECT_EQ(0., parse("heaviside(x[0] - x[1])").Val());
+  EXPECT_EQ(1., parse("heaviside(x[1] - x[0])").Val());
+  // only the selected value has to be defined
+  EXPECT_EQ(3., parse("if(x[0] - 1, sqrt(-x[0]), y)").Val());
+  EXPECT_EQ(ErrVal, parse("if(ln(-x[0]), 1, 2)").Val());
+  // the original parser, which is used without variables
+  EXPECT_EQ(4., ROperation("min(2, 3) + floor(2.5)").Val());
+  EXPECT_EQ(2., ROperation("if(-1, 1, clamp(5, 0, 2))").Val());
+  EXPECT_TRUE(ROperation("clamp(1, 2)").HasError());
+  EXPECT_TRUE(parse("min(x[0])").HasError());
+  EXPECT_TRUE(parse("if(x[0], y)").HasError());
+  // Expr() gives a string which is parsed to the same function
+  const auto piecewise = parse("if(x[0], min(x[1], -y), heaviside(ys))*max(x[0], 1) + clamp(floor(ys), 0, y)");
+  char* expression = piecewise.Expr();
+  EXPECT_EQ(piecewise.Val(), parse(expression).Val());
+  delete[] expression;
+}
@@ -0,0 +1,71 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <type_traits>
+
+#include <dune/xt/grid/grids.hh>
+#include <dune/xt/functions/expression.hh>
+
+using namespace Dune;
+using namespace Dune::XT;
+
+
+struct StaticExpressionFunctionTest : public ::testing::Test
+{
+  typedef YaspGrid<2, EquidistantOffsetCoordinates<double, 2>> GridType;
+  typedef typename GridType::template Codim<0>::Entity EntityType;
+  typedef Functions::ExpressionFunction<EntityType, double, 2, double, 3> ExpressionFunctionType;
+  typedef typename ExpressionFunctionType::DomainType DomainType;
+  typedef typename ExpressionFunctionType::RangeType RangeType;
+  typedef typename ExpressionFunctionType::JacobianRangeType JacobianRangeType;
+
+  void check_against_expression_function() const
+  {
+    using namespace Functions::StaticExpressions;
+    const auto function = Functions::make_static_expression_function<EntityType, double, 2, double>(
+        3, sin(x<0>) * x<1>, 2 * pow(x<1>, 2) + exp(x<0> / x<1>), sqrt(1 + x<0> * x<0>) - atan(x<1>));
+    const ExpressionFunctionType expected(
+        "x", std::vector<std::string>{"sin(x[0])*x[1]", "2*x[1]^2+exp(x[0]/x[1])", "sqrt(1+x[0]*x[0])-atan(x[1])"}, 3);
+    const Functions::GlobalFunctionInterface<EntityType, double, 2, double, 3>& interface = *function;
+    EXPECT_EQ(size_t(3), interface.order());
+    for (size_t ii = 0; ii < 10; ++ii) {
+      const DomainType xx = {0.1 * ii, 2. - 0.1 * ii};
+      const RangeType value = interface.evaluate(xx);
+      const RangeType expected_value = expected.evaluate(xx);
+      for (size_t rr = 0; rr < 3; ++rr)
+        EXPECT_DOUBLE_EQ(expected_value[rr], value[rr]);
+      const JacobianRangeType jacobian = interface.jacobian(xx);
+      const JacobianRangeType expected_jacobian = expected.jacobian(xx);
+      for (size_t rr = 0; rr < 3; ++rr)
+        for (size_t jj = 0; jj < 2; ++jj)
+          EXPECT_NEAR(expected_jacobian[rr][jj], jacobian[rr][jj], 1e-13);
+    }
+  } // ... check_against_expression_function(...)
+
+  void check_simplified_derivatives() const
+  {
+    using namespace Functions::StaticExpressions;
+    static_assert(std::is_same<decltype(derivative<1>(2 * x<0> + 3)), Zero>::value, "");
+    static_assert(std::is_same<decltype(derivative<0>(x<0> - 3)), One>::value, "");
+    static_assert(std::is_same<decltype(derivative<0>(x<0> * x<1>)), Variable<1>>::value, "");
+    const DomainType xx = {0.5, 2.};
+    EXPECT_DOUBLE_EQ(std::cos(0.5) * 2., derivative<0>(sin(x<0>) * x<1>)(xx));
+  }
+}; // struct StaticExpressionFunctionTest
+
+
+TEST_F(StaticExpressionFunctionTest, gives_same_results_as_expression_function)
+{
+  this->check_against_expression_function();
+}
+
+TEST_F(StaticExpressionFunctionTest, simplifies_derivatives)
+{
+  this->check_simplified_derivatives();
+}
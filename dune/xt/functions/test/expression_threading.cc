@@ -0,0 +1,93 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if HAVE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <dune/xt/common/float_cmp.hh>
+#include <dune/xt/grid/grids.hh>
+#include <dune/xt/functions/expression.hh>
+
+using namespace Dune;
+using namespace Dune::XT;
+
+
+struct ExpressionFunctionThreadingTest : public ::testing::Test
+{
+  typedef YaspGrid<2, EquidistantOffsetCoordinates<double, 2>> GridType;
+  typedef Functions::ExpressionFunction<typename GridType::template Codim<0>::Entity, double, 2, double, 2, 2>
+      FunctionType;
+  typedef typename FunctionType::DomainType DomainType;
+  typedef typename FunctionType::RangeType RangeType;
+
+  static const size_t num_points = 20000;
+
+  ExpressionFunctionThreadingTest()
+    : function_("x",
+                FunctionType::ExpressionStringVectorType{{"1 + x[0]*x[0]", "sin(x[0])*cos(x[1])"},
+                                                         {"sin(x[0])*cos(x[1])", "exp(x[0]*x[1]) + 1"}},
+                4,
+                "diffusion")
+    , points_(num_points)
+  {
+    for (size_t ii = 0; ii < num_points; ++ii)
+      points_[ii] = {double(ii) / num_points, 1. - double(ii) / num_points};
+  }
+
+  void evaluate(const size_t begin, const size_t end, std::vector<RangeType>& values) const
+  {
+    for (size_t ii = begin; ii < end; ++ii)
+      function_.evaluate(points_[ii], values[ii]);
+  }
+
+  /**
+   * Evaluates the function at all points using 1, 2, 4, ... threads (all threads sharing the compiled expressions) and
+   * checks the results against a serial evaluation.
+   */
+  void check_parallel() const
+  {
+    std::vector<RangeType> expected(num_points);
+    evaluate(0, num_points, expected);
+#if HAVE_TBB
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      std::vector<RangeType> values(num_points);
+      tbb::task_arena arena(static_cast<int>(num_threads));
+      arena.execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_points),
+                          [&](const tbb::blocked_range<size_t>& range) { evaluate(range.begin(), range.end(), values); });
+      });
+      for (size_t ii = 0; ii < num_points; ++ii)
+        EXPECT_TRUE(Common::FloatCmp::eq(expected[ii], values[ii])) << "point " << points_[ii];
+    }
+#endif // HAVE_TBB
+    const DomainType xx = {0.5, 0.25};
+    RangeType value;
+    function_.evaluate(xx, value);
+    EXPECT_DOUBLE_EQ(1.25, value[0][0]);
+    EXPECT_DOUBLE_EQ(std::sin(0.5) * std::cos(0.25), value[0][1]);
+    EXPECT_DOUBLE_EQ(std::exp(0.125) + 1, value[1][1]);
+  } // ... check_parallel(...)
+
+  const FunctionType function_;
+  std::vector<DomainType> points_;
+}; // struct ExpressionFunctionThreadingTest
+
+
+TEST_F(ExpressionFunctionThreadingTest, evaluates_in_parallel_like_serially)
+{
+  this->check_parallel();
+}
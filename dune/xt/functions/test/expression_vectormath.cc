@@ -0,0 +1,135 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dune/xt/functions/expression/mathexpr.hh>
+#include <dune/xt/functions/expression/vectormath.hh>
+
+struct VectorMathTest : public ::testing::Test
+{
+  typedef double (*ScalarType)(double);
+  typedef void (*VectorType)(const double*, double*, int);
+
+  static long long ulps(const double a, const double b)
+  {
+    long long ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0)
+      ia = LLONG_MIN - ia;
+    if (ib < 0)
+      ib = LLONG_MIN - ib;
+    return ia < ib ? ib - ia : ia - ib;
+  }
+
+  static std::vector<double> samples(const double lower, const double upper, const size_t num_samples)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(lower, upper);
+    std::vector<double> ret(num_samples);
+    for (auto& value : ret)
+      value = distribution(generator);
+    return ret;
+  }
+
+  static void check(const std::string& name,
+                    ScalarType scalar,
+                    VectorType vector,
+                    ScalarType reference,
+                    const std::vector<double>& x)
+  {
+    std::vector<double> y(x.size());
+    vector(x.data(), y.data(), static_cast<int>(x.size()));
+    long long max_ulps = 0;
+    for (size_t ii = 0; ii < x.size(); ++ii) {
+      const double expected = scalar(x[ii]);
+      // the same bits, also for the values in the remainder of the last vector
+      EXPECT_EQ(0, std::memcmp(&expected, &y[ii], sizeof(double))) << name << "(" << x[ii] << ")";
+      const long long error = ulps(expected, reference(x[ii]));
+      if (error > max_ulps)
+        max_ulps = error;
+    }
+    EXPECT_LE(max_ulps, 1) << name;
+  }
+};
+
+TEST_F(VectorMathTest, agrees_with_libm)
+{
+  const auto small = samples(-10., 10., 100003);
+  const auto large = samples(-1e5, 1e5, 100003);
+  auto positive = samples(1e-3, 1e3, 100003);
+  for (auto& value : samples(-700., 700., 10000))
+    positive.push_back(std::exp(value));
+  check("sin", &KernelSin, &KernelSin, [](double x) { return std::sin(x); }, small);
+  check("sin", &KernelSin, &KernelSin, [](double x) { return std::sin(x); }, large);
+  check("cos", &KernelCos, &KernelCos, [](double x) { return std::cos(x); }, small);
+  check("cos", &KernelCos, &KernelCos, [](double x) { return std::cos(x); }, large);
+  // up to the largest arguments of the kernels and close to multiples of pi/2, where the reduction cancels
+  const auto huge = samples(-0x1p19, 0x1p19, 1000003);
+  std::vector<double> multiples;
+  for (int kk = 1; kk < (1 << 19); kk += 13) {
+    const double x = kk * M_PI_2;
+    multiples.push_back(std::nextafter(x, 0.));
+    multiples.push_back(x);
+    multiples.push_back(std::nextafter(x, HUGE_VAL));
+  }
+  check("sin", &KernelSin, &KernelSin, [](double x) { return std::sin(x); }, huge);
+  check("sin", &KernelSin, &KernelSin, [](double x) { return std::sin(x); }, multiples);
+  check("cos", &KernelCos, &KernelCos, [](double x) { return std::cos(x); }, huge);
+  check("cos", &KernelCos, &KernelCos, [](double x) { return std::cos(x); }, multiples);
+  check("exp", &KernelExp, &KernelExp, [](double x) { return std::exp(x); }, small);
+  check("exp", &KernelExp, &KernelExp, [](double x) { return std::exp(x); }, samples(-745., 709., 100003));
+  check("log", &KernelLog, &KernelLog, [](double x) { return std::log(x); }, positive);
+  check("log", &KernelLog, &KernelLog, [](double x) { return std::log(x); }, samples(0.5, 2., 100003));
+}
+
+TEST_F(VectorMathTest, special_values)
+{
+  EXPECT_EQ(0., KernelSin(0.));
+  EXPECT_EQ(1., KernelCos(0.));
+  EXPECT_EQ(1., KernelExp(0.));
+  EXPECT_EQ(0., KernelLog(1.));
+  EXPECT_EQ(HUGE_VAL, KernelExp(710.));
+  EXPECT_EQ(0., KernelExp(-746.));
+  EXPECT_EQ(std::log(DBL_MIN / 4), KernelLog(DBL_MIN / 4));
+  EXPECT_EQ(-HUGE_VAL, KernelLog(0.));
+  EXPECT_TRUE(std::isnan(KernelLog(-1.)));
+  EXPECT_TRUE(std::isnan(KernelSin(NAN)));
+  EXPECT_TRUE(std::isnan(KernelExp(NAN)));
+  // too large for the argument reduction of the kernels
+  EXPECT_EQ(std::sin(1e10), KernelSin(1e10));
+  EXPECT_EQ(std::cos(-1e10), KernelCos(-1e10));
+}
+
+TEST_F(VectorMathTest, programs_agree_with_operations)
+{
+  double xx = 0.;
+  RVar x("x", &xx);
+  RVar* vars[1] = {&x};
+  const ROperation operation("sin(3*x)*exp(-x) + cos(x)*ln(2 + x)", 1, vars);
+  const ROperation* ops[1] = {&operation};
+  const RProgram program(1, ops, 1, vars);
+  const auto points = samples(-1.5, 3., 1001);
+  std::vector<double> values(points.size());
+  const double* columns[1] = {points.data()};
+  program.Val(columns, values.data(), points.size());
+  double value;
+  for (size_t ii = 0; ii < points.size(); ++ii) {
+    program.Val(&points[ii], &value);
+    EXPECT_EQ(value, values[ii]);
+    xx = points[ii];
+    EXPECT_EQ(operation.Val(), values[ii]);
+  }
+}
@@ -0,0 +1,253 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/xt/grid/gridprovider/cube.hh>
+
+#include <dune/xt/functions/arena.hh>
+#include <dune/xt/functions/combined.hh>
+#include <dune/xt/functions/constant.hh>
+
+using namespace Dune;
+using namespace Dune::XT;
+using Dune::XT::Functions::LocalfunctionArena;
+
+// counts all allocations of this program on the global heap
+static std::atomic<size_t> num_heap_allocations(0);
+
+void* operator new(std::size_t bytes)
+{
+  ++num_heap_allocations;
+  void* ptr = std::malloc(bytes > 0 ? bytes : 1);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+TEST(LocalfunctionArena, reuses_its_buffer)
+{
+  void* first = nullptr;
+  {
+    LocalfunctionArena::Scope scope;
+    first = LocalfunctionArena::allocate(100);
+    void* second = LocalfunctionArena::allocate(100);
+    EXPECT_EQ(size_t(2), LocalfunctionArena::num_alive());
+    EXPECT_NE(first, second);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % alignof(std::max_align_t));
+    LocalfunctionArena::deallocate(second);
+    LocalfunctionArena::deallocate(first);
+    EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+  }
+  {
+    LocalfunctionArena::Scope scope;
+    const size_t allocations = num_heap_allocations;
+    void* again = LocalfunctionArena::allocate(100);
+    EXPECT_EQ(first, again);
+    EXPECT_EQ(allocations, num_heap_allocations);
+    LocalfunctionArena::deallocate(again);
+  }
+  // without a scope, the heap is used
+  const size_t allocations = num_heap_allocations;
+  void* heap = LocalfunctionArena::allocate(100);
+  EXPECT_EQ(allocations + 1, num_heap_allocations);
+  EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+  LocalfunctionArena::deallocate(heap);
+}
+
+TEST(LocalfunctionArena, keeps_blocks_which_outlive_their_scope)
+{
+  void* first = nullptr;
+  {
+    LocalfunctionArena::Scope scope;
+    first = LocalfunctionArena::allocate(100);
+  }
+  {
+    LocalfunctionArena::Scope scope;
+    void* second = LocalfunctionArena::allocate(100);
+    EXPECT_NE(first, second);
+    LocalfunctionArena::deallocate(second);
+  }
+  LocalfunctionArena::deallocate(first);
+  {
+    LocalfunctionArena::Scope scope;
+  }
+  {
+    LocalfunctionArena::Scope scope;
+    void* again = LocalfunctionArena::allocate(100);
+    EXPECT_EQ(first, again);
+    LocalfunctionArena::deallocate(again);
+  }
+  // larger than the chunks of the buffer
+  LocalfunctionArena::Scope scope;
+  const size_t capacity = LocalfunctionArena::capacity();
+  void* large = LocalfunctionArena::allocate(capacity + 1);
+  EXPECT_LT(capacity, LocalfunctionArena::capacity());
+  LocalfunctionArena::deallocate(large);
+}
+
+TEST(LocalfunctionArena, rewinds_at_the_end_of_each_scope)
+{
+  LocalfunctionArena::Scope outer_scope;
+  void* outer = LocalfunctionArena::allocate(100);
+  void* first = nullptr;
+  {
+    LocalfunctionArena::Scope scope;
+    first = LocalfunctionArena::allocate(100);
+    LocalfunctionArena::deallocate(first);
+  }
+  {
+    LocalfunctionArena::Scope scope;
+    void* again = LocalfunctionArena::allocate(100);
+    EXPECT_EQ(first, again);
+    LocalfunctionArena::deallocate(again);
+  }
+  LocalfunctionArena::deallocate(outer);
+}
+
+TEST(LocalfunctionArena, stays_bounded_if_blocks_outlive_their_scope)
+{
+  const size_t num_scopes = 100000;
+  const size_t capacity = LocalfunctionArena::capacity();
+  // one block which is kept during all scopes, as a local function which is bound to each entity
+  void* kept = nullptr;
+  for (size_t ii = 0; ii < num_scopes; ++ii) {
+    LocalfunctionArena::Scope scope;
+    if (kept == nullptr)
+      kept = LocalfunctionArena::allocate(100);
+    LocalfunctionArena::deallocate(LocalfunctionArena::allocate(1000));
+  }
+  EXPECT_EQ(size_t(1), LocalfunctionArena::num_alive());
+  EXPECT_GE(std::max(capacity, size_t(64 * 1024)), LocalfunctionArena::capacity());
+  LocalfunctionArena::deallocate(kept);
+  kept = nullptr;
+  // one block which is replaced in each scope, also within a scope which encloses all of them
+  const size_t allocations = num_heap_allocations;
+  LocalfunctionArena::Scope outer_scope;
+  for (size_t ii = 0; ii < num_scopes; ++ii) {
+    LocalfunctionArena::Scope scope;
+    void* replacement = LocalfunctionArena::allocate(100);
+    LocalfunctionArena::deallocate(kept);
+    kept = replacement;
+    LocalfunctionArena::deallocate(LocalfunctionArena::allocate(1000));
+  }
+  LocalfunctionArena::deallocate(kept);
+  EXPECT_GE(std::max(capacity, size_t(64 * 1024)) + 64 * 1024, LocalfunctionArena::capacity());
+  EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+  // a new chunk at most every 64 KiB of replaced blocks
+  EXPECT_GE(allocations + num_scopes * 128 / (64 * 1024) + 2, num_heap_allocations);
+}
+
+TEST(LocalfunctionArena, keeps_blocks_which_outlive_their_thread)
+{
+  void* block = nullptr;
+  std::thread([&]() {
+    LocalfunctionArena::Scope scope;
+    block = LocalfunctionArena::allocate(100);
+    std::memset(block, 1, 100);
+  }).join();
+  // the buffer of the thread is gone, its chunk is freed here
+  std::memset(block, 2, 100);
+  LocalfunctionArena::deallocate(block);
+}
+
+struct Polymorphic
+{
+  explicit Polymorphic(const int vv)
+    : value(vv)
+  {
+  }
+
+  virtual ~Polymorphic() = default;
+
+  int value;
+};
+
+struct alignas(4 * alignof(std::max_align_t)) OverAligned : public Polymorphic
+{
+  using Polymorphic::Polymorphic;
+};
+
+TEST(LocalfunctionArena, is_used_by_make_unique_only)
+{
+  LocalfunctionArena::Scope scope;
+  {
+    const std::unique_ptr<Polymorphic> ptr(new Polymorphic(1));
+    EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+  }
+  {
+    const std::unique_ptr<Polymorphic> ptr = LocalfunctionArena::make_unique<Polymorphic>(2);
+    EXPECT_EQ(2, ptr->value);
+    EXPECT_EQ(size_t(1), LocalfunctionArena::num_alive());
+  }
+  EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+  // over-aligned types are not taken from the arena
+  const std::unique_ptr<Polymorphic> ptr = LocalfunctionArena::make_unique<OverAligned>(3);
+  EXPECT_EQ(3, ptr->value);
+  EXPECT_EQ(size_t(0), LocalfunctionArena::num_alive());
+}
+
+TEST(LocalfunctionArena, walks_grids_without_heap_allocations)
+{
+  typedef YaspGrid<3, EquidistantOffsetCoordinates<double, 3>> GridType;
+  typedef GridType::Codim<0>::Entity E;
+  typedef Functions::ConstantFunction<E, double, 3, double, 1> ConstantFunctionType;
+  auto grid = XT::Grid::make_cube_grid<GridType>(0., 1., 4);
+  const auto grid_view = grid.leaf_view();
+  const ConstantFunctionType one(1.);
+  const ConstantFunctionType two(2.);
+  // allocates three local functions per entity
+  const auto difference = one - two;
+  const auto evaluate = [&](const E& entity) {
+    const auto local_function = difference.local_function(entity);
+    return local_function->evaluate(entity.geometry().local(entity.geometry().center()))[0];
+  };
+  const auto walk = [&](const bool use_arena) {
+    double sum = 0.;
+    for (auto&& entity : elements(grid_view)) {
+      if (use_arena) {
+        LocalfunctionArena::Scope arena_scope;
+        sum += evaluate(entity);
+      } else
+        sum += evaluate(entity);
+    }
+    return sum;
+  };
+  // the first walk with the arena allocates its buffer
+  walk(true);
+  size_t allocations = num_heap_allocations;
+  const double heap_sum = walk(false);
+  const size_t heap_allocations = num_heap_allocations - allocations;
+  allocations = num_heap_allocations;
+  const double arena_sum = walk(true);
+  const size_t arena_allocations = num_heap_allocations - allocations;
+  EXPECT_EQ(heap_sum, arena_sum);
+  EXPECT_LE(size_t(3 * grid_view.size(0)), heap_allocations);
+  EXPECT_EQ(size_t(0), arena_allocations);
+}
@@ -0,0 +1,139 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <type_traits>
+#include <vector>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/xt/grid/gridprovider/cube.hh>
+
+#if HAVE_DUNE_XT_LA
+#include <dune/xt/functions/affine.hh>
+#endif
+#include <dune/xt/functions/combined.hh>
+#include <dune/xt/functions/constant.hh>
+#include <dune/xt/functions/derived.hh>
+#include <dune/xt/functions/flattop.hh>
+#include <dune/xt/functions/sliced.hh>
+
+using namespace Dune;
+using namespace Dune::XT;
+
+typedef YaspGrid<2, EquidistantOffsetCoordinates<double, 2>> GridType;
+typedef GridType::Codim<0>::Entity E;
+typedef Functions::ConstantFunction<E, double, 2, double, 1> ScalarConstantType;
+typedef Functions::ConstantFunction<E, double, 2, double, 3> VectorConstantType;
+typedef Functions::FlatTopFunction<E, double, 2, double, 1> FlatTopType;
+typedef Functions::DifferenceFunction<ScalarConstantType, FlatTopType> DifferenceType;
+
+// 2 on [0.35, 0.65]^2, decaying to 0 outside of [0.15, 0.85]^2
+FlatTopType make_flattop()
+{
+  return FlatTopType(FieldVector<double, 2>(0.25), FieldVector<double, 2>(0.75), FieldVector<double, 2>(0.1), 2.);
+}
+
+// compares the statically dispatched local function with local_function() on all entities
+template <class FunctionType>
+void check(const FunctionType& function)
+{
+  auto grid = XT::Grid::make_cube_grid<GridType>(0., 1., 8);
+  const auto grid_view = grid.leaf_view();
+  const auto first_entity = grid_view.begin<0>();
+  auto static_local_function = Functions::StaticLocalfunction<FunctionType>::create(function, *first_entity);
+  for (auto&& entity : elements(grid_view)) {
+    static_local_function.bind(entity);
+    const auto local_function = function.local_function(entity);
+    EXPECT_EQ(local_function->order(), static_local_function.order());
+    const auto& quadrature = QuadratureRules<double, 2>::rule(entity.type(), 3);
+    std::vector<typename FunctionType::RangeType> values(quadrature.size());
+    static_local_function.evaluate(quadrature, values);
+    size_t pp = 0;
+    for (const auto& point : quadrature) {
+      EXPECT_EQ(local_function->evaluate(point.position()), static_local_function.evaluate(point.position()));
+      EXPECT_EQ(local_function->evaluate(point.position()), values[pp++]);
+    }
+  }
+} // ... check(...)
+
+TEST(StaticLocalfunction, agrees_with_local_function)
+{
+  const ScalarConstantType one(1.);
+  const VectorConstantType vector(VectorConstantType::RangeType({1., 2., 3.}));
+  const FlatTopType flattop = make_flattop();
+  check(one);
+  check(flattop);
+  const DifferenceType difference(one, flattop);
+  check(difference);
+  typedef Functions::SumFunction<DifferenceType, ScalarConstantType> SumType;
+  const SumType sum(difference, one);
+  check(sum);
+  const Functions::ProductFunction<FlatTopType, VectorConstantType> product(flattop, vector);
+  check(product);
+  const Functions::SlicedLocalizableFunction<VectorConstantType, 2> sliced(vector, {{2, 0}});
+  check(sliced);
+  // the interface types are not statically dispatched and are wrapped
+  const auto dynamic_difference = one - flattop;
+  check(dynamic_difference);
+  // all types are known at compile time
+  using Functions::internal::Combination;
+  using Functions::internal::StaticCombinedLocalFunction;
+  static_assert(std::is_same<Functions::StaticLocalfunction<SumType>::type,
+                             StaticCombinedLocalFunction<DifferenceType, ScalarConstantType, Combination::sum>>::value,
+                "");
+  static_assert(std::is_same<Functions::StaticLocalfunction<FlatTopType>::type,
+                             Functions::StaticGlobalLocalfunction<FlatTopType>>::value,
+                "");
+} // TEST(StaticLocalfunction, agrees_with_local_function)
+
+#if HAVE_DUNE_XT_LA
+TEST(StaticLocalfunction, divergence)
+{
+  typedef Functions::AffineFunction<E, double, 2, double, 2> AffineType;
+  AffineType::FieldMatrixType A(0.);
+  A[0][0] = 1.;
+  A[0][1] = 2.;
+  A[1][0] = 3.;
+  A[1][1] = 4.;
+  const AffineType affine(std::vector<AffineType::FieldMatrixType>(1, A), AffineType::RangeType(1.));
+  check(affine);
+  const Functions::DivergenceFunction<AffineType> divergence(affine);
+  check(divergence);
+  auto grid = XT::Grid::make_cube_grid<GridType>(0., 1., 2);
+  for (auto&& entity : elements(grid.leaf_view())) {
+    const auto local_divergence = divergence.static_local_function(entity);
+    EXPECT_EQ(5., local_divergence.evaluate(entity.geometry().local(entity.geometry().center()))[0]);
+  }
+}
+#endif // HAVE_DUNE_XT_LA
+
+TEST(StaticLocalfunction, adapter)
+{
+  const ScalarConstantType one(1.);
+  const FlatTopType flattop = make_flattop();
+  const DifferenceType difference(one, flattop);
+  auto grid = XT::Grid::make_cube_grid<GridType>(0., 1., 8);
+  const auto grid_view = grid.leaf_view();
+  const auto first_entity = grid_view.begin<0>();
+  const auto adapter = Functions::make_local_function_adapter(difference.static_local_function(*first_entity));
+  for (auto&& entity : elements(grid_view)) {
+    adapter->bind(entity);
+    const auto local_function = difference.local_function(entity);
+    EXPECT_EQ(&entity, &adapter->entity());
+    EXPECT_EQ(local_function->order(), adapter->order());
+    const auto xx = entity.geometry().local(entity.geometry().center());
+    EXPECT_EQ(local_function->evaluate(xx), adapter->evaluate(xx));
+    // the flattop function does not provide its jacobian
+    EXPECT_THROW(local_function->jacobian(xx), NotImplemented);
+    EXPECT_THROW(adapter->jacobian(xx), NotImplemented);
+  }
+}
@@ -0,0 +1,77 @@
+// This file is part of the dune-xt-functions project:
+//   https://github.com/dune-community/dune-xt-functions
+// Copyright 2009-2018 dune-xt-functions developers and contributors. All rights reserved.
+// License: Dual licensed as BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+//      or  GPL-2.0+ (http://opensource.org/licenses/gpl-license)
+//          with "runtime exception" (http://www.dune-project.org/license.html)
+
+#include <dune/xt/common/test/main.hxx>
+
+#include <cstdint>
+#include <vector>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/xt/functions/strided-values.hh>
+
+using namespace Dune;
+using namespace Dune::XT::Functions;
+
+TEST(FlatComponents, follow_the_memory_order)
+{
+  static_assert(FlatComponents<double>::size == 1, "");
+  static_assert(FlatComponents<FieldVector<double, 3>>::size == 3, "");
+  static_assert(FlatComponents<FieldMatrix<double, 2, 3>>::size == 6, "");
+  // the jacobian of a matrix-valued function
+  typedef FieldVector<FieldMatrix<double, 2, 3>, 2> JacobianType;
+  static_assert(FlatComponents<JacobianType>::size == 12, "");
+  JacobianType jacobian;
+  for (size_t cc = 0; cc < 2; ++cc)
+    for (size_t rr = 0; rr < 2; ++rr)
+      for (size_t dd = 0; dd < 3; ++dd)
+        jacobian[cc][rr][dd] = 100. * cc + 10. * rr + dd;
+  const double* entries = &jacobian[0][0][0];
+  for (size_t cc = 0; cc < FlatComponents<JacobianType>::size; ++cc)
+    EXPECT_EQ(entries[cc], FlatComponents<JacobianType>::at(jacobian, cc));
+  FlatComponents<JacobianType>::at(jacobian, 7) = -1.;
+  EXPECT_EQ(-1., jacobian[1][0][1]);
+}
+
+TEST(StridedValuesView, is_component_major)
+{
+  // 2 components of 3 functions at 4 points
+  std::vector<double> data(2 * 3 * 4);
+  const StridedValuesView<double> view(data.data(), 2, 3, 4);
+  EXPECT_EQ(size_t(4), view.function_stride());
+  EXPECT_EQ(size_t(12), view.component_stride());
+  view(1, 2, 3) = 1.;
+  EXPECT_EQ(1., data[1 * 12 + 2 * 4 + 3]);
+  EXPECT_EQ(data.data() + 12 + 4, view.row(1, 1));
+  const FieldVector<double, 2> value({3., 4.});
+  view.set(1, 2, value);
+  EXPECT_EQ(3., view(0, 1, 2));
+  EXPECT_EQ(4., view(1, 1, 2));
+  FieldVector<double, 2> other(0.);
+  view.get(1, 2, other);
+  EXPECT_EQ(value, other);
+}
+
+TEST(StridedValues, aligns_all_rows)
+{
+  StridedValues<double> values(3, 2, 5);
+  const auto& view = values.view();
+  EXPECT_EQ(size_t(3), view.num_components());
+  EXPECT_EQ(size_t(2), view.num_functions());
+  EXPECT_EQ(size_t(5), view.num_points());
+  EXPECT_EQ(size_t(8), view.function_stride());
+  EXPECT_EQ(size_t(16), view.component_stride());
+  for (size_t cc = 0; cc < 3; ++cc)
+    for (size_t ii = 0; ii < 2; ++ii)
+      EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(view.row(cc, ii)) % 64);
+  view(2, 1, 4) = 3.;
+  EXPECT_EQ(3., values(2, 1, 4));
+  values.resize(1, 1, 17);
+  EXPECT_EQ(size_t(24), values.view().function_stride());
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(values.row(0, 0)) % 64);
+}
@@ -73,6 +73,12 @@ class TransformedLocalizableFunction
     {
     }
 
+    void bind(const EntityType& ent) override final
+    {
+      this->bind_entity(ent);
+      local_function_->bind(ent);
+    }
+
     size_t order(const XT::Common::Parameter& mu = {}) const override final
     {
       return local_function_->order(mu);